@@ -0,0 +1,174 @@
+// Allocation benchmark for one recommendation.
+//
+// Compares the pre-CatalogIndex planning path (std::vector<Course> filter, pair<double, Course>
+// copies, by-value getters, std::set of completed ids) with GreedyRecommender over CatalogIndex.
+//
+// Build (from backend/):
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target alloc_bench
+// Run:
+//   ./build/alloc_bench [data/courses.json] [copies]
+// `copies` replicates the catalog (with shifted ids) to emulate larger catalogs.
+
+#include "../include/recommender/greedy.hpp"
+#include "../include/utils/json_helpers.hpp"
+#include "alloc_counter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <string>
+
+namespace {
+
+// Reference copy of the planner as it was before the index: every stage copies Course objects
+Plan legacyMakePlan(const UserProfile& profile, const std::vector<Course>& allCourses) {
+    ScoringService scorer;
+    std::vector<PlanStep> steps;
+    int totalHours = 0;
+    int totalAvailableHours = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+
+    std::vector<Course> relevantCourses;
+    for (const auto& course : allCourses) {
+        std::string domain = course.getDomain();
+        std::string target = profile.getTargetDomain();
+        if (domain == target ||
+            (target == "AI" && domain == "Data Science") ||
+            (target == "Data Science" && domain == "AI")) {
+            relevantCourses.push_back(course);
+        }
+    }
+
+    std::vector<std::pair<double, Course>> scoredCourses;
+    for (const auto& course : relevantCourses) {
+        // Old matchScore copied interests and tags through by-value getters
+        std::vector<std::string> interests = profile.getInterests();
+        std::vector<std::string> tags = course.getTags();
+        (void)interests;
+        (void)tags;
+        scoredCourses.push_back({scorer.matchScore(course, profile), course});
+    }
+    std::sort(scoredCourses.begin(), scoredCourses.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::set<int> completedCourseIds;
+    int stepNumber = 1;
+    for (const auto& [score, course] : scoredCourses) {
+        if (totalHours + course.getDurationHours() > totalAvailableHours) {
+            continue;
+        }
+        bool prereqsMet = true;
+        std::vector<int> prereqs = course.getPrerequisiteCourseIds();
+        for (int prereqId : prereqs) {
+            if (completedCourseIds.find(prereqId) == completedCourseIds.end()) {
+                prereqsMet = false;
+                break;
+            }
+        }
+        if (!prereqsMet) {
+            continue;
+        }
+        steps.push_back({stepNumber++, course.getId(), course.getDurationHours(), "Score: " + std::to_string(score)});
+        totalHours += course.getDurationHours();
+        completedCourseIds.insert(course.getId());
+    }
+
+    Plan plan;
+    plan.setSteps(steps);
+    plan.setTotalHours(totalHours);
+    return plan;
+}
+
+std::vector<Course> loadCourses(const std::string& path, int copies) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+        std::exit(1);
+    }
+    json coursesJson;
+    file >> coursesJson;
+
+    std::vector<Course> base;
+    int maxId = 0;
+    for (const auto& courseJson : coursesJson) {
+        Course course = jsonToCourse(courseJson);
+        if (courseJson.contains("prereqIds")) {
+            course.setPrerequisiteCourseIds(courseJson["prereqIds"].get<std::vector<int>>());
+        }
+        maxId = std::max(maxId, course.getId());
+        base.push_back(course);
+    }
+
+    std::vector<Course> courses;
+    for (int copy = 0; copy < copies; ++copy) {
+        for (Course course : base) {
+            int shift = copy * maxId;
+            course.setId(course.getId() + shift);
+            std::vector<int> prereqs = course.getPrerequisiteCourseIds();
+            for (int& id : prereqs) {
+                id += shift;
+            }
+            course.setPrerequisiteCourseIds(prereqs);
+            courses.push_back(course);
+        }
+    }
+    return courses;
+}
+
+struct Measurement {
+    double allocsPerOp;
+    double bytesPerOp;
+    double nsPerOp;
+};
+
+template <typename F>
+Measurement measure(int iterations, F&& makePlan) {
+    makePlan(); // warm up thread-local scratch buffers
+    bench::AllocCounts before = bench::allocCounts();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Plan plan = makePlan();
+        if (plan.getTotalHours() < 0) {
+            std::abort();
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    bench::AllocCounts after = bench::allocCounts();
+    return {
+        static_cast<double>(after.allocations - before.allocations) / iterations,
+        static_cast<double>(after.bytes - before.bytes) / iterations,
+        std::chrono::duration<double, std::nano>(elapsed).count() / iterations
+    };
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "data/courses.json";
+    int copies = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+
+    std::vector<Course> courses = loadCourses(path, copies);
+    CatalogIndex catalog(courses);
+    GreedyRecommender recommender;
+
+    UserProfile profile;
+    profile.setUserId(1);
+    profile.setTargetDomain("Data Science");
+    profile.setCurrentLevel("Beginner");
+    profile.setInterests({"python", "machine learning", "statistics", "visualization"});
+    profile.setHoursPerWeek(10);
+    profile.setDeadlineWeeks(12);
+
+    const int iterations = 200;
+    Measurement legacy = measure(iterations, [&] { return legacyMakePlan(profile, courses); });
+    Measurement indexed = measure(iterations, [&] { return recommender.makePlan(profile, catalog); });
+    Plan plan = recommender.makePlan(profile, catalog);
+
+    std::printf("catalog: %zu courses, %zu tags, plan: %zu steps\n",
+                catalog.size(), catalog.tags().size(), plan.getSteps().size());
+    std::printf("%-10s %14s %14s %14s\n", "path", "allocs/op", "bytes/op", "ns/op");
+    std::printf("%-10s %14.1f %14.0f %14.0f\n", "legacy", legacy.allocsPerOp, legacy.bytesPerOp, legacy.nsPerOp);
+    std::printf("%-10s %14.1f %14.0f %14.0f\n", "indexed", indexed.allocsPerOp, indexed.bytesPerOp, indexed.nsPerOp);
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+// Process-wide allocation counters, fed by the replacement operator new in alloc_counter.cpp.
+// Link alloc_counter.cpp into a benchmark executable to enable them.
+namespace bench {
+
+struct AllocCounts {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+};
+
+AllocCounts allocCounts();
+
+// Resident set size of the process in bytes (0 where unsupported)
+std::size_t residentBytes();
+
+}
@@ -0,0 +1,136 @@
+#include "http_client.hpp"
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace bench {
+
+HttpConnection::HttpConnection(std::string hostName, int portNumber, bool keepAliveConnection)
+    : host(std::move(hostName)), port(portNumber), keepAlive(keepAliveConnection) {
+}
+
+HttpConnection::~HttpConnection() {
+    close();
+}
+
+bool HttpConnection::connect() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+    for (addrinfo* a = addresses; a; a = a->ai_next) {
+        fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    return fd >= 0;
+}
+
+void HttpConnection::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    in.clear();
+}
+
+bool HttpConnection::send(const HttpRequest& request) {
+    if (fd < 0 && !connect()) {
+        return false;
+    }
+    out.clear();
+    out += request.method;
+    out += ' ';
+    out += request.path;
+    out += " HTTP/1.1\r\nHost: ";
+    out += host;
+    out += keepAlive ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    if (!request.body.empty()) {
+        out += "\r\nContent-Type: application/json\r\nContent-Length: ";
+        out += std::to_string(request.body.size());
+    }
+    out += "\r\n\r\n";
+    out += request.body;
+
+    std::size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            close();
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+HttpResponse HttpConnection::receive() {
+    HttpResponse response;
+    char chunk[16384];
+    std::size_t headerEnd;
+    while ((headerEnd = in.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            close();
+            return {};
+        }
+        in.append(chunk, static_cast<std::size_t>(n));
+    }
+
+    // "HTTP/1.1 200 OK"
+    std::size_t space = in.find(' ');
+    if (space == std::string::npos || space > headerEnd) {
+        close();
+        return {};
+    }
+    response.status = std::atoi(in.c_str() + space + 1);
+
+    std::size_t contentLength = 0;
+    bool closeAfter = !keepAlive;
+    std::size_t line = in.find("\r\n") + 2;
+    while (line < headerEnd) {
+        std::size_t next = in.find("\r\n", line);
+        const char* header = in.c_str() + line;
+        if (strncasecmp(header, "Content-Length:", 15) == 0) {
+            contentLength = std::strtoull(header + 15, nullptr, 10);
+        } else if (strncasecmp(header, "Connection:", 11) == 0 && in.find("close", line) < next) {
+            closeAfter = true;
+        }
+        line = next + 2;
+    }
+
+    std::size_t total = headerEnd + 4 + contentLength;
+    while (in.size() < total) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            close();
+            return {};
+        }
+        in.append(chunk, static_cast<std::size_t>(n));
+    }
+    response.bytes = contentLength;
+    in.erase(0, total);
+
+    if (closeAfter) {
+        close();
+    }
+    return response;
+}
+
+}
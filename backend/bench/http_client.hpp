@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+
+// Minimal blocking HTTP/1.1 client for the load generator (POSIX sockets, Content-Length
+// bodies only, which is all Crow sends). One instance per thread.
+namespace bench {
+
+struct HttpRequest {
+    std::string route;    // report bucket, e.g. "recommendations"
+    std::string method;
+    std::string path;
+    std::string body;
+};
+
+struct HttpResponse {
+    int status = 0;       // 0 when the request failed at the socket level
+    std::size_t bytes = 0;
+};
+
+class HttpConnection {
+public:
+    HttpConnection(std::string host, int port, bool keepAlive);
+    ~HttpConnection();
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    // Writes the request without waiting, so several connections can be driven from one thread
+    bool send(const HttpRequest& request);
+    HttpResponse receive();
+
+    HttpResponse roundTrip(const HttpRequest& request) {
+        return send(request) ? receive() : HttpResponse{};
+    }
+
+private:
+    bool connect();
+    void close();
+
+    std::string host;
+    int port;
+    bool keepAlive;
+    int fd = -1;
+    std::string out;
+    std::string in;
+};
+
+}
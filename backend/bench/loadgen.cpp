@@ -0,0 +1,435 @@
+// HTTP load generator for the Crow server.
+//
+// Drives the real routes with a weighted mix of POST /api/recommendations (synthetic
+// profiles), GET /api/plans/<int> and POST /api/auth/login, or replays a recorded corpus,
+// and reports throughput and latency percentiles per route.
+//
+//   closed loop (default): every connection sends its next request when the previous
+//                          response arrives
+//   open loop (--rate R):  R requests/s in total with Poisson arrivals; latency is measured
+//                          from the scheduled send time, so server stalls are not hidden
+//
+// Corpus files are NDJSON, one request per line:
+//   {"route":"recommendations","method":"POST","path":"/api/recommendations","body":"{...}"}
+//
+// Build (from backend/):
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target roadmap_loadgen
+// Run without PostgreSQL:
+//   ROADMAP_STORAGE=memory ./RoadmapBuilder-Backend &
+//   ./build/roadmap_loadgen --connections 64 --duration 30 --mix recommendations=50,plans=40,login=10
+//   ./build/roadmap_loadgen --rate 2000 --login-burst 200 --burst-every 5
+//   ./build/roadmap_loadgen --write-corpus corpus.ndjson --count 10000
+//   ./build/roadmap_loadgen --corpus corpus.ndjson --connections 32
+
+#include "../include/metrics/metrics.hpp"
+#include "../include/utils/json_helpers.hpp"
+#include "http_client.hpp"
+#include "synthetic_catalog.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 32;
+    double durationSeconds = 10.0;
+    double warmupSeconds = 1.0;
+    double rate = 0.0;                 // total requests/s; 0 = closed loop
+    bool keepAlive = true;
+    std::map<std::string, int> mix{{"recommendations", 50}, {"plans", 40}, {"login", 10}};
+    int users = 1000;
+    bool setup = true;                 // register users and create one plan each before the run
+    std::string catalog = "data/courses.json";
+    std::uint64_t seed = 42;
+    std::string corpus;
+    std::string writeCorpus;
+    std::size_t count = 10000;
+    int loginBurst = 0;
+    double burstEvery = 5.0;
+};
+
+// Per-route results, shared by all connection threads (striped counters, no locks)
+struct RouteStats {
+    metrics::Histogram latency;
+    std::array<metrics::Counter, 6> byClass;    // socket error, 1xx..5xx
+    metrics::Counter bytes;
+    std::atomic<std::int64_t> maxNs{0};
+
+    void record(const bench::HttpResponse& response, Clock::duration elapsed) {
+        latency.record(elapsed);
+        int statusClass = response.status / 100;
+        byClass[statusClass >= 1 && statusClass <= 5 ? statusClass : 0].add();
+        bytes.add(response.bytes);
+        std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        std::int64_t seen = maxNs.load(std::memory_order_relaxed);
+        while (ns > seen && !maxNs.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+class Results {
+public:
+    RouteStats& route(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& stats = routes[name];
+        if (!stats) {
+            stats = std::make_unique<RouteStats>();
+        }
+        return *stats;
+    }
+
+    void print(double seconds) const {
+        std::printf("\n%-16s %9s %10s %7s %7s %9s %9s %9s %9s %9s\n",
+                    "route", "requests", "req/s", "2xx", "err", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+        for (const auto& [name, stats] : routes) {
+            auto snapshot = stats->latency.snapshot();
+            std::uint64_t errors = stats->byClass[0].value() + stats->byClass[4].value() + stats->byClass[5].value();
+            // HDR quantiles are bucket upper edges; never report more than the observed maximum
+            std::uint64_t maxNs = static_cast<std::uint64_t>(stats->maxNs.load());
+            auto ms = [maxNs](std::uint64_t ns) { return static_cast<double>(std::min(ns, maxNs)) / 1e6; };
+            std::printf("%-16s %9llu %10.1f %7llu %7llu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                        name.c_str(), static_cast<unsigned long long>(snapshot.count),
+                        static_cast<double>(snapshot.count) / seconds,
+                        static_cast<unsigned long long>(stats->byClass[2].value()),
+                        static_cast<unsigned long long>(errors),
+                        ms(snapshot.quantile(0.5)), ms(snapshot.quantile(0.9)), ms(snapshot.quantile(0.99)),
+                        ms(snapshot.quantile(0.999)), ms(maxNs));
+        }
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::unique_ptr<RouteStats>> routes;
+};
+
+std::uint64_t mixHash(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+std::string username(int user) { return "loadgen_" + std::to_string(user); }
+std::string password(int user) { return "secret_" + std::to_string(user); }
+
+bench::HttpRequest loginRequest(int user) {
+    return {"login", "POST", "/api/auth/login",
+            json{{"username", username(user)}, {"password", password(user)}}.dump()};
+}
+
+bench::HttpRequest recommendationRequest(const UserProfile& profile) {
+    return {"recommendations", "POST", "/api/recommendations", json{{"profile", profileToJson(profile)}}.dump()};
+}
+
+// Deterministic request stream: the i-th request of a run is always the same
+class Workload {
+public:
+    Workload(const Options& options) : users(std::max(1, options.users)), seed(options.seed) {
+        std::vector<Course> courses;
+        std::ifstream file(options.catalog);
+        if (file.is_open()) {
+            json coursesJson;
+            file >> coursesJson;
+            for (const auto& courseJson : coursesJson) {
+                courses.push_back(jsonToCourse(courseJson));
+            }
+        } else {
+            courses = bench::generateCatalog({1000, options.seed});
+        }
+        profiles = bench::generateProfiles(courses, static_cast<std::size_t>(users), options.seed);
+
+        for (const auto& [route, weight] : options.mix) {
+            if (weight > 0) {
+                totalWeight += weight;
+                cumulative.emplace_back(totalWeight, route);
+            }
+        }
+    }
+
+    bench::HttpRequest next(std::uint64_t index) const {
+        std::uint64_t h = mixHash(seed ^ index);
+        int user = static_cast<int>(h % static_cast<std::uint64_t>(users)) + 1;
+        int roll = static_cast<int>((h >> 32) % static_cast<std::uint64_t>(std::max(totalWeight, 1)));
+        std::string route = cumulative.empty() ? "plans" : cumulative.back().second;
+        for (const auto& [limit, name] : cumulative) {
+            if (roll < limit) {
+                route = name;
+                break;
+            }
+        }
+        if (route == "recommendations") {
+            return recommendationRequest(profiles[static_cast<std::size_t>(user - 1)]);
+        }
+        if (route == "login") {
+            return loginRequest(user);
+        }
+        if (route == "courses") {
+            return {"courses", "GET", "/api/courses", ""};
+        }
+        return {"plans", "GET", "/api/plans/" + std::to_string(user), ""};
+    }
+
+    const std::vector<UserProfile>& allProfiles() const { return profiles; }
+
+private:
+    int users;
+    std::uint64_t seed;
+    std::vector<UserProfile> profiles;
+    std::vector<std::pair<int, std::string>> cumulative;
+    int totalWeight = 0;
+};
+
+std::vector<bench::HttpRequest> readCorpus(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open corpus " + path);
+    }
+    std::vector<bench::HttpRequest> corpus;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        json j = json::parse(line);
+        corpus.push_back({j.value("route", "other"), j.value("method", "GET"), j.value("path", "/"), j.value("body", "")});
+    }
+    return corpus;
+}
+
+void writeCorpus(const Workload& workload, const std::string& path, std::size_t count) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot write corpus " + path);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        bench::HttpRequest request = workload.next(i);
+        file << json{{"route", request.route}, {"method", request.method},
+                     {"path", request.path}, {"body", request.body}}.dump() << '\n';
+    }
+}
+
+// Registers every load-test user and gives each one a plan, so plan reads and logins hit
+void setup(const Options& options, const Workload& workload) {
+    std::atomic<int> nextUser{1};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min(options.connections, 16); ++t) {
+        threads.emplace_back([&] {
+            bench::HttpConnection connection(options.host, options.port, true);
+            for (int user; (user = nextUser.fetch_add(1)) <= options.users;) {
+                connection.roundTrip({"register", "POST", "/api/auth/register",
+                                      json{{"username", username(user)},
+                                           {"email", username(user) + "@loadgen.local"},
+                                           {"password", password(user)}}.dump()});
+                connection.roundTrip(recommendationRequest(workload.allProfiles()[static_cast<std::size_t>(user - 1)]));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+struct Run {
+    const Options& options;
+    const Workload& workload;
+    const std::vector<bench::HttpRequest>* corpus;
+    Results& results;
+    Clock::time_point measureFrom;
+    Clock::time_point end;
+    std::atomic<std::uint64_t> sequence{0};
+
+    bench::HttpRequest request(std::uint64_t index) const {
+        return corpus ? (*corpus)[index % corpus->size()] : workload.next(index);
+    }
+
+    void record(const bench::HttpRequest& request, const bench::HttpResponse& response,
+                Clock::time_point issued, Clock::time_point done) {
+        if (issued >= measureFrom) {
+            results.route(request.route).record(response, done - issued);
+        }
+    }
+
+    void connectionLoop(int connectionIndex) {
+        bench::HttpConnection connection(options.host, options.port, options.keepAlive);
+        double perConnectionRate = options.rate / options.connections;
+        std::uint64_t rng = mixHash(options.seed + static_cast<std::uint64_t>(connectionIndex));
+        Clock::time_point scheduled = Clock::now();
+
+        while (true) {
+            if (perConnectionRate > 0.0) {
+                // Exponential inter-arrival times (Poisson process)
+                rng = mixHash(rng);
+                double u = (static_cast<double>(rng >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+                scheduled += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(-std::log(u) / perConnectionRate));
+                if (scheduled >= end) {
+                    break;
+                }
+                std::this_thread::sleep_until(scheduled);
+            } else {
+                scheduled = Clock::now();
+                if (scheduled >= end) {
+                    break;
+                }
+            }
+            bench::HttpRequest next = request(sequence.fetch_add(1, std::memory_order_relaxed));
+            bench::HttpResponse response = connection.roundTrip(next);
+            record(next, response, scheduled, Clock::now());
+        }
+    }
+
+    // Every burstEvery seconds, loginBurst logins leave at once over separate connections
+    void burstLoop() {
+        std::vector<std::unique_ptr<bench::HttpConnection>> connections;
+        for (int i = 0; i < options.loginBurst; ++i) {
+            connections.push_back(std::make_unique<bench::HttpConnection>(options.host, options.port, true));
+        }
+        Clock::time_point next = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.burstEvery));
+        std::uint64_t burst = 0;
+        while (next < end) {
+            std::this_thread::sleep_until(next);
+            std::vector<bench::HttpRequest> requests;
+            std::vector<bool> sent;
+            for (int i = 0; i < options.loginBurst; ++i) {
+                int user = static_cast<int>(mixHash(options.seed ^ (burst << 20) ^ static_cast<std::uint64_t>(i)) %
+                                            static_cast<std::uint64_t>(std::max(options.users, 1))) + 1;
+                bench::HttpRequest request = loginRequest(user);
+                request.route = "login.burst";
+                sent.push_back(connections[static_cast<std::size_t>(i)]->send(request));
+                requests.push_back(std::move(request));
+            }
+            for (int i = 0; i < options.loginBurst; ++i) {
+                bench::HttpResponse response = sent[static_cast<std::size_t>(i)]
+                    ? connections[static_cast<std::size_t>(i)]->receive() : bench::HttpResponse{};
+                record(requests[static_cast<std::size_t>(i)], response, next, Clock::now());
+            }
+            ++burst;
+            next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.burstEvery));
+        }
+    }
+};
+
+std::map<std::string, int> parseMix(const std::string& text) {
+    std::map<std::string, int> mix;
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        std::size_t eq = item.find('=');
+        if (eq != std::string::npos) {
+            mix[item.substr(0, eq)] = std::atoi(item.c_str() + eq + 1);
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return mix;
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--host H] [--port P] [--connections N] [--duration S] [--warmup S]\n"
+        "          [--rate REQ_PER_S] [--no-keepalive] [--mix recommendations=50,plans=40,login=10,courses=0]\n"
+        "          [--users N] [--no-setup] [--catalog data/courses.json] [--seed N]\n"
+        "          [--login-burst N] [--burst-every S] [--corpus FILE]\n"
+        "       %s --write-corpus FILE [--count N] [--mix ...] [--users N]\n", program, program);
+    return 2;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto take = [&]() { ++i; return value; };
+        if (arg == "--no-keepalive") options.keepAlive = false;
+        else if (arg == "--no-setup") options.setup = false;
+        else if (!value) return usage(argv[0]);
+        else if (arg == "--host") options.host = take();
+        else if (arg == "--port") options.port = std::atoi(take());
+        else if (arg == "--connections") options.connections = std::max(1, std::atoi(take()));
+        else if (arg == "--duration") options.durationSeconds = std::atof(take());
+        else if (arg == "--warmup") options.warmupSeconds = std::atof(take());
+        else if (arg == "--rate") options.rate = std::atof(take());
+        else if (arg == "--mix") options.mix = parseMix(take());
+        else if (arg == "--users") options.users = std::max(1, std::atoi(take()));
+        else if (arg == "--catalog") options.catalog = take();
+        else if (arg == "--seed") options.seed = std::strtoull(take(), nullptr, 10);
+        else if (arg == "--corpus") options.corpus = take();
+        else if (arg == "--write-corpus") options.writeCorpus = take();
+        else if (arg == "--count") options.count = std::strtoull(take(), nullptr, 10);
+        else if (arg == "--login-burst") options.loginBurst = std::max(0, std::atoi(take()));
+        else if (arg == "--burst-every") options.burstEvery = std::max(0.1, std::atof(take()));
+        else return usage(argv[0]);
+    }
+
+    try {
+        Workload workload(options);
+        if (!options.writeCorpus.empty()) {
+            writeCorpus(workload, options.writeCorpus, options.count);
+            std::printf("wrote %zu requests to %s\n", options.count, options.writeCorpus.c_str());
+            return 0;
+        }
+
+        std::vector<bench::HttpRequest> corpus;
+        if (!options.corpus.empty()) {
+            corpus = readCorpus(options.corpus);
+            if (corpus.empty()) {
+                throw std::runtime_error("Corpus " + options.corpus + " is empty");
+            }
+        }
+
+        if (options.setup) {
+            std::printf("setup: registering %d users with one plan each...\n", options.users);
+            setup(options, workload);
+        }
+
+        Results results;
+        Clock::time_point start = Clock::now();
+        auto seconds = [](double s) { return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s)); };
+        Run run{options, workload, corpus.empty() ? nullptr : &corpus, results,
+                start + seconds(options.warmupSeconds), start + seconds(options.warmupSeconds + options.durationSeconds)};
+
+        std::printf("%s loop, %d connections%s, %gs (+%gs warmup)%s\n",
+                    options.rate > 0 ? "open" : "closed", options.connections,
+                    options.keepAlive ? " (keep-alive)" : "", options.durationSeconds, options.warmupSeconds,
+                    corpus.empty() ? "" : ", replaying corpus");
+        std::vector<std::thread> threads;
+        for (int c = 0; c < options.connections; ++c) {
+            threads.emplace_back([&run, c] { run.connectionLoop(c); });
+        }
+        if (options.loginBurst > 0) {
+            threads.emplace_back([&run] { run.burstLoop(); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        results.print(options.durationSeconds);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "loadgen: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,603 @@
+// Micro-benchmarks for the recommendation hot path on synthetic catalogs.
+//
+// For each catalog size reports ns/op, allocations/op, bytes allocated/op and the change in
+// resident memory for: catalog generation, CatalogIndex construction, snapshot mapping and patching,
+// the prerequisite graph,
+// reference and tag-mask scoring, GreedyRecommender::makePlan, the same plans served by
+// RecommendationCache, KnapsackRecommender::makePlan (with the plan score of both), PostgreSQL array parsing (PostgresCatalog::getAll)
+// and the json_helpers.hpp serializers next to the typed request decoders and the enriched plan writer.
+//
+// --verify runs no timings: it checks the optimized paths against the reference implementations
+// kept here (tag-table scoring against matchScore(Course, profile), top-k selection against a
+// full sort, parallel scoring against inline) and exits with 1 on any difference.
+//
+// Build (from backend/):
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target roadmap_bench
+// Run:
+//   ./build/roadmap_bench [--sizes 100,10000,1000000] [--profiles 256] [--seed 42]
+//                         [--min-ms 200] [--plan-budget-us 20000] [--csv]
+//   ./build/roadmap_bench --verify [--sizes ...] [--profiles N] [--seed N]
+//   ./build/roadmap_bench --write-catalog out.json --courses 100000   (courses.json schema)
+
+#include "../include/cache/recommendation_cache.hpp"
+#include "../include/catalog/prereq_graph.hpp"
+#include "../include/http/plan_writer.hpp"
+#include "../include/http/request_decoder.hpp"
+#include "../include/recommender/greedy.hpp"
+#include "../include/recommender/knapsack.hpp"
+#include "../include/utils/json_helpers.hpp"
+#include "../include/utils/pg_array.hpp"
+#include "../include/utils/thread_pool.hpp"
+#include "alloc_counter.hpp"
+#include "synthetic_catalog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<std::size_t> sizes{100, 10000, 100000};
+    std::size_t profiles = 256;
+    std::uint64_t seed = 42;
+    double minMs = 200.0;
+    long long planBudgetUs = 20000;
+    bool csv = false;
+    bool verify = false;
+    std::string writeCatalog;
+    std::size_t writeCourses = 100;
+};
+
+struct Result {
+    const char* stage;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+    long long rssDeltaKb;
+};
+
+// Keeps results observable so the optimizer cannot drop the measured work
+volatile std::size_t sink = 0;
+
+// Calls `call` (which performs `opsPerCall` operations) until minMs has elapsed
+template <typename F>
+Result measure(const char* stage, double opsPerCall, double minMs, F&& call) {
+    std::size_t rssBefore = bench::residentBytes();
+    call(); // warm up thread-local scratch buffers and caches
+
+    bench::AllocCounts before = bench::allocCounts();
+    auto start = std::chrono::steady_clock::now();
+    std::size_t calls = 0;
+    double elapsedNs = 0.0;
+    do {
+        call();
+        ++calls;
+        elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsedNs < minMs * 1e6);
+    bench::AllocCounts after = bench::allocCounts();
+
+    double ops = opsPerCall * static_cast<double>(calls);
+    return {
+        stage,
+        elapsedNs / ops,
+        static_cast<double>(after.allocations - before.allocations) / ops,
+        static_cast<double>(after.bytes - before.bytes) / ops,
+        (static_cast<long long>(bench::residentBytes()) - static_cast<long long>(rssBefore)) / 1024
+    };
+}
+
+void print(const Options& options, std::size_t courses, const Result& r) {
+    if (options.csv) {
+        std::printf("%zu,%s,%.1f,%.2f,%.0f,%lld\n", courses, r.stage, r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.rssDeltaKb);
+    } else {
+        std::printf("%-18s %14.1f %12.2f %12.0f %12lld\n", r.stage, r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.rssDeltaKb);
+    }
+}
+
+void runSize(const Options& options, std::size_t size) {
+    // Generation and index construction are measured once: at 1M courses they take seconds
+    std::vector<Course> courses;
+    {
+        bench::SyntheticCatalogOptions catalogOptions{size, options.seed};
+        Result r = measure("generate", static_cast<double>(size), 0.0, [&] {
+            courses = bench::generateCatalog(catalogOptions);
+        });
+        if (!options.csv) {
+            std::printf("\n== %zu courses ==\n", size);
+            std::printf("%-18s %14s %12s %12s %12s\n", "stage", "ns/op", "allocs/op", "bytes/op", "rss+KB");
+        }
+        print(options, size, r);
+    }
+
+    std::size_t rssBeforeIndex = bench::residentBytes();
+    CatalogIndex catalog(courses);
+    long long indexKb = (static_cast<long long>(bench::residentBytes()) - static_cast<long long>(rssBeforeIndex)) / 1024;
+    {
+        Result r = measure("index.build", 1.0, 0.0, [&] {
+            CatalogIndex copy(courses);
+            sink = sink + copy.size();
+        });
+        r.rssDeltaKb = indexKb;
+        print(options, size, r);
+    }
+
+    // Startup from a snapshot file: map + bind (pages are faulted in on first use)
+    {
+        std::string path = (std::filesystem::temp_directory_path() / "roadmap_bench_catalog.snapshot").string();
+        catalog.snapshot()->save(path);
+        print(options, size, measure("index.map", 1.0, options.minMs, [&] {
+            CatalogIndex mapped(CatalogSnapshot::map(path));
+            sink = sink + mapped.size();
+        }));
+        std::filesystem::remove(path);
+    }
+
+    // Delta ingestion: one course replaced (copy-and-patch of the image, no rebuild)
+    {
+        CatalogDelta delta;
+        delta.upserts.push_back(courses[courses.size() / 2]);
+        delta.upserts.back().setTitle(delta.upserts.back().getTitle() + " (2nd edition)");
+        print(options, size, measure("index.patch", 1.0, options.minMs, [&] {
+            CatalogIndex patched = catalog.apply(delta);
+            sink = sink + patched.size();
+        }));
+    }
+
+    // Prerequisite graph (built on the first makePlan of each catalog version)
+    {
+        Result r = measure("prereq.graph", 1.0, 0.0, [&] {
+            PrereqGraph graph(catalog);
+            sink = sink + graph.size();
+        });
+        print(options, size, r);
+    }
+
+    std::vector<UserProfile> profiles = bench::generateProfiles(courses, options.profiles, options.seed);
+    ScoringService scorer;
+    GreedyRecommender recommender;
+
+    // Reference scorer over a fixed sample of the catalog for every profile
+    std::size_t sample = std::min<std::size_t>(courses.size(), 256);
+    print(options, size, measure("score.reference", static_cast<double>(sample * profiles.size()), options.minMs, [&] {
+        double total = 0.0;
+        for (const auto& profile : profiles) {
+            for (std::size_t i = 0; i < sample; ++i) {
+                total += scorer.matchScore(courses[i * courses.size() / sample], profile);
+            }
+        }
+        sink = sink + static_cast<std::size_t>(total);
+    }));
+
+    // Tag-mask scoring of the target-domain partition, per scored course
+    std::size_t partitionCourses = 0;
+    for (const auto& profile : profiles) {
+        partitionCourses += catalog.byDomain(profile.getTargetDomain()).size();
+    }
+    InterestMask interests;
+    std::vector<double> scores;
+    print(options, size, measure("score.partition", static_cast<double>(std::max<std::size_t>(partitionCourses, 1)), options.minMs, [&] {
+        for (const auto& profile : profiles) {
+            interests.assign(catalog, profile.getInterests());
+            scorer.scorePartition(catalog, catalog.byDomain(profile.getTargetDomain()), profile, interests, scores);
+            sink = sink + scores.size();
+        }
+    }));
+
+    std::vector<Plan> plans(profiles.size());
+    print(options, size, measure("greedy.makePlan", static_cast<double>(profiles.size()), options.minMs, [&] {
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            plans[i] = recommender.makePlan(profiles[i], catalog);
+        }
+    }));
+
+    // Same plans with scoring split over a pool once a domain is large enough (4 chunks at most)
+    ThreadPool scoringPool(3);
+    GreedyRecommender parallelRecommender(ParallelScoringOptions{&scoringPool});
+    print(options, size, measure("greedy.parallel", static_cast<double>(profiles.size()), options.minMs, [&] {
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            plans[i] = parallelRecommender.makePlan(profiles[i], catalog);
+        }
+    }));
+
+    // Repeated profiles through the recommendation cache (after the warm-up call, all hits)
+    RecommendationCache recommendationCache(64 * 1024 * 1024);
+    print(options, size, measure("cache.makePlan", static_cast<double>(profiles.size()), options.minMs, [&] {
+        for (const auto& profile : profiles) {
+            auto entry = recommendationCache.getOrCompute(RecommendationCache::key(1, profile), [&] {
+                RecommendationCache::Value value;
+                value.plan = recommender.makePlan(profile, catalog);
+                return value;
+            });
+            sink = sink + entry->plan.getSteps().size();
+        }
+    }));
+
+    // Same profiles through the branch-and-bound planner, then plan quality against greedy: total
+    // score of the candidate courses each plan contains (the objective both maximize)
+    KnapsackOptions knapsackOptions;
+    knapsackOptions.timeBudget = std::chrono::microseconds(options.planBudgetUs);
+    KnapsackRecommender knapsack(knapsackOptions);
+    std::vector<Plan> optimalPlans(profiles.size());
+    print(options, size, measure("knapsack.makePlan", static_cast<double>(profiles.size()), options.minMs, [&] {
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            optimalPlans[i] = knapsack.makePlan(profiles[i], catalog);
+        }
+    }));
+    if (!options.csv) {
+        double greedyTotal = 0.0;
+        double knapsackTotal = 0.0;
+        std::size_t better = 0;
+        std::vector<std::uint8_t> isCandidate(catalog.size(), 0);
+        CatalogIndex::SlotList candidates;
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            CandidateSet::slotsFor(profiles[i].getTargetDomain(), catalog, candidates);
+            for (CatalogIndex::Slot slot : candidates) {
+                isCandidate[slot] = 1;
+            }
+            interests.assign(catalog, profiles[i].getInterests());
+            auto planScore = [&](const Plan& plan) {
+                double total = 0.0;
+                for (const auto& step : plan.getSteps()) {
+                    CatalogIndex::Slot slot = *catalog.slotOf(step.courseId);
+                    if (isCandidate[slot]) {
+                        total += std::max(scorer.matchScore(catalog, slot, profiles[i], interests), 0.0);
+                    }
+                }
+                return total;
+            };
+            double greedyScore = planScore(plans[i]);
+            double knapsackScore = planScore(optimalPlans[i]);
+            greedyTotal += greedyScore;
+            knapsackTotal += knapsackScore;
+            better += knapsackScore > greedyScore + 1e-9;
+            for (CatalogIndex::Slot slot : candidates) {
+                isCandidate[slot] = 0;
+            }
+        }
+        KnapsackStats stats = knapsack.stats();
+        std::printf("  plan score: greedy %.2f, knapsack %.2f (%+.1f%%); better plans %zu/%zu; searches optimal %llu, cut off %llu\n",
+                    greedyTotal, knapsackTotal, greedyTotal > 0.0 ? 100.0 * (knapsackTotal / greedyTotal - 1.0) : 0.0,
+                    better, profiles.size(), static_cast<unsigned long long>(stats.optimal),
+                    static_cast<unsigned long long>(stats.cutOff));
+    }
+
+    // PostgresCatalog::getAll receives tags and prereq_ids as array literals
+    std::vector<std::pair<std::string, std::string>> rows;
+    rows.reserve(courses.size());
+    for (const auto& course : courses) {
+        rows.emplace_back(toPgArray(course.getTags()), toPgArray(course.getPrerequisiteCourseIds()));
+    }
+    print(options, size, measure("pg.parseArrays", static_cast<double>(rows.size()), options.minMs, [&] {
+        for (const auto& [tags, prereqs] : rows) {
+            sink = sink + parsePgTextArray(tags).size() + parsePgIntArray(prereqs).size();
+        }
+    }));
+
+    print(options, size, measure("json.courses", static_cast<double>(courses.size()), options.minMs, [&] {
+        sink = sink + coursesToJson(courses).dump().size();
+    }));
+
+    print(options, size, measure("json.plan", static_cast<double>(plans.size()), options.minMs, [&] {
+        for (const auto& plan : plans) {
+            sink = sink + planToJson(plan).dump().size();
+        }
+    }));
+
+    // Enriched plan bodies: the nlohmann DOM the handlers built before PlanFragments, then the
+    // direct writer into a reused buffer (same bytes)
+    auto enrichedPlanJson = [&](const Plan& plan) {
+        json enriched;
+        enriched["totalHours"] = plan.getTotalHours();
+        json steps = json::array();
+        for (const auto& step : plan.getSteps()) {
+            json stepJson = planStepToJson(step);
+            if (auto course = catalog.find(step.courseId)) {
+                stepJson["courseTitle"] = course->getTitle();
+                stepJson["courseDomain"] = course->getDomain();
+                stepJson["courseLevel"] = course->getLevel();
+                json tags = json::array();
+                for (std::size_t i = 0; i < course->getTagIds().size(); ++i) {
+                    tags.push_back(course->getTag(i));
+                }
+                stepJson["courseTags"] = std::move(tags);
+            }
+            steps.push_back(stepJson);
+        }
+        enriched["steps"] = steps;
+        return enriched.dump();
+    };
+    print(options, size, measure("json.enrichedPlan", static_cast<double>(plans.size()), options.minMs, [&] {
+        for (const auto& plan : plans) {
+            sink = sink + enrichedPlanJson(plan).size();
+        }
+    }));
+    PlanFragments fragments(catalog);
+    print(options, size, measure("write.enrichedPlan", static_cast<double>(plans.size()), options.minMs, [&] {
+        for (const auto& plan : plans) {
+            sink = sink + renderEnrichedPlan(plan, catalog, fragments).size();
+        }
+    }));
+    if (!options.csv) {
+        std::size_t different = 0;
+        for (const auto& plan : plans) {
+            different += renderEnrichedPlan(plan, catalog, fragments) != enrichedPlanJson(plan);
+        }
+        std::printf("  enriched plan bodies differing from the DOM rendering: %zu/%zu\n", different, plans.size());
+    }
+
+    std::vector<std::string> requests;
+    for (const auto& profile : profiles) {
+        requests.push_back(json{{"profile", profileToJson(profile)}}.dump());
+    }
+    print(options, size, measure("json.profile", static_cast<double>(requests.size()), options.minMs, [&] {
+        for (const auto& body : requests) {
+            sink = sink + static_cast<std::size_t>(jsonToProfile(json::parse(body)["profile"]).getHoursPerWeek());
+        }
+    }));
+
+    // The same bodies through the typed decoder the server uses
+    print(options, size, measure("decode.profile", static_cast<double>(requests.size()), options.minMs, [&] {
+        for (const auto& body : requests) {
+            sink = sink + static_cast<std::size_t>(decodeRecommendationRequest(body).getHoursPerWeek());
+        }
+    }));
+
+    // POST /api/plans/<int> bodies: DOM walk as before the typed decoder, then the decoder
+    std::vector<std::string> planBodies;
+    for (const auto& plan : plans) {
+        planBodies.push_back(planToJson(plan).dump());
+    }
+    print(options, size, measure("json.planBody", static_cast<double>(planBodies.size()), options.minMs, [&] {
+        for (const auto& body : planBodies) {
+            json data = json::parse(body);
+            std::vector<PlanStep> steps;
+            for (const auto& stepJson : data["steps"]) {
+                PlanStep step;
+                step.step = stepJson["step"];
+                step.courseId = stepJson["courseId"];
+                step.hours = stepJson["hours"];
+                step.note = stepJson["note"];
+                steps.push_back(step);
+            }
+            sink = sink + steps.size() + data["totalHours"].get<std::size_t>();
+        }
+    }));
+    print(options, size, measure("decode.plan", static_cast<double>(planBodies.size()), options.minMs, [&] {
+        for (const auto& body : planBodies) {
+            Plan plan = decodePlan(body);
+            sink = sink + plan.getSteps().size() + static_cast<std::size_t>(plan.getTotalHours());
+        }
+    }));
+}
+
+// GreedyRecommender as it was before top-k selection: every candidate scored with the reference
+// scorer, one full sort, then the prerequisite-aware greedy pass over all of them in score order
+Plan referencePlan(const UserProfile& profile, const CatalogIndex& catalog) {
+    ScoringService scorer;
+    CatalogIndex::SlotList slots;
+    CandidateSet::slotsFor(profile.getTargetDomain(), catalog, slots);
+    std::vector<std::pair<double, CatalogIndex::Slot>> scoredCourses;
+    for (CatalogIndex::Slot slot : slots) {
+        scoredCourses.push_back({scorer.matchScore(catalog.course(slot), profile), slot});
+    }
+    std::sort(scoredCourses.begin(), scoredCourses.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    const PrereqGraph& graph = catalog.prerequisiteGraph();
+    std::vector<PrereqGraph::Word> taken(graph.words(), 0);
+    auto durations = catalog.durations();
+    const int budget = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+    std::vector<PlanStep> steps;
+    int totalHours = 0;
+    auto addStep = [&](CatalogIndex::Slot slot, const std::string& note) {
+        steps.push_back({static_cast<int>(steps.size()) + 1, catalog.view(slot).getId(), durations[slot], note});
+        totalHours += durations[slot];
+        PrereqGraph::Rank rank = graph.rank(slot);
+        taken[rank / 64] |= PrereqGraph::Word{1} << (rank % 64);
+    };
+
+    std::vector<PrereqGraph::Rank> missing;
+    for (const auto& [score, slot] : scoredCourses) {
+        PrereqGraph::Rank rank = graph.rank(slot);
+        if (graph.blocked(slot) || ((taken[rank / 64] >> (rank % 64)) & 1)) {
+            continue;
+        }
+        int hours = durations[slot];
+        missing.clear();
+        graph.forEachMissing(slot, taken, [&](PrereqGraph::Rank prereq) {
+            missing.push_back(prereq);
+            hours += durations[graph.slotAt(prereq)];
+        });
+        if (totalHours + hours > budget) {
+            continue;
+        }
+        std::string prerequisiteNote = "Prerequisite for course " + std::to_string(catalog.view(slot).getId());
+        for (PrereqGraph::Rank prereq : missing) {
+            addStep(graph.slotAt(prereq), prerequisiteNote);
+        }
+        addStep(slot, "Score: " + std::to_string(score));
+    }
+
+    Plan plan;
+    plan.setSteps(std::move(steps));
+    plan.setTotalHours(totalHours);
+    return plan;
+}
+
+bool samePlan(const Plan& a, const Plan& b) {
+    const auto& x = a.getSteps();
+    const auto& y = b.getSteps();
+    if (a.getTotalHours() != b.getTotalHours() || x.size() != y.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (x[i].step != y[i].step || x[i].courseId != y[i].courseId || x[i].hours != y[i].hours || x[i].note != y[i].note) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Number of differences found; each check prints one line
+std::size_t verifySize(const Options& options, std::size_t size) {
+    std::vector<Course> courses = bench::generateCatalog({size, options.seed});
+    CatalogIndex catalog(courses);
+    std::vector<UserProfile> profiles = bench::generateProfiles(courses, options.profiles, options.seed);
+    // Every level, and a target domain the catalog does not have, whatever the generator picked
+    const char* levels[] = {"Beginner", "Intermediate", "Advanced", "Expert"};
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        if (i % 5 == 4) {
+            profiles[i].setCurrentLevel(levels[(i / 5) % 4]);
+        }
+        if (i % 7 == 6) {
+            profiles[i].setTargetDomain("Unknown Domain");
+        }
+    }
+
+    std::size_t failures = 0;
+    auto report = [&](const char* check, std::size_t different, std::size_t total) {
+        std::printf("%-10zu %-18s %zu/%zu differ%s\n", size, check, different, total, different ? "  FAIL" : "");
+        failures += different;
+    };
+
+    // Tag-table scoring of the candidates and of a sample of the whole catalog against matchScore(Course)
+    ScoringService scorer;
+    InterestMask interests;
+    std::vector<double> scores;
+    CatalogIndex::SlotList slots;
+    std::size_t scored = 0;
+    std::size_t different = 0;
+    for (const auto& profile : profiles) {
+        CandidateSet::slotsFor(profile.getTargetDomain(), catalog, slots);
+        for (std::size_t i = 0, n = std::min<std::size_t>(catalog.size(), 256); i < n; ++i) {
+            slots.push_back(static_cast<CatalogIndex::Slot>(i * catalog.size() / n));
+        }
+        interests.assign(catalog, profile.getInterests());
+        scorer.scorePartition(catalog, slots, profile, interests, scores);
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            different += scores[i] != scorer.matchScore(catalog.course(slots[i]), profile);
+        }
+        scored += slots.size();
+    }
+    report("score.partition", different, scored);
+
+    // Top-k selection, single profile and cohort paths, against the full-sort reference
+    GreedyRecommender recommender;
+    std::vector<Plan> plans(profiles.size());
+    std::size_t differentCohort = 0;
+    different = 0;
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        Plan reference = referencePlan(profiles[i], catalog);
+        plans[i] = recommender.makePlan(profiles[i], catalog);
+        different += !samePlan(plans[i], reference);
+        CandidateSet candidates;
+        candidates.assign(catalog, profiles[i].getTargetDomain(), profiles[i].getCurrentLevel());
+        differentCohort += !samePlan(recommender.makePlan(profiles[i], catalog, candidates), reference);
+    }
+    report("greedy.makePlan", different, profiles.size());
+    report("greedy.cohort", differentCohort, profiles.size());
+
+    // Scoring split into chunks of 64 whatever the measured cost, against the inline plans
+    ThreadPool scoringPool(3);
+    GreedyRecommender parallelRecommender(ParallelScoringOptions{&scoringPool, 4, 64, std::chrono::microseconds(0)});
+    different = 0;
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        different += !samePlan(parallelRecommender.makePlan(profiles[i], catalog), plans[i]);
+    }
+    report("greedy.parallel", different, profiles.size());
+    std::printf("%-10s %-18s %llu of %zu plans scored in parallel\n", "", "",
+                static_cast<unsigned long long>(parallelRecommender.stats().parallelScorings), profiles.size());
+    return failures;
+}
+
+std::vector<std::size_t> parseSizes(const char* text) {
+    std::vector<std::size_t> sizes;
+    for (const char* p = text; *p;) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        if (value > 0) {
+            sizes.push_back(static_cast<std::size_t>(value));
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+    return sizes;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--sizes") == 0 && value) {
+            options.sizes = parseSizes(value);
+            ++i;
+        } else if (std::strcmp(arg, "--profiles") == 0 && value) {
+            options.profiles = std::max<std::size_t>(1, std::strtoull(value, nullptr, 10));
+            ++i;
+        } else if (std::strcmp(arg, "--seed") == 0 && value) {
+            options.seed = std::strtoull(value, nullptr, 10);
+            ++i;
+        } else if (std::strcmp(arg, "--min-ms") == 0 && value) {
+            options.minMs = std::atof(value);
+            ++i;
+        } else if (std::strcmp(arg, "--plan-budget-us") == 0 && value) {
+            options.planBudgetUs = std::max(1LL, std::atoll(value));
+            ++i;
+        } else if (std::strcmp(arg, "--write-catalog") == 0 && value) {
+            options.writeCatalog = value;
+            ++i;
+        } else if (std::strcmp(arg, "--courses") == 0 && value) {
+            options.writeCourses = std::strtoull(value, nullptr, 10);
+            ++i;
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            options.csv = true;
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            options.verify = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--sizes N,N,...] [--profiles N] [--seed N] [--min-ms MS] [--plan-budget-us US] [--csv]\n"
+                                 "       %s --verify [--sizes N,N,...] [--profiles N] [--seed N]\n"
+                                 "       %s --write-catalog PATH [--courses N] [--seed N]\n", argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (!options.writeCatalog.empty()) {
+        auto courses = bench::generateCatalog({options.writeCourses, options.seed});
+        bench::writeCatalogJson(courses, options.writeCatalog);
+        std::printf("wrote %zu courses to %s\n", courses.size(), options.writeCatalog.c_str());
+        return 0;
+    }
+
+    if (options.verify) {
+        std::size_t failures = 0;
+        std::printf("%-10s %-18s %s\n", "courses", "check", "result");
+        for (std::size_t size : options.sizes) {
+            failures += verifySize(options, size);
+        }
+        if (failures) {
+            std::printf("verify failed: %zu differences\n", failures);
+            return 1;
+        }
+        std::printf("verify passed\n");
+        return 0;
+    }
+
+    if (options.csv) {
+        std::printf("courses,stage,ns_per_op,allocs_per_op,bytes_per_op,rss_delta_kb\n");
+    }
+    for (std::size_t size : options.sizes) {
+        runSize(options, size);
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include "synthetic_catalog.hpp"
+#include "../third_party/json.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace bench {
+
+namespace {
+
+// splitmix64: tiny, fast and identical everywhere
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    std::size_t below(std::size_t n) { return n ? static_cast<std::size_t>(next() % n) : 0; }
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+    int between(int lo, int hi) { return lo + static_cast<int>(below(static_cast<std::size_t>(hi - lo + 1))); }
+
+private:
+    std::uint64_t state;
+};
+
+// Picks index i with probability proportional to 1 / (i + 1)^s
+class Zipf {
+public:
+    Zipf(std::size_t n, double s) : cdf(n) {
+        double total = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            total += 1.0 / std::pow(static_cast<double>(i + 1), s);
+            cdf[i] = total;
+        }
+        for (double& c : cdf) {
+            c /= total;
+        }
+    }
+
+    std::size_t sample(Random& random) const {
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), random.unit());
+        return std::min(static_cast<std::size_t>(it - cdf.begin()), cdf.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+struct DomainSpec {
+    const char* name;
+    int weight;   // courses per 100 in data/courses.json
+    std::vector<const char*> coreTags;
+};
+
+const std::vector<DomainSpec>& domainSpecs() {
+    static const std::vector<DomainSpec> specs = {
+        {"Data Science", 20, {"python", "statistics", "pandas", "visualization", "ml", "algorithms", "bi", "programming"}},
+        {"Web Development", 20, {"web", "javascript", "css", "react", "frontend", "typescript", "nodejs", "backend"}},
+        {"DevOps", 15, {"kubernetes", "automation", "ci-cd", "monitoring", "linux", "bash", "command-line", "git"}},
+        {"Cloud", 10, {"aws", "cloud", "azure", "gcp", "basics", "ec2", "networking", "s3"}},
+        {"Mobile", 10, {"mobile", "android", "ios", "kotlin", "swift", "react-native", "cross-platform", "flutter"}},
+        {"Cybersecurity", 10, {"security", "compliance", "basics", "cyber", "network-security", "firewall", "protocols", "ethical-hacking"}},
+        {"AI", 8, {"llm", "ai-ethics", "responsible-ai", "bias", "generative-ai", "gpt", "prompt-engineering", "ai"}},
+        {"Database", 7, {"sql", "database", "optimization", "postgresql", "database-design", "normalization", "schema", "queries"}},
+    };
+    return specs;
+}
+
+const char* const Levels[] = {"Beginner", "Intermediate", "Advanced"};
+
+std::size_t pickWeighted(Random& random, const std::vector<DomainSpec>& specs) {
+    int total = 0;
+    for (const auto& spec : specs) total += spec.weight;
+    int roll = static_cast<int>(random.below(static_cast<std::size_t>(total)));
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        roll -= specs[i].weight;
+        if (roll < 0) return i;
+    }
+    return specs.size() - 1;
+}
+
+int pickLevel(Random& random) {
+    double roll = random.unit();
+    return roll < 0.22 ? 0 : roll < 0.65 ? 1 : 2;
+}
+
+// Real tags first (most popular under Zipf), then "<core>-<n>" variants as the catalog grows
+std::vector<std::string> domainVocabulary(const DomainSpec& spec, std::size_t catalogSize) {
+    std::size_t size = std::max<std::size_t>(spec.coreTags.size(), 12 + static_cast<std::size_t>(std::sqrt(static_cast<double>(catalogSize))));
+    std::vector<std::string> vocabulary;
+    vocabulary.reserve(size);
+    for (const char* tag : spec.coreTags) {
+        vocabulary.emplace_back(tag);
+    }
+    for (std::size_t i = 0; vocabulary.size() < size; ++i) {
+        vocabulary.push_back(std::string(spec.coreTags[i % spec.coreTags.size()]) + "-" + std::to_string(i / spec.coreTags.size() + 1));
+    }
+    return vocabulary;
+}
+
+}
+
+std::vector<Course> generateCatalog(const SyntheticCatalogOptions& options) {
+    const auto& specs = domainSpecs();
+    Random random(options.seed);
+
+    std::vector<std::vector<std::string>> vocabularies;
+    std::vector<Zipf> tagPopularity;
+    for (const auto& spec : specs) {
+        vocabularies.push_back(domainVocabulary(spec, options.courses));
+        tagPopularity.emplace_back(vocabularies.back().size(), 1.1);
+    }
+
+    // Earlier course ids per domain and level, for prerequisite picks
+    std::vector<std::array<std::vector<int>, 3>> earlier(specs.size());
+
+    std::vector<Course> courses;
+    courses.reserve(options.courses);
+    for (std::size_t i = 0; i < options.courses; ++i) {
+        int id = static_cast<int>(i + 1);
+        std::size_t domain = pickWeighted(random, specs);
+        int level = pickLevel(random);
+        const auto& vocabulary = vocabularies[domain];
+
+        std::vector<std::string> tags;
+        int tagCount = random.unit() < 0.97 ? 3 : 4;
+        for (int attempt = 0; static_cast<int>(tags.size()) < tagCount && attempt < 16; ++attempt) {
+            const std::string& tag = vocabulary[tagPopularity[domain].sample(random)];
+            if (std::find(tags.begin(), tags.end(), tag) == tags.end()) {
+                tags.push_back(tag);
+            }
+        }
+
+        // Prerequisites: 21% none, 69% one, 7% two, 3% three (as in data/courses.json),
+        // never for a domain's first courses; picks favour the most recent 64 candidates
+        std::vector<int> prereqs;
+        double roll = random.unit();
+        int prereqCount = roll < 0.21 ? 0 : roll < 0.90 ? 1 : roll < 0.97 ? 2 : 3;
+        if (level == 0 && prereqCount > 0 && random.unit() < 0.7) {
+            prereqCount = 0;
+        }
+        for (int p = 0; p < prereqCount; ++p) {
+            int fromLevel = level == 0 ? 0 : static_cast<int>(random.below(static_cast<std::size_t>(level) + 1));
+            const auto& pool = earlier[domain][static_cast<std::size_t>(fromLevel)];
+            if (pool.empty()) {
+                continue;
+            }
+            std::size_t window = std::min<std::size_t>(pool.size(), 64);
+            int prereq = pool[pool.size() - 1 - random.below(window)];
+            if (std::find(prereqs.begin(), prereqs.end(), prereq) == prereqs.end()) {
+                prereqs.push_back(prereq);
+            }
+        }
+
+        Course course;
+        course.setId(id);
+        course.setTitle(std::string(Levels[level]) + " " + tags.front() + " " + std::to_string(id));
+        course.setDomain(specs[domain].name);
+        course.setLevel(Levels[level]);
+        course.setDurationHours(5 * random.between(3 + level, 8 + 2 * level));   // 15..60h, longer when advanced
+        course.setTags(tags);
+        course.setPrerequisiteCourseIds(prereqs);
+        courses.push_back(std::move(course));
+
+        earlier[domain][static_cast<std::size_t>(level)].push_back(id);
+    }
+    return courses;
+}
+
+std::vector<UserProfile> generateProfiles(const std::vector<Course>& catalog, std::size_t count, std::uint64_t seed) {
+    const auto& specs = domainSpecs();
+    Random random(seed ^ 0x5DEECE66Dull);
+
+    std::vector<UserProfile> profiles;
+    profiles.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t domain = pickWeighted(random, specs);
+
+        std::vector<std::string> interests;
+        int interestCount = random.between(1, 5);
+        for (int k = 0; k < interestCount && !catalog.empty(); ++k) {
+            const Course& course = catalog[random.below(catalog.size())];
+            const auto& tags = course.getTags();
+            if (tags.empty()) {
+                continue;
+            }
+            std::string interest = tags[random.below(tags.size())];
+            // Users often type part of a tag ("react" for "react-native")
+            if (std::size_t dash = interest.find('-'); dash != std::string::npos && random.unit() < 0.3) {
+                interest.resize(dash);
+            }
+            interests.push_back(std::move(interest));
+        }
+
+        UserProfile profile;
+        profile.setUserId(static_cast<int>(i + 1));
+        profile.setTargetDomain(specs[domain].name);
+        profile.setCurrentLevel(Levels[pickLevel(random)]);
+        profile.setInterests(interests);
+        profile.setHoursPerWeek(random.between(5, 20));
+        profile.setDeadlineWeeks(random.between(4, 26));
+        profiles.push_back(std::move(profile));
+    }
+    return profiles;
+}
+
+void writeCatalogJson(const std::vector<Course>& courses, const std::string& path) {
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& course : courses) {
+        out.push_back({
+            {"id", course.getId()},
+            {"title", course.getTitle()},
+            {"domain", course.getDomain()},
+            {"level", course.getLevel()},
+            {"durationHours", course.getDurationHours()},
+            {"tags", course.getTags()},
+            {"prereqIds", course.getPrerequisiteCourseIds()}
+        });
+    }
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    file << out.dump(2) << '\n';
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../include/models/course.hpp"
+#include "../include/models/user_profile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic synthetic catalogs and profiles for benchmarks. Output depends only on
+// the options (own PRNG and distributions, no <random> engines whose sequences differ
+// between standard libraries), so runs are comparable across machines and compilers.
+namespace bench {
+
+struct SyntheticCatalogOptions {
+    std::size_t courses = 100;
+    std::uint64_t seed = 42;
+};
+
+// Same shape as data/courses.json: the 8 real domains in their real proportions,
+// Beginner/Intermediate/Advanced at 22/43/35%, 3-4 Zipf-distributed tags from a per-domain
+// vocabulary that grows with the catalog, and a prerequisite DAG: every course may only
+// require earlier courses of its domain at the same or a lower level, mostly recent ones.
+std::vector<Course> generateCatalog(const SyntheticCatalogOptions& options);
+
+// Profiles whose interests are drawn from the catalog's tags (sometimes as a substring,
+// like "machine" for "machine-learning"), with the target domain weighted like the catalog
+std::vector<UserProfile> generateProfiles(const std::vector<Course>& catalog, std::size_t count, std::uint64_t seed);
+
+// Writes courses in the data/courses.json schema (prerequisites under "prereqIds")
+void writeCatalogJson(const std::vector<Course>& courses, const std::string& path);
+
+}
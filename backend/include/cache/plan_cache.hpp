@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct PlanCacheStats {
+	std::size_t entries = 0;
+	std::size_t bytes = 0;
+	std::size_t capacityBytes = 0;
+	std::uint64_t hits = 0;
+	std::uint64_t misses = 0;
+	std::uint64_t evictions = 0;
+	std::uint64_t invalidations = 0;
+	std::uint64_t staleFills = 0;   // fills dropped because the plan changed while they were rendered
+};
+
+// Sharded, memory-bounded LRU of fully enriched, serialized plan responses keyed by
+// userId. Values are immutable shared strings, so a hit costs one shard lock and a
+// refcount increment; the response body is never rebuilt or copied under the lock.
+//
+// Fills are guarded by a per-shard generation, bumped by every invalidation and every plan
+// write, so a body rendered from a plan that has since changed is never installed:
+// - readers take token() before loading the plan and fill with putIfUnchanged(), which
+//   drops the body if the generation moved or a write for that user is still in progress;
+// - writers open a Write before saving the plan (dropping the cached body) and commit()
+//   the new body after; it is kept only if no other write for the same user overlapped and
+//   the cache was not cleared since the Write was opened (a catalog reload clears it after
+//   publishing the new version, so a body rendered against the old one is dropped).
+class PlanCache {
+public:
+	using Body = std::shared_ptr<const std::string>;
+	using Token = std::uint64_t;
+
+	// One plan write in progress; ending it without commit() only invalidates
+	class Write {
+	public:
+		Write(PlanCache& cache, int userId);
+		Write(Write&& other) noexcept;
+		Write& operator=(Write&&) = delete;
+		~Write();
+
+		void commit(std::string body);
+
+	private:
+		PlanCache* cache;
+		int userId;
+		std::uint64_t clearEpoch;   // the shard's clears when the Write was opened
+	};
+
+	explicit PlanCache(std::size_t maxBytes, std::size_t shardCount = 16);
+
+	// nullptr on miss
+	Body get(int userId);
+	Token token(int userId);
+	// Caches `body` unless the user's shard was invalidated or written since `token`; false if dropped
+	bool putIfUnchanged(int userId, Token token, std::string body);
+	void invalidate(int userId);
+	void clear();
+
+	PlanCacheStats stats() const;
+
+private:
+	struct Entry {
+		int userId;
+		Body body;
+		std::size_t bytes;
+	};
+
+	struct Writing {
+		std::size_t active = 0;
+		bool overlapped = false;   // a second Write opened while one was active
+	};
+
+	struct Shard {
+		mutable std::mutex mutex;
+		std::list<Entry> lru; // most recently used first
+		std::unordered_map<int, std::list<Entry>::iterator> entries;
+		std::size_t bytes = 0;
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+		std::uint64_t invalidations = 0;
+		std::uint64_t staleFills = 0;
+		Token generation = 0;
+		std::uint64_t clears = 0;                   // clear() calls, checked by Write::commit
+		std::unordered_map<int, Writing> writing;   // users with Writes not yet ended
+	};
+
+	std::size_t shardCapacity;
+	std::vector<Shard> shards;
+
+	Shard& shardFor(int userId);
+	void erase(Shard& shard, int userId);
+	// Ends one Write for the user; true if no other Write for the user overlapped it
+	bool endWrite(Shard& shard, int userId);
+	void store(Shard& shard, int userId, std::string body);
+};
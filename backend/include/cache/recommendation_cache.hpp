@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../models/plan.hpp"
+#include "../models/user_profile.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct RecommendationCacheStats {
+	std::size_t entries = 0;
+	std::size_t bytes = 0;
+	std::size_t capacityBytes = 0;
+	std::uint64_t hits = 0;
+	std::uint64_t misses = 0;          // computed by the caller
+	std::uint64_t coalesced = 0;       // waited for an identical request already computing
+	std::uint64_t rejected = 0;        // computed but not admitted (colder than the LRU victim)
+	std::uint64_t evictions = 0;
+	std::uint64_t computeNs = 0;       // time spent computing misses
+	std::uint64_t savedNs = 0;         // compute time of the entries served to hits and coalesced waiters
+};
+
+// Plans for canonical profiles: a plan depends only on the catalog version, the target domain,
+// the current level, the interests (as a multiset) and the total hour budget, so profiles that
+// agree on those share one entry whatever their userId, interest order or week split.
+//
+// Sharded and memory-bounded like PlanCache, with TinyLFU admission: each shard keeps a
+// count-min sketch of recent key frequencies (halved every `sampleSize` lookups), and a new
+// entry that needs room is admitted only when its key is more frequent than the LRU victim,
+// so one-off profiles cannot flush the popular ones. Concurrent misses on the same key are
+// collapsed: the first caller computes, the others wait for its result.
+class RecommendationCache {
+public:
+	struct Value {
+		Plan plan;
+		std::string body;                    // the enriched plan as rendered for the response
+		std::chrono::nanoseconds cost{0};    // what computing it took (filled in by the cache)
+	};
+	using Entry = std::shared_ptr<const Value>;
+	using Compute = std::function<Value()>;
+
+	explicit RecommendationCache(std::size_t maxBytes, std::size_t shardCount = 16);
+
+	// Canonical key of `profile` against catalog `catalogVersion`
+	static std::string key(std::uint64_t catalogVersion, const UserProfile& profile);
+
+	// The cached entry for `key`, or compute()'s result, stored if admitted. `hit` reports whether
+	// the value came from the cache (or another caller's computation). Exceptions from compute()
+	// reach every caller waiting on it; nothing is cached.
+	Entry getOrCompute(const std::string& key, const Compute& compute, bool* hit = nullptr);
+
+	void clear();
+
+	RecommendationCacheStats stats() const;
+
+private:
+	// 4 rows of 8-bit saturating counters
+	class FrequencySketch {
+	public:
+		explicit FrequencySketch(std::size_t width);
+		void record(std::uint64_t hash);
+		std::uint8_t estimate(std::uint64_t hash) const;
+
+	private:
+		std::size_t index(std::uint64_t hash, int row) const;
+
+		std::size_t mask;
+		std::vector<std::uint8_t> counters;   // 4 x (mask + 1)
+		std::size_t recorded = 0;
+		std::size_t sampleSize;
+	};
+
+	struct Slot {
+		std::string key;
+		std::uint64_t hash;
+		Entry value;
+		std::size_t bytes;
+	};
+
+	struct Shard {
+		explicit Shard(std::size_t sketchWidth) : sketch(sketchWidth) {}
+
+		mutable std::mutex mutex;
+		std::list<Slot> lru;   // most recently used first
+		std::unordered_map<std::string, std::list<Slot>::iterator> entries;
+		std::unordered_map<std::string, std::shared_future<Entry>> inFlight;
+		FrequencySketch sketch;
+		std::size_t bytes = 0;
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t coalesced = 0;
+		std::uint64_t rejected = 0;
+		std::uint64_t evictions = 0;
+		std::uint64_t computeNs = 0;
+		std::uint64_t savedNs = 0;
+	};
+
+	void store(Shard& shard, const std::string& key, std::uint64_t hash, const Entry& value);
+
+	std::size_t shardCapacity;
+	std::vector<std::unique_ptr<Shard>> shards;
+};
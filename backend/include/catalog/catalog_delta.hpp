@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../models/course.hpp"
+#include <cstdint>
+#include <vector>
+
+// A batch of catalog changes keyed by course id: every course in `upserts` replaces the
+// course with its id (or is added), every id in `removals` is dropped. An id that appears in
+// both is upserted; unknown removal ids are ignored.
+struct CatalogDelta {
+	std::vector<Course> upserts;
+	std::vector<int> removals;
+
+	bool empty() const { return upserts.empty() && removals.empty(); }
+};
+
+// Changes committed to a versioned catalog after some earlier version
+struct CatalogChangeSet {
+	std::uint64_t version = 0;   // catalog version the delta brings a reader up to
+	CatalogDelta delta;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "catalog_index.hpp"
+#include "../http/plan_writer.hpp"
+#include "../http/prerendered_body.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// One published catalog version: the index plus the responses derived from it
+struct LoadedCatalog {
+	LoadedCatalog(std::uint64_t catalogVersion, CatalogIndex catalogIndex);
+
+	const std::uint64_t version;
+	const CatalogIndex index;
+	const LazyPrerenderedBody coursesBody;   // GET /api/courses
+	const LazyPrerenderedBody tagsBody;      // GET /api/tags
+	const PlanFragments planFragments;       // enriched plan bodies (http/plan_writer.hpp)
+};
+
+struct CatalogHolderStats {
+	std::uint64_t version = 0;
+	std::uint64_t reloads = 0;    // successful full reloads after the initial load
+	std::uint64_t patches = 0;    // successful incremental updates
+	std::uint64_t failures = 0;   // reloads or patches that threw; the previous version stays published
+	double lastReloadMs = 0.0;
+};
+
+// RCU-style owner of the live catalog. Request handlers call current() once and keep the
+// returned shared_ptr for the whole request, so a reload never changes the catalog under
+// them; the old version is freed when its last reader finishes. Reloads run on a
+// background thread: the loader builds a complete new index, which is then published with
+// one atomic store. A failing loader leaves the current version in place. Deltas go through
+// the same thread as patches, which derive the next index from the current one instead of
+// loading it from scratch.
+class CatalogHolder {
+public:
+	using Loader = std::function<CatalogIndex()>;
+	using Patch = std::function<std::optional<CatalogIndex>(const CatalogIndex&)>;
+	using Listener = std::function<void(const LoadedCatalog&)>;
+
+	// Loads the first version on the calling thread; throws if that fails
+	explicit CatalogHolder(Loader loader);
+	~CatalogHolder();
+
+	CatalogHolder(const CatalogHolder&) = delete;
+	CatalogHolder& operator=(const CatalogHolder&) = delete;
+
+	std::shared_ptr<const LoadedCatalog> current() const { return published.load(std::memory_order_acquire); }
+
+	// Queues a reload; requests that arrive while one is queued are merged into it
+	void requestReload(const std::string& reason);
+	// Queues `patch` to run against the index current at that point; it returns the next index,
+	// or nothing when there is nothing to apply. Reloads and patches run in request order.
+	void requestPatch(const std::string& reason, Patch patch);
+	// Polls `path` and queues a reload when its size or modification time changes
+	void watchFile(std::string path, std::chrono::milliseconds interval);
+	// Called on the reload thread after each swap, e.g. to drop caches built from the old version
+	void onReload(Listener listener);
+
+	CatalogHolderStats stats() const;
+
+private:
+	struct Update {
+		std::string reason;
+		Patch patch;   // empty for a full reload
+	};
+
+	void run();
+	void apply(const Update& update);
+	bool fileChanged();
+
+	Loader loader;
+	std::atomic<std::shared_ptr<const LoadedCatalog>> published;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Update> pending;
+	bool reloadQueued = false;
+	bool stopping = false;
+	Listener listener;
+	std::string watchPath;
+	std::chrono::milliseconds watchInterval{0};
+	std::string watchStamp;
+
+	std::atomic<std::uint64_t> reloads{0};
+	std::atomic<std::uint64_t> patches{0};
+	std::atomic<std::uint64_t> failures{0};
+	std::atomic<double> lastReloadMs{0.0};
+	std::thread worker;
+};
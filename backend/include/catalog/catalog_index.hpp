@@ -0,0 +1,172 @@
+#pragma once
+
+#include "../models/course.hpp"
+#include "catalog_snapshot.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class CatalogAffinity;
+class CourseView;
+class PrereqGraph;
+
+// In-memory index over the course catalog. Courses live in dense slots (0..size()-1,
+// in catalog order); every secondary structure stores slots, so lookups never copy
+// or rescan course data.
+//
+// The index is a read-only view over a CatalogSnapshot image: scorer-relevant fields
+// in contiguous per-slot columns, domains/levels as small integer codes, tags as dense
+// tag ids and all strings in a single arena. The image is either built from
+// ICatalog::getAll() or mapped straight from a snapshot file, so a mapped index is
+// ready without parsing; copies share the image.
+class CatalogIndex {
+public:
+	using Slot = std::uint32_t;
+	using SlotList = std::vector<Slot>;
+	using SlotSpan = std::span<const Slot>;
+	using DomainCode = std::uint16_t;
+	using LevelCode = std::uint8_t;
+
+	CatalogIndex() = default;
+	explicit CatalogIndex(const std::vector<Course>& courses);
+	explicit CatalogIndex(std::shared_ptr<const CatalogSnapshot> snapshot);
+
+	// A new index with `delta` applied (see CatalogSnapshot::patch); this one is left untouched
+	CatalogIndex apply(const CatalogDelta& delta) const;
+
+	std::size_t size() const { return idColumn.size(); }
+	bool empty() const { return idColumn.empty(); }
+
+	// Materialized Course objects, for serialization and tools
+	Course course(Slot slot) const;
+	std::vector<Course> courses() const;
+	CourseView view(Slot slot) const;
+
+	// id -> slot (first course wins on duplicate ids, like the old linear scan)
+	std::optional<Slot> slotOf(int courseId) const;
+	std::optional<CourseView> find(int courseId) const;
+
+	// Partitions; each list is in ascending slot order. Unknown keys give an empty list.
+	SlotSpan byDomain(const std::string& domain) const;
+	SlotSpan byDomain(DomainCode code) const { return row(domainPostingOffsets, domainPostings, code); }
+	SlotSpan byLevel(const std::string& level) const;
+
+	// Inverted index: tag -> posting list of slots carrying that tag
+	SlotSpan byTag(const std::string& tag) const;
+
+	// Distinct tags in lexicographic order; a tag's position is its dense tag id
+	const std::vector<std::string>& tags() const { return sortedTags; }
+	std::optional<std::uint32_t> tagId(const std::string& tag) const;
+	std::string_view tagName(std::uint32_t id) const { return str(tagNameRefs[id]); }
+
+	// Domain / level dictionaries (codes are assigned in order of first appearance)
+	std::size_t domainCount() const { return domainNameRefs.size(); }
+	std::size_t levelCount() const { return levelNameRefs.size(); }
+	std::string_view domainName(DomainCode code) const { return str(domainNameRefs[code]); }
+	std::string_view levelName(LevelCode code) const { return str(levelNameRefs[code]); }
+	std::optional<DomainCode> domainCode(const std::string& domain) const;
+	std::optional<LevelCode> levelCode(const std::string& level) const;
+
+	// Struct-of-arrays columns, indexed by slot
+	std::span<const DomainCode> domainCodes() const { return domainColumn; }
+	std::span<const LevelCode> levelCodes() const { return levelColumn; }
+	std::span<const std::int32_t> durations() const { return durationColumn; }
+	std::span<const double> scores() const { return scoreColumn; }
+
+	// Prerequisite graph (topological ranks, closures, cycle report); built on first use, shared by copies
+	const PrereqGraph& prerequisiteGraph() const;
+	// Level and domain affinity in this version's codes (services/affinity.hpp); built on first use, shared by copies
+	const CatalogAffinity& affinity() const;
+
+	// The image this index reads, e.g. to save it as a snapshot file
+	const std::shared_ptr<const CatalogSnapshot>& snapshot() const { return image; }
+
+private:
+	friend class CourseView;
+
+	using StrRef = CatalogSnapshot::StrRef;
+	using Section = CatalogSnapshot::Section;
+
+	struct Derived;
+
+	std::shared_ptr<const CatalogSnapshot> image;
+	std::shared_ptr<Derived> derived;
+
+	// Name lookups, rebuilt from the dictionaries when the index is bound
+	std::vector<std::string> sortedTags;
+	std::unordered_map<std::string, std::uint32_t> tagIds;
+	std::unordered_map<std::string, DomainCode> domainCodeByName;
+	std::unordered_map<std::string, LevelCode> levelCodeByName;
+
+	// Views into the image
+	std::string_view arena;
+	std::span<const StrRef> tagNameRefs;
+	std::span<const StrRef> domainNameRefs;
+	std::span<const StrRef> levelNameRefs;
+
+	// Columns
+	std::span<const DomainCode> domainColumn;
+	std::span<const LevelCode> levelColumn;
+	std::span<const std::int32_t> durationColumn;
+	std::span<const double> scoreColumn;
+	std::span<const std::int32_t> idColumn;
+	std::span<const StrRef> titleColumn;
+
+	// CSR lists: entries of row r are [offsets[r], offsets[r + 1])
+	std::span<const std::uint32_t> tagListOffsets;
+	std::span<const std::uint32_t> tagList;
+	std::span<const std::uint32_t> prereqOffsets;
+	std::span<const std::int32_t> prereqList;
+	std::span<const std::uint32_t> idOrder;   // slots sorted by course id
+	std::span<const std::uint32_t> domainPostingOffsets;
+	std::span<const std::uint32_t> domainPostings;
+	std::span<const std::uint32_t> levelPostingOffsets;
+	std::span<const std::uint32_t> levelPostings;
+	std::span<const std::uint32_t> tagPostingOffsets;
+	std::span<const std::uint32_t> tagPostings;
+
+	std::string_view str(StrRef ref) const { return arena.substr(ref.offset, ref.length); }
+	void bind();
+
+	static SlotSpan row(std::span<const std::uint32_t> offsets, std::span<const std::uint32_t> entries, std::size_t r) {
+		return entries.subspan(offsets[r], offsets[r + 1] - offsets[r]);
+	}
+};
+
+// Non-owning, allocation-free view of one catalog course
+class CourseView {
+	const CatalogIndex* catalog;
+	CatalogIndex::Slot slot;
+
+public:
+	CourseView(const CatalogIndex& index, CatalogIndex::Slot courseSlot) : catalog(&index), slot(courseSlot) {}
+
+	CatalogIndex::Slot getSlot() const { return slot; }
+	int getId() const { return catalog->idColumn[slot]; }
+	std::string_view getTitle() const { return catalog->str(catalog->titleColumn[slot]); }
+	std::string_view getDomain() const { return catalog->domainName(catalog->domainColumn[slot]); }
+	std::string_view getLevel() const { return catalog->levelName(catalog->levelColumn[slot]); }
+	CatalogIndex::DomainCode getDomainCode() const { return catalog->domainColumn[slot]; }
+	CatalogIndex::LevelCode getLevelCode() const { return catalog->levelColumn[slot]; }
+	int getDurationHours() const { return catalog->durationColumn[slot]; }
+	double getScore() const { return catalog->scoreColumn[slot]; }
+
+	// Tags as dense tag ids; resolve names with getTag(i) or CatalogIndex::tagName
+	std::span<const std::uint32_t> getTagIds() const {
+		return CatalogIndex::row(catalog->tagListOffsets, catalog->tagList, slot);
+	}
+	std::string_view getTag(std::size_t i) const { return catalog->tagName(getTagIds()[i]); }
+
+	std::span<const std::int32_t> getPrerequisiteCourseIds() const {
+		return catalog->prereqList.subspan(catalog->prereqOffsets[slot], catalog->prereqOffsets[slot + 1] - catalog->prereqOffsets[slot]);
+	}
+};
+
+inline CourseView CatalogIndex::view(Slot slot) const {
+	return CourseView(*this, slot);
+}
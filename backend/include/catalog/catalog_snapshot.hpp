@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../models/course.hpp"
+#include "catalog_delta.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Versioned binary image of the course catalog, laid out exactly as CatalogIndex reads it,
+// so a snapshot file can be mapped and used in place instead of parsed.
+//
+// File layout (little-endian, every section 8-byte aligned):
+//   Header        magic "RMCATLOG", version, byte-order mark, section table {offset, bytes}
+//   Arena         titles and tag/domain/level names, referenced by StrRef
+//   Course columns fixed width, one entry per slot: ids, titles, domain and level codes,
+//                 durations, scores
+//   Tag lists     CSR: tag ids of slot s are tagList[tagOffsets[s] .. tagOffsets[s + 1])
+//   Prerequisites CSR adjacency of prerequisite course ids, same scheme
+//   Dictionaries  tag names (sorted; position = tag id), domain and level names (by code)
+//   Lookups       slots ordered by course id; per-domain, per-level and per-tag posting lists
+class CatalogSnapshot {
+public:
+	static constexpr std::uint32_t Version = 1;
+
+	struct StrRef {
+		std::uint32_t offset = 0;
+		std::uint32_t length = 0;
+	};
+
+	enum class Section : std::uint32_t {
+		Arena,
+		Ids,
+		Titles,
+		DomainCodes,
+		LevelCodes,
+		Durations,
+		Scores,
+		TagOffsets,
+		TagList,
+		PrereqOffsets,
+		PrereqList,
+		TagNames,
+		DomainNames,
+		LevelNames,
+		IdOrder,
+		DomainPostingOffsets,
+		DomainPostings,
+		LevelPostingOffsets,
+		LevelPostings,
+		TagPostingOffsets,
+		TagPostings,
+		Count
+	};
+
+	// Lays the catalog out in memory (the same bytes save() writes)
+	static std::shared_ptr<const CatalogSnapshot> build(const std::vector<Course>& courses);
+	// Copies `base` with `delta` applied. Unchanged courses keep their relative order and new
+	// ones take slots at the end (in id order); columns, CSR lists and posting lists are patched
+	// rather than rebuilt, and the tag dictionary is re-sorted only when tags appear or
+	// disappear. Strings of replaced courses stay in the arena until it is half garbage.
+	static std::shared_ptr<const CatalogSnapshot> patch(const CatalogSnapshot& base, const CatalogDelta& delta);
+	// Maps a snapshot file read-only; throws std::runtime_error when it is missing or malformed
+	static std::shared_ptr<const CatalogSnapshot> map(const std::string& path);
+
+	CatalogSnapshot(const CatalogSnapshot&) = delete;
+	CatalogSnapshot& operator=(const CatalogSnapshot&) = delete;
+	~CatalogSnapshot();
+
+	// Writes the image to `path` (through a temporary file and a rename)
+	void save(const std::string& path) const;
+
+	std::size_t bytes() const { return size; }
+	bool mapped() const { return mapping != nullptr; }
+
+	template <typename T>
+	std::span<const T> section(Section id) const {
+		SectionEntry entry = sectionEntry(id);
+		return std::span<const T>(reinterpret_cast<const T*>(data + entry.offset), entry.bytes / sizeof(T));
+	}
+
+private:
+	struct SectionEntry {
+		std::uint64_t offset = 0;
+		std::uint64_t bytes = 0;
+	};
+
+	struct Mapping;
+
+	CatalogSnapshot() = default;
+
+	SectionEntry sectionEntry(Section id) const;
+	void validate(const std::string& source) const;
+
+	std::unique_ptr<std::uint64_t[]> owned;   // backing store for build() and patch(), 8-byte aligned
+	Mapping* mapping = nullptr;         // backing store for map()
+	const char* data = nullptr;
+	std::size_t size = 0;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "icatalog.hpp"
+#include <string>
+
+// Catalog read from a courses.json file (data/courses.json schema), for running the
+// server without PostgreSQL
+class MemoryCatalog : public ICatalog {
+	std::vector<Course> courses;
+
+public:
+	explicit MemoryCatalog(const std::string& jsonPath);
+
+	std::vector<Course> getAll() override;
+};
@@ -1,21 +1,40 @@
 #pragma once
 
 #include "icatalog.hpp"
+#include "catalog_delta.hpp"
+#include "../storage/connection_pool.hpp"
 #include <pqxx/pqxx>
+#include <cstdint>
 #include <memory>
 
+// Courses table plus a catalog version: every applyDelta() that changes rows bumps the
+// version once and stamps the rows it wrote (removed ids go to course_removals), so readers
+// can fetch only what changed since the version they hold.
 class PostgresCatalog : public ICatalog {
-	std::string connStr;
-	std::unique_ptr<pqxx::connection> conn;
+	std::shared_ptr<ConnectionPool> pool;
 
 public:
 	explicit PostgresCatalog(const std::string& connectionString);
+	explicit PostgresCatalog(std::shared_ptr<ConnectionPool> connectionPool);
 	~PostgresCatalog();
 
 	std::vector<Course> getAll() override;
-	void importFromJson(const std::string& jsonPath);
+	// Full catalog together with the version it reflects (read in one snapshot)
+	std::vector<Course> getAll(std::uint64_t& version);
+	std::uint64_t currentVersion();
+
+	// Upserts and removes courses in one transaction, in multi-row statements; rows whose
+	// contents did not change are left alone. Returns the new catalog version, or the current
+	// one if nothing changed.
+	std::uint64_t applyDelta(const CatalogDelta& delta);
+	// Rows written and ids removed after `version`, with the version they bring a reader to
+	CatalogChangeSet changesSince(std::uint64_t version);
+
+	// Makes the table match a courses.json file: upserts every course and removes the rest,
+	// so only rows that actually differ are written
+	std::uint64_t importFromJson(const std::string& jsonPath);
 
 private:
 	void createTables();
-	void reconnect();
+	std::uint64_t writeDelta(const CatalogDelta& delta, bool removeUnlisted);
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "catalog_index.hpp"
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Prerequisite graph of one catalog version, built once per version (CatalogIndex::prerequisiteGraph).
+//
+// Courses get dense ids ("ranks") in topological order, so every course ranks after all of its
+// prerequisites. Edges are kept as CSR adjacency. Each course's transitive prerequisite set is
+// a sparse bitset over ranks: only its non-zero 64-bit words are stored, each with its word
+// index. Ranks follow a depth-first order, so a course's prerequisites fall into a few words.
+// Plan builders keep the courses already taken as a dense rank bitset and test or extract
+// missing prerequisites one word at a time.
+//
+// A course can never be unlocked if it sits on a prerequisite cycle, or if any of its
+// prerequisites, directly or transitively, is on a cycle or missing from the catalog. Such
+// courses are blocked, and report() lists the causes.
+class PrereqGraph {
+public:
+	using Slot = CatalogIndex::Slot;
+	using Rank = std::uint32_t;
+	using Word = std::uint64_t;
+
+	struct Report {
+		std::vector<std::vector<int>> cycles;       // course ids of each cycle (strongly connected component)
+		std::vector<std::pair<int, int>> missing;   // (course id, prerequisite id not in the catalog)
+		std::size_t blocked = 0;                    // courses that can never be unlocked
+	};
+
+	// Transitive prerequisites of one course: bits[i] covers ranks 64 * words[i] .. 64 * words[i] + 63
+	struct Closure {
+		std::span<const std::uint32_t> words;
+		std::span<const Word> bits;
+	};
+
+	PrereqGraph() = default;
+	explicit PrereqGraph(const CatalogIndex& catalog);
+
+	std::size_t size() const { return slotOfRank.size(); }
+	// Length of a dense rank bitset
+	std::size_t words() const { return (size() + 63) / 64; }
+
+	Rank rank(Slot slot) const { return rankOfSlot[slot]; }
+	Slot slotAt(Rank rank) const { return slotOfRank[rank]; }
+	// All slots in topological order (position = rank)
+	std::span<const Slot> order() const { return slotOfRank; }
+
+	// Direct prerequisites as slots; ids missing from the catalog are left out (the course is blocked)
+	std::span<const Slot> prerequisites(Slot slot) const {
+		return std::span<const Slot>(edges).subspan(edgeOffsets[slot], edgeOffsets[slot + 1] - edgeOffsets[slot]);
+	}
+	Closure closure(Slot slot) const {
+		Rank r = rankOfSlot[slot];
+		std::size_t begin = closureOffsets[r];
+		std::size_t count = closureOffsets[r + 1] - begin;
+		return Closure{std::span<const std::uint32_t>(closureWordIndex).subspan(begin, count),
+		               std::span<const Word>(closureBits).subspan(begin, count)};
+	}
+	bool blocked(Slot slot) const { return blockedSlots[slot] != 0; }
+
+	// True when every transitive prerequisite of `slot` is set in `taken` (a dense rank bitset)
+	bool unlocked(Slot slot, std::span<const Word> taken) const {
+		Closure c = closure(slot);
+		for (std::size_t i = 0; i < c.words.size(); ++i) {
+			if (c.bits[i] & ~taken[c.words[i]]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Calls f(rank) for each transitive prerequisite of `slot` not set in `taken`, in topological order
+	template <typename F>
+	void forEachMissing(Slot slot, std::span<const Word> taken, F&& f) const {
+		Closure c = closure(slot);
+		for (std::size_t i = 0; i < c.words.size(); ++i) {
+			for (Word missing = c.bits[i] & ~taken[c.words[i]]; missing; missing &= missing - 1) {
+				f(static_cast<Rank>(c.words[i] * 64 + static_cast<std::uint32_t>(std::countr_zero(missing))));
+			}
+		}
+	}
+
+	const Report& report() const { return problems; }
+
+private:
+	std::vector<std::uint32_t> edgeOffsets;   // CSR by slot
+	std::vector<Slot> edges;
+	std::vector<Rank> rankOfSlot;
+	std::vector<Slot> slotOfRank;
+	std::vector<std::uint8_t> blockedSlots;
+
+	// Sparse closure bitsets, CSR by rank
+	std::vector<std::uint32_t> closureOffsets;
+	std::vector<std::uint32_t> closureWordIndex;
+	std::vector<Word> closureBits;
+
+	Report problems;
+};
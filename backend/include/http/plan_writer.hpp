@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../catalog/catalog_index.hpp"
+#include "../models/plan.hpp"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Serializer for enriched plans (the body of POST /api/recommendations and GET /api/plans/<int>):
+// each step with its course's title, domain, level and tags, byte for byte what dumping the
+// equivalent nlohmann object gives (keys in sorted order).
+//
+// Everything a step takes from the catalog is escaped once per catalog version (PlanFragments,
+// held by LoadedCatalog) and spliced into the output with append; only the numbers and the step
+// note are formatted per request. Output goes to a caller-owned string, so a reused buffer
+// makes rendering allocation-free and linear in the size of the body.
+
+// Pre-escaped JSON pieces of one catalog version. Kept per distinct string (domain and level
+// codes, tag ids) rather than per course, so they stay small next to the index; titles are
+// stored only when they need escaping.
+class PlanFragments {
+public:
+	PlanFragments() = default;
+	explicit PlanFragments(const CatalogIndex& catalog);
+
+	// {"courseDomain":"<domain>","courseId":
+	std::string_view domainPrefix(CatalogIndex::DomainCode code) const { return piece(domainOffsets, code); }
+	// ,"courseLevel":"<level>","courseTags":[
+	std::string_view levelPart(CatalogIndex::LevelCode code) const { return piece(levelOffsets, code); }
+	// "<tag>"
+	std::string_view tag(std::uint32_t tagId) const { return piece(tagOffsets, tagId); }
+	// <title> as it goes between quotes
+	std::string_view title(const CourseView& course) const;
+
+private:
+	std::string_view piece(const std::vector<std::uint32_t>& offsets, std::size_t i) const {
+		return std::string_view(text).substr(offsets[i], offsets[i + 1] - offsets[i]);
+	}
+
+	std::string text;
+	std::vector<std::uint32_t> domainOffsets;   // CSR into text, by domain code
+	std::vector<std::uint32_t> levelOffsets;    // by level code
+	std::vector<std::uint32_t> tagOffsets;      // by tag id
+	std::unordered_map<CatalogIndex::Slot, std::string> escapedTitles;
+};
+
+// Appends `value` with JSON string escaping (as nlohmann::json::dump does; UTF-8 passes through)
+void appendJsonEscaped(std::string& out, std::string_view value);
+
+// Appends `plan` enriched from `catalog` to `out`; steps whose course is gone keep only their own fields
+void writeEnrichedPlan(std::string& out, const Plan& plan, const CatalogIndex& catalog, const PlanFragments& fragments);
+
+// writeEnrichedPlan into this thread's reusable buffer; the view is valid until the thread's next call
+std::string_view renderEnrichedPlan(const Plan& plan, const CatalogIndex& catalog, const PlanFragments& fragments);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Immutable HTTP response body rendered once (per catalog version) together with
+// gzip and deflate variants, so GET handlers only pick bytes. Each variant is its own
+// representation and carries its own strong ETag: "<hash>", "<hash>-gz", "<hash>-df".
+class PrerenderedBody {
+public:
+	PrerenderedBody() = default;
+	explicit PrerenderedBody(std::string body);
+
+	std::size_t size() const { return identity.size(); }
+
+	// Best variant for an Accept-Encoding header; `encoding` is set to "gzip", "deflate" or ""
+	// and `etag` to that variant's tag
+	const std::string& select(std::string_view acceptEncoding, std::string_view& encoding, std::string_view& etag) const;
+
+	// If-None-Match handling (weak comparison, "*" and lists are supported); any variant's tag
+	// matches, since they all stand for the same content
+	bool matches(std::string_view ifNoneMatch) const;
+
+private:
+	std::string identity;
+	std::string gzip;
+	std::string deflate;
+	std::string tag;
+	std::string gzipTag;
+	std::string deflateTag;
+};
+
+// PrerenderedBody built by the first request that needs it, so rendering and compressing
+// a large catalog does not delay startup
+class LazyPrerenderedBody {
+public:
+	explicit LazyPrerenderedBody(std::function<std::string()> render);
+
+	const PrerenderedBody& get() const;
+
+private:
+	mutable std::function<std::string()> render;
+	mutable std::once_flag once;
+	mutable PrerenderedBody body;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../models/plan.hpp"
+#include "../models/user_profile.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Typed decoders for the POST bodies on the request path. Each one reads its schema in a
+// single pass straight into the model type, without building a JSON DOM: strings are
+// unescaped once into the field they end up in and unknown keys are skipped unparsed.
+//
+// Bodies over the size limit are rejected before any byte is read, and malformed JSON,
+// wrong types, missing required fields and overlong strings or arrays are rejected at the
+// first offending byte. Field semantics follow json_helpers.hpp (absent profile fields keep
+// their defaults, last duplicate key wins); integers must be numbers that fit in an int.
+
+// Rejected body; what() names the problem and its byte offset. Handlers answer 400 with it.
+class RequestDecodeError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+struct DecodeLimits {
+	std::size_t maxBodyBytes;
+	std::size_t maxStringBytes;   // after unescaping
+	std::size_t maxItems;         // interests, plan steps
+	std::size_t maxDepth;         // nesting, including unknown values being skipped
+};
+
+inline constexpr DecodeLimits ProfileBodyLimits{16 * 1024, 1024, 256, 16};
+inline constexpr DecodeLimits PlanBodyLimits{1024 * 1024, 4096, 4096, 16};
+inline constexpr DecodeLimits AuthBodyLimits{4 * 1024, 256, 0, 16};
+
+struct Credentials {
+	std::string username;
+	std::string email;
+	std::string password;
+};
+
+// {"profile": {"userId", "targetDomain", "currentLevel", "interests", "hoursPerWeek", "deadlineWeeks"}}
+UserProfile decodeRecommendationRequest(std::string_view body, const DecodeLimits& limits = ProfileBodyLimits);
+
+// {"steps": [{"step", "courseId", "hours", "note"}, ...], "totalHours"}; enriched step fields
+// (courseTitle, courseTags, ...) are accepted and ignored, so a GET body can be posted back
+Plan decodePlan(std::string_view body, const DecodeLimits& limits = PlanBodyLimits);
+
+// {"username", "password"} and, with `withEmail`, "email"; all required strings
+Credentials decodeCredentials(std::string_view body, bool withEmail, const DecodeLimits& limits = AuthBodyLimits);
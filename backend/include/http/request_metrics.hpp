@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../../third_party/crow_all.h"
+#include "../metrics/metrics.hpp"
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+// Crow middleware recording per-route latency histograms and status-class counters.
+// Routes are registered with track() before app.run(); the lookup table is read-only
+// afterwards, so requests never take a lock. Untracked paths share route="other".
+struct RequestMetrics {
+	struct context {
+		std::chrono::steady_clock::time_point start;
+	};
+
+	struct Route {
+		metrics::Histogram* latency = nullptr;
+		std::array<metrics::Counter*, 5> byClass{};   // 1xx..5xx
+	};
+
+	RequestMetrics() : other(makeRoute("ANY", "other")) {
+	}
+
+	void track(crow::HTTPMethod method, const std::string& route) {
+		routes.emplace(crow::method_name(method) + " " + route, makeRoute(crow::method_name(method), route));
+	}
+
+	void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+		ctx.start = std::chrono::steady_clock::now();
+	}
+
+	void after_handle(crow::request& req, crow::response& res, context& ctx) {
+		Route& route = find(req.method, req.url);
+		route.latency->record(std::chrono::steady_clock::now() - ctx.start);
+		int statusClass = res.code / 100;
+		if (statusClass >= 1 && statusClass <= 5) {
+			route.byClass[statusClass - 1]->add();
+		}
+	}
+
+private:
+	static Route makeRoute(const std::string& method, const std::string& route) {
+		metrics::Registry& registry = metrics::registry();
+		std::string labels = "method=\"" + method + "\",route=\"" + route + "\"";
+		Route result;
+		result.latency = &registry.histogram("roadmap_http_request_duration_seconds",
+		                                     "HTTP request latency by route", labels);
+		for (int i = 0; i < 5; ++i) {
+			result.byClass[i] = &registry.counter("roadmap_http_requests_total", "HTTP requests by route and status class",
+			                                      labels + ",code=\"" + std::to_string(i + 1) + "xx\"");
+		}
+		return result;
+	}
+
+	// "/api/plans/42" -> "/api/plans/<int>", matching the CROW_ROUTE pattern
+	Route& find(crow::HTTPMethod method, const std::string& url) {
+		thread_local std::string key;
+		key = crow::method_name(method);
+		key += ' ';
+		std::size_t i = 0;
+		while (i < url.size()) {
+			std::size_t end = url.find('/', i + 1);
+			if (end == std::string::npos) end = url.size();
+			std::size_t digits = i + 1;
+			while (digits < end && url[digits] >= '0' && url[digits] <= '9') ++digits;
+			if (url[i] == '/' && digits == end && end > i + 1) {
+				key += "/<int>";
+			} else {
+				key.append(url, i, end - i);
+			}
+			i = end;
+		}
+		auto it = routes.find(key);
+		if (it != routes.end()) {
+			return it->second;
+		}
+		return other;
+	}
+
+	std::unordered_map<std::string, Route> routes;
+	Route other;
+};
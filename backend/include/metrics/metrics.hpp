@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide metrics in the Prometheus text format (served at /api/metrics).
+// Counters and histograms are striped across cache lines by thread, so recording is a
+// relaxed atomic add on a line no other thread writes to; stripes are summed on scrape.
+namespace metrics {
+
+constexpr std::size_t Stripes = 16;
+
+std::size_t threadStripe();
+
+class Counter {
+public:
+	void add(std::uint64_t n = 1) {
+		cells[threadStripe()].value.fetch_add(n, std::memory_order_relaxed);
+	}
+	std::uint64_t value() const;
+
+private:
+	struct alignas(64) Cell {
+		std::atomic<std::uint64_t> value{0};
+	};
+	std::array<Cell, Stripes> cells;
+};
+
+// HDR-style log-linear histogram of durations in nanoseconds: 8 sub-buckets per power of
+// two (<= 12.5% relative error) from 1ns to ~18 minutes, larger values clamp to the top bucket
+class Histogram {
+public:
+	static constexpr int SubBits = 3;
+	static constexpr std::size_t Buckets = 16 + (40 - 4) * 8;
+
+	struct Snapshot {
+		std::array<std::uint64_t, Buckets> counts{};
+		std::uint64_t count = 0;
+		std::uint64_t sumNs = 0;
+
+		std::uint64_t countAtOrBelow(std::uint64_t ns) const;
+		std::uint64_t quantile(double q) const;   // upper edge of the bucket holding q, in ns
+	};
+
+	void record(std::chrono::nanoseconds duration);
+	Snapshot snapshot() const;
+
+	static std::size_t bucketOf(std::uint64_t ns);
+	static std::uint64_t upperEdge(std::size_t bucket);
+
+private:
+	struct alignas(64) Stripe {
+		std::array<std::atomic<std::uint64_t>, Buckets> counts{};
+		std::atomic<std::uint64_t> sumNs{0};
+	};
+	std::unique_ptr<Stripe[]> stripes{new Stripe[Stripes]};
+};
+
+// Records the lifetime of the scope into a histogram
+class ScopedTimer {
+public:
+	explicit ScopedTimer(Histogram& histogram)
+		: histogram(histogram), start(std::chrono::steady_clock::now()) {
+	}
+	~ScopedTimer() { histogram.record(std::chrono::steady_clock::now() - start); }
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	Histogram& histogram;
+	std::chrono::steady_clock::time_point start;
+};
+
+// Labels are given pre-rendered, e.g. R"(route="/api/courses",method="GET")"
+class Registry {
+public:
+	// Returned references stay valid for the life of the process; registering the same
+	// name and labels twice returns the same metric
+	Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+	Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+	// Evaluated on every scrape, for values owned elsewhere (cache sizes, pool state, ...)
+	void gauge(const std::string& name, const std::string& help, const std::string& labels,
+	           std::function<double()> read);
+	void counterFunction(const std::string& name, const std::string& help, const std::string& labels,
+	                     std::function<double()> read);
+
+	std::string render() const;
+
+private:
+	enum class Type { Counter, Gauge, Histogram };
+
+	struct Series {
+		std::string labels;
+		Counter* counter = nullptr;
+		Histogram* histogram = nullptr;
+		std::function<double()> read;
+	};
+
+	struct Family {
+		std::string name;
+		std::string help;
+		Type type;
+		std::vector<Series> series;
+	};
+
+	Family& family(const std::string& name, const std::string& help, Type type);
+	Series* find(Family& family, const std::string& labels);
+
+	mutable std::mutex mutex;
+	std::deque<Family> families;
+	std::deque<Counter> counters;
+	std::deque<Histogram> histograms;
+};
+
+Registry& registry();
+
+// Sub-phases of request handling, recorded as roadmap_phase_duration_seconds{phase=...}
+enum class Phase { JsonParse, MakePlan, Scoring, Serialize };
+
+Histogram& phase(Phase which);
+
+}
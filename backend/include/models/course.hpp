@@ -7,12 +7,12 @@
 
 
 class Course {
-	int id;
+	int id = 0;
 	std::string title;
 	std::string domain;
 	std::string level;
-	int durationHours;
-	double score;
+	int durationHours = 0;
+	double score = 1.0;
 	std::vector<std::string> tags;
 	std::vector<int> prerequisiteCourseIds;
 
@@ -21,13 +21,13 @@ public:
 	// Getters
 
 	int getId() const { return id; }
-	std::string getTitle() const { return title; }
-	std::string getDomain() const { return domain; }
-	std::string getLevel() const { return level; }
+	const std::string& getTitle() const { return title; }
+	const std::string& getDomain() const { return domain; }
+	const std::string& getLevel() const { return level; }
 	int getDurationHours() const { return durationHours; }
 	double getScore() const { return score; }
-	std::vector<std::string> getTags() const { return tags; }
-	std::vector<int> getPrerequisiteCourseIds() const { return prerequisiteCourseIds; }
+	const std::vector<std::string>& getTags() const { return tags; }
+	const std::vector<int>& getPrerequisiteCourseIds() const { return prerequisiteCourseIds; }
 
 	// Setters
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <vector>
 
 struct PlanStep {
@@ -12,7 +13,7 @@ struct PlanStep {
 
 class Plan {
 	std::vector<PlanStep> steps;
-	int totalHours;
+	int totalHours = 0;
 public:
 
 	// Getters
@@ -23,6 +24,7 @@ public:
 	// Setters
 
 	void setSteps(const std::vector<PlanStep>& s) { steps = s; }
+	void setSteps(std::vector<PlanStep>&& s) { steps = std::move(s); }
 	void setTotalHours(int h) { totalHours = h; }
 
 };
\ No newline at end of file
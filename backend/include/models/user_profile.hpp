@@ -1,23 +1,24 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <vector>
 
 class UserProfile {
-	int userId;
+	int userId = 0;
 	std::string targetDomain;
 	std::string currentLevel;
 	std::vector<std::string> interests;
-	int hoursPerWeek;
-	int deadlineWeeks;
+	int hoursPerWeek = 0;
+	int deadlineWeeks = 0;
 public:
 
 	// Getters
 
 	int getUserId() const { return userId; }
-	std::string getTargetDomain() const { return targetDomain; }
-	std::string getCurrentLevel() const { return currentLevel; }
-	std::vector<std::string> getInterests() const { return interests; }
+	const std::string& getTargetDomain() const { return targetDomain; }
+	const std::string& getCurrentLevel() const { return currentLevel; }
+	const std::vector<std::string>& getInterests() const { return interests; }
 	int getHoursPerWeek() const { return hoursPerWeek; }
 	int getDeadlineWeeks() const { return deadlineWeeks; }
 
@@ -25,8 +26,11 @@ public:
 
 	void setUserId(int id) { userId = id; }
 	void setTargetDomain(const std::string& domain) { targetDomain = domain; }
+	void setTargetDomain(std::string&& domain) { targetDomain = std::move(domain); }
 	void setCurrentLevel(const std::string& level) { currentLevel = level; }
+	void setCurrentLevel(std::string&& level) { currentLevel = std::move(level); }
 	void setInterests(const std::vector<std::string>& interestList) { interests = interestList; }
+	void setInterests(std::vector<std::string>&& interestList) { interests = std::move(interestList); }
 	void setHoursPerWeek(int hours) { hoursPerWeek = hours; }
 	void setDeadlineWeeks(int weeks) { deadlineWeeks = weeks; }
 
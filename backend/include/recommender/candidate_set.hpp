@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../catalog/catalog_index.hpp"
+#include <string>
+#include <vector>
+
+// Courses a plan may recommend for one (target domain, current level) pair, with the domain
+// and level part of their scores. Nothing else in a profile affects either, so a batch builds
+// one set per pair and shares it between that pair's profiles.
+struct CandidateSet {
+    std::string targetDomain;
+    std::string level;
+    CatalogIndex::SlotList slots;
+    std::vector<double> baseScores;   // ScoringService::baseScores, by position in `slots`
+
+    // The target domain's partition, then the partitions of its related domains (DomainRelations)
+    static void slotsFor(const std::string& targetDomain, const CatalogIndex& catalog, CatalogIndex::SlotList& slots);
+
+    void assign(const CatalogIndex& catalog, const std::string& targetDomain, const std::string& level);
+};
@@ -2,9 +2,51 @@
 
 #include "../services/scoring.hpp"
 #include "istrategy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
+class ThreadPool;
+
+struct ParallelScoringOptions {
+    ThreadPool* pool = nullptr;                    // none: always score on the request thread
+    std::size_t maxThreads = 4;                    // chunks per request, so threads one request can occupy
+    std::size_t minChunk = 16384;                  // fewest candidates per chunk
+    std::chrono::microseconds inlineBudget{2000};  // split when inline scoring is expected to take longer
+};
+
+struct GreedyStats {
+    std::uint64_t inlineScorings = 0;
+    std::uint64_t parallelScorings = 0;
+    double nsPerCandidate = 0.0;   // scoring cost the parallel decision is based on
+};
+
+// Scores the candidates through a bounded top-k heap (with upper-bound pruning) and selects
+// in score order, sorting only as many candidates as the hour budget gets through.
+//
+// With a pool, makePlan(profile, catalog) scores very large candidate sets in parallel: the
+// candidates are cut into up to maxThreads chunks of at least minChunk, each chunk keeps its own
+// top k on a pool thread and the request thread merges them. Whether a request is large enough is
+// decided from the measured cost per candidate (a moving average over inline runs and the summed
+// chunk time of parallel runs), so small domains and fast machines stay inline and a slow
+// sample is corrected by the next runs. Plans are the same either way.
 class GreedyRecommender : public IRecommenderStrategy {
-    ScoringService scorer;
+    ParallelScoringOptions parallel;
+    std::atomic<double> nsPerCandidate{0.0};
+    std::atomic<std::uint64_t> inlineScorings{0};
+    std::atomic<std::uint64_t> parallelScorings{0};
+
 public:
-    Plan makePlan(const UserProfile& profile, const std::vector<Course>& allCourses) override;
+    explicit GreedyRecommender(ParallelScoringOptions parallelOptions = {});
+
+    Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog) override;
+    Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog, const CandidateSet& candidates) override;
+
+    // Selection step alone, on candidates already scored (scores[i] belongs to slots[i])
+    Plan selectPlan(const UserProfile& profile, const CatalogIndex& catalog,
+                    CatalogIndex::SlotSpan slots, std::span<const double> scores);
+
+    GreedyStats stats() const;
 };
\ No newline at end of file
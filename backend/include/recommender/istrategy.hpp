@@ -1,11 +1,16 @@
 #pragma once
 
+#include "../catalog/catalog_index.hpp"
 #include "../models/plan.hpp"
-#include "../models/course.hpp"
 #include "../models/user_profile.hpp"
+#include "candidate_set.hpp"
 
 class IRecommenderStrategy {
 public:
-    virtual Plan makePlan(const UserProfile& profile, const std::vector<Course>& allCourses) = 0;
+    virtual Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog) = 0;
+    // The same plan from candidates already prepared for the profile's target domain and level
+    virtual Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog, const CandidateSet& /*candidates*/) {
+        return makePlan(profile, catalog);
+    }
     virtual ~IRecommenderStrategy() = default;
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../services/scoring.hpp"
+#include "greedy.hpp"
+#include "istrategy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+struct KnapsackOptions {
+    std::chrono::microseconds timeBudget{20000};  // per plan, greedy baseline included
+    std::size_t dpCells = 1 << 19;                // largest items x (hours + 1) table for the DP bound
+    std::uint64_t maxNodes = 4'000'000;           // search nodes per plan
+};
+
+struct KnapsackStats {
+    std::uint64_t optimal = 0;    // search finished: no plan scores higher
+    std::uint64_t cutOff = 0;     // stopped by the node or time budget; best plan found so far
+    std::uint64_t improved = 0;   // plans that score higher than the greedy one
+};
+
+// Best plan within the time budget (hoursPerWeek * deadlineWeeks): the set of candidate courses
+// (CandidateSet::slotsFor) with the highest total score whose hours, prerequisites
+// included, fit the budget - a precedence-constrained knapsack. Prerequisites outside the
+// candidates cost hours but score nothing; blocked courses are never taken.
+//
+// Depth-first branch and bound over the courses in a topological order, starting from the
+// greedy plan's score. Small problems are bounded by a DP over hours that ignores prerequisites
+// (exact when there are none); larger ones by the best score-per-hour ratio still available.
+// The search is anytime: when it runs out of nodes or time it returns the best plan found,
+// which is never worse than the greedy one.
+class KnapsackRecommender : public IRecommenderStrategy {
+    GreedyRecommender greedy;
+    ScoringService scorer;
+    KnapsackOptions options;
+
+    std::atomic<std::uint64_t> optimal{0};
+    std::atomic<std::uint64_t> cutOff{0};
+    std::atomic<std::uint64_t> improved{0};
+
+public:
+    explicit KnapsackRecommender(KnapsackOptions knapsackOptions = {});
+
+    Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog) override;
+    Plan makePlan(const UserProfile& profile, const CatalogIndex& catalog, const CandidateSet& candidates) override;
+
+    KnapsackStats stats() const;
+
+private:
+    Plan solve(const UserProfile& profile, const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+               std::span<const double> scores, std::chrono::steady_clock::time_point deadline);
+};
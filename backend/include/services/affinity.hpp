@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../catalog/catalog_index.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Level and domain affinity used by ScoringService and CandidateSet.
+//
+// Levels are coded once per catalog version and looked up in the constexpr LevelFit matrix;
+// related domains come from a table of pairs (DefaultDomainRelations, or a file given at
+// startup) compiled into a domain-code matrix per catalog version (CatalogAffinity). Scoring
+// then only indexes tables by the codes CatalogIndex stores per course.
+
+enum class Level : std::uint8_t { Beginner, Intermediate, Advanced, Other };
+
+constexpr std::size_t LevelKinds = 4;
+
+constexpr Level parseLevel(std::string_view name) {
+    if (name == "Beginner") {
+        return Level::Beginner;
+    }
+    if (name == "Intermediate") {
+        return Level::Intermediate;
+    }
+    if (name == "Advanced") {
+        return Level::Advanced;
+    }
+    return Level::Other;
+}
+
+// Level appropriateness, LevelFit[user level][course level]. Identical level names always fit
+// 1.0, including two equal Other names (resolved where the names are known).
+inline constexpr std::array<std::array<double, LevelKinds>, LevelKinds> LevelFit = {{
+    //  Beginner  Intermediate  Advanced  Other      (course level)
+    {{  1.0,      0.8,          0.1,      0.1 }},   // Beginner: good progression to Intermediate
+    {{  0.4,      1.0,          0.8,      0.1 }},   // Intermediate: Beginner too easy but might fill gaps
+    {{  0.2,      0.5,          1.0,      0.1 }},   // Advanced: Intermediate as prerequisites/refresher
+    {{  0.1,      0.1,          0.1,      0.1 }},   // Other: poor match unless identical
+}};
+
+constexpr double fit(Level user, Level course) {
+    return LevelFit[static_cast<std::size_t>(user)][static_cast<std::size_t>(course)];
+}
+
+// Domain match (20% weight - reduced because we filter by domain first)
+inline constexpr double SameDomainBonus = 0.2;
+
+// Two domains whose courses are recommended for each other, with the bonus a course of one
+// gets for a profile targeting the other. Pairs are symmetric.
+struct DomainRelation {
+    std::string first;
+    std::string second;
+    double bonus = 0.15;
+};
+
+struct DomainRelationLiteral {
+    std::string_view first;
+    std::string_view second;
+    double bonus;
+};
+
+inline constexpr std::array<DomainRelationLiteral, 3> DefaultDomainRelations = {{
+    {"AI", "Data Science", 0.15},
+    {"DevOps", "Cloud", 0.15},
+    {"Web Development", "Mobile", 0.15},
+}};
+
+// Process-wide relation table. configure() is meant for startup, before the first catalog
+// version is loaded: compiled CatalogAffinity tables are not rebuilt when it changes.
+class DomainRelations {
+public:
+    static const std::vector<DomainRelation>& current();
+    static void configure(std::vector<DomainRelation> relations);
+    // JSON array of {"domains": [first, second], "bonus": 0.15}; throws on malformed files
+    static std::vector<DomainRelation> load(const std::string& path);
+
+    // Bonus of a `courseDomain` course for a profile targeting `targetDomain` (string path, for
+    // the reference scorer and domains the catalog does not have)
+    static double bonus(std::string_view targetDomain, std::string_view courseDomain);
+};
+
+// Affinity tables of one catalog version, in its domain and level codes (CatalogIndex::affinity)
+class CatalogAffinity {
+public:
+    using DomainCode = CatalogIndex::DomainCode;
+    using LevelCode = CatalogIndex::LevelCode;
+
+    CatalogAffinity() = default;
+    explicit CatalogAffinity(const CatalogIndex& catalog);
+
+    Level level(LevelCode code) const { return levels[code]; }
+
+    // Domain bonus of every course domain for a profile targeting `target`: row[course domain code]
+    std::span<const double> domainRow(DomainCode target) const {
+        return std::span<const double>(domainBonus).subspan(static_cast<std::size_t>(target) * domainCount, domainCount);
+    }
+
+    // Domains related to `target`, in relation-table order
+    std::span<const DomainCode> related(DomainCode target) const {
+        return std::span<const DomainCode>(relatedCodes).subspan(relatedOffsets[target], relatedOffsets[target + 1] - relatedOffsets[target]);
+    }
+
+private:
+    std::size_t domainCount = 0;
+    std::vector<Level> levels;                  // by level code
+    std::vector<double> domainBonus;            // domainCount x domainCount, by (target, course)
+    std::vector<std::uint32_t> relatedOffsets;  // CSR by target domain code
+    std::vector<DomainCode> relatedCodes;
+};
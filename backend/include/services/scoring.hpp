@@ -1,9 +1,72 @@
 #pragma once
 
+#include "../catalog/catalog_index.hpp"
 #include "../models/course.hpp"
 #include "../models/user_profile.hpp"
+#include "tag_matcher.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 class ScoringService {
 public:
     double matchScore(const Course& course, const UserProfile& profile);
+
+    // Tag-id path for catalog courses; returns exactly matchScore(catalog.course(slot), profile).
+    // `interests` must be built from the same catalog and profile.getInterests().
+    double matchScore(const CatalogIndex& catalog, CatalogIndex::Slot slot,
+                      const UserProfile& profile, const InterestMask& interests);
+
+    // Scores a whole partition (e.g. CatalogIndex::byDomain) in one pass: scores[i] is the score of slots[i].
+    // Reads only the catalog's struct-of-arrays columns and does not allocate once `scores` has capacity.
+    void scorePartition(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                        const UserProfile& profile, const InterestMask& interests,
+                        std::vector<double>& scores);
+
+    // Domain and level part of the score of each slot. It depends only on the profile's target
+    // domain and level, so profiles sharing both can share it (see CandidateSet).
+    static void baseScores(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                           const std::string& targetDomain, const std::string& level,
+                           std::vector<double>& base);
+
+    // Completes base scores with the profile's interests; gives the same scores as scorePartition
+    void scoreFromBase(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots, std::span<const double> base,
+                       const InterestMask& interests, std::vector<double>& scores);
+
+    // Domain and level part of the score by (domain code, level code): table[domain * levelCount() + level]
+    static void domainLevelTable(const CatalogIndex& catalog, const std::string& targetDomain,
+                                 const std::string& level, std::vector<double>& table);
+
+    // Full score of one course from its base score, for callers that score courses one at a time
+    static double scoreFromBase(const CatalogIndex& catalog, CatalogIndex::Slot slot, double base,
+                                const InterestMask& interests) {
+        return finishScore(base, interests.countMatches(catalog.view(slot).getTagIds()),
+                           interests.interestCount(), catalog.scores()[slot]);
+    }
+
+    // Highest score the course can reach whatever its tags (every interest matched); never below its score
+    static double upperBound(const CatalogIndex& catalog, CatalogIndex::Slot slot, double base,
+                             const InterestMask& interests) {
+        return finishScore(base, static_cast<int>(interests.interestCount()), interests.interestCount(),
+                           catalog.scores()[slot]);
+    }
+
+private:
+    static double domainLevelScore(std::string_view courseDomain, std::string_view courseLevel,
+                                   std::string_view targetDomain, std::string_view userLevel);
+    static double finishScore(double score, int matchingTags, std::size_t interestCount, double courseScore) {
+        // 3. Interest/tags match (50% weight - INCREASED for better relevance)
+        if (interestCount > 0) {
+            double tagMatchRatio = static_cast<double>(matchingTags) / interestCount;
+            score += 0.5 * tagMatchRatio;
+        }
+
+        // Bonus: Use course's inherent score if available
+        if (courseScore > 0) {
+            score *= courseScore;
+        }
+
+        return score;
+    }
 };
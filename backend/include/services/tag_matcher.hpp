@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../catalog/catalog_index.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Expanded substring-match closure of a profile's interests over the catalog's
+// tag dictionary. Tag t's mask has bit i set when tag t contains interest i or
+// interest i contains tag t - exactly the pairwise std::string::find test
+// ScoringService used per course, evaluated once per request instead.
+class InterestMask {
+public:
+    InterestMask() = default;
+    InterestMask(const CatalogIndex& catalog, const std::vector<std::string>& interests);
+
+    // Rebuilds the mask in place, reusing the existing storage
+    void assign(const CatalogIndex& catalog, const std::vector<std::string>& interests);
+
+    std::size_t interestCount() const { return interests; }
+
+    // Number of interests matching at least one tag of the course (CourseView::getTagIds)
+    int countMatches(std::span<const std::uint32_t> courseTags) const;
+
+private:
+    std::size_t words = 0;                // 64-interest blocks per tag
+    std::size_t interests = 0;
+    std::vector<std::uint64_t> bits;      // tags x words
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Point-in-time view of the pool, for logging and metrics
+struct PoolStats {
+	std::size_t capacity = 0;
+	std::size_t open = 0;     // connections currently established (idle + in use + one being pinged)
+	std::size_t inUse = 0;
+	std::size_t waiting = 0;  // threads blocked in acquire()
+	std::uint64_t acquisitions = 0;
+	std::uint64_t timeouts = 0;
+	std::uint64_t reconnects = 0;            // broken connections replaced on acquire/release
+	std::uint64_t failedHealthChecks = 0;
+	double totalWaitMs = 0.0;
+	double maxWaitMs = 0.0;
+
+	double utilization() const { return capacity ? static_cast<double>(inUse) / capacity : 0.0; }
+	double averageWaitMs() const { return acquisitions ? totalWaitMs / acquisitions : 0.0; }
+};
+
+// Bounded, thread-safe pool of PostgreSQL connections shared by PostgresStorage and
+// PostgresCatalog. Connections are opened lazily up to `capacity`; every connection
+// gets all registered prepared statements before it is handed out. Broken
+// connections are replaced transparently, and an optional background thread pings
+// idle connections so dead sockets are found before a request needs them.
+class ConnectionPool {
+	struct Entry {
+		std::unique_ptr<pqxx::connection> conn;
+		std::size_t preparedCount = 0; // how many preparers have run on this connection
+	};
+
+public:
+	using Preparer = std::function<void(pqxx::connection&)>;
+
+	// RAII handle; returns the connection to the pool when destroyed
+	class Lease {
+		ConnectionPool* pool = nullptr;
+		std::unique_ptr<Entry> entry;
+
+	public:
+		Lease(ConnectionPool* owner, std::unique_ptr<Entry> leased) : pool(owner), entry(std::move(leased)) {}
+		Lease(Lease&& other) noexcept = default;
+		Lease& operator=(Lease&& other) noexcept;
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+		~Lease();
+
+		pqxx::connection& operator*() const { return *entry->conn; }
+		pqxx::connection* operator->() const { return entry->conn.get(); }
+	};
+
+	ConnectionPool(std::string connectionString, std::size_t capacity,
+	               std::chrono::milliseconds acquireTimeout = std::chrono::seconds(5),
+	               std::chrono::milliseconds healthCheckInterval = std::chrono::seconds(30));
+	~ConnectionPool();
+
+	ConnectionPool(const ConnectionPool&) = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+	// Blocks up to the acquire timeout for a free connection; throws std::runtime_error on timeout
+	Lease acquire();
+
+	// Registers statements to prepare on every connection (current and future).
+	// Tables referenced by the statements must already exist.
+	void addPreparer(Preparer preparer);
+
+	// Pings idle connections one at a time and drops the broken ones; also run periodically in the background
+	void healthCheck();
+
+	PoolStats stats() const;
+
+private:
+	std::string connStr;
+	std::size_t capacity;
+	std::chrono::milliseconds acquireTimeout;
+	std::chrono::milliseconds healthCheckInterval;
+
+	mutable std::mutex mutex;
+	std::condition_variable available;
+	std::vector<std::unique_ptr<Entry>> idle;
+	std::vector<Preparer> preparers;
+	PoolStats counters;
+
+	std::condition_variable stopSignal;
+	bool stopping = false;
+	std::thread healthThread;
+
+	std::unique_ptr<Entry> connect();
+	void prepare(Entry& entry);
+	void release(std::unique_ptr<Entry> entry);
+	void discard();
+	void healthLoop();
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "mapped_log.hpp"
+#include "memory_storage.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct EmbeddedStorageOptions {
+	std::size_t segmentBytes = 64u << 20;
+	std::chrono::milliseconds syncInterval{200};        // how often the log is flushed to disk
+	std::chrono::seconds snapshotInterval{300};         // snapshot at least this often while writes arrive
+};
+
+struct EmbeddedStorageStats {
+	std::uint64_t segment = 0;            // log segment currently appended to
+	std::size_t segmentBytes = 0;
+	std::uint64_t appended = 0;           // records logged since startup
+	std::uint64_t snapshots = 0;
+	double lastSnapshotMs = 0.0;
+	double recoveryMs = 0.0;
+	std::uint64_t recoveredRecords = 0;   // log records replayed at startup
+};
+
+// Durable single-process IStorage: state lives in MemoryStorage, every write is appended
+// to a MappedLog before it is applied, and a background thread flushes the log and
+// periodically writes a snapshot (<dir>/snapshot-<n>.bin) so older segments can be deleted.
+// Startup loads the newest snapshot and replays the segments written after it.
+class EmbeddedStorage : public IStorage {
+public:
+	explicit EmbeddedStorage(const std::string& directory, EmbeddedStorageOptions options = {});
+	~EmbeddedStorage() override;
+
+	void savePlan(int userId, const Plan& plan) override;
+	std::optional<Plan> loadPlan(int userId) override;
+
+	void saveUser(const std::string& username, const std::string& email, const std::string& password) override;
+	bool validateUser(const std::string& username, const std::string& password) override;
+	std::optional<json> getUser(const std::string& username) override;
+
+	// Writes a snapshot now and drops the log segments it covers
+	void snapshot();
+	EmbeddedStorageStats stats() const;
+
+private:
+	void recover();
+	void apply(std::uint8_t type, std::string_view payload);
+	void run();
+
+	std::string directory;
+	EmbeddedStorageOptions options;
+	MemoryStorage state;
+	MappedLog log;
+
+	std::mutex snapshotMutex;
+	std::atomic<std::uint64_t> appended{0};
+	std::atomic<std::uint64_t> appendedAtSnapshot{0};
+	std::atomic<std::uint64_t> snapshots{0};
+	std::atomic<double> lastSnapshotMs{0.0};
+	double recoveryMs = 0.0;
+	std::uint64_t recoveredRecords = 0;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+	std::thread worker;
+};
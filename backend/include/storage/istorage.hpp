@@ -1,15 +1,31 @@
+#pragma once
+
 #include <optional>
 #include <string>
+#include <vector>
 #include "../models/plan.hpp"
 #include "../../third_party/json.hpp"
 
 using json = nlohmann::json;
 
+struct PlanWrite {
+	int userId;
+	Plan plan;
+};
+
 class IStorage {
 public:
 	virtual void savePlan(int userId, const Plan& plan) = 0;
 	virtual std::optional<Plan> loadPlan(int userId) = 0;
 
+	// Writes several plans at once; backends override this to use a single transaction.
+	// If a user appears more than once, the last plan wins.
+	virtual void savePlans(const std::vector<PlanWrite>& batch) {
+		for (const auto& write : batch) {
+			savePlan(write.userId, write.plan);
+		}
+	}
+
 	// User auth methods
 	virtual void saveUser(const std::string& username, const std::string& email, const std::string& password) = 0;
 	virtual bool validateUser(const std::string& username, const std::string& password) = 0;
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Append-only, memory-mapped record log split into fixed-size segment files
+// (<dir>/wal-<n>.log). Appends are a memcpy into the mapping under a mutex, so a record is
+// in the OS page cache (and survives a process crash) as soon as append() returns; sync()
+// forces it to disk. Records are framed as [u32 length][u32 crc32][u8 type][payload],
+// padded to 8 bytes; recovery stops at the first zero length or checksum mismatch.
+class MappedLog {
+public:
+	using Visitor = std::function<void(std::uint8_t type, std::string_view payload)>;
+
+	MappedLog(std::string directory, std::size_t segmentBytes);
+	~MappedLog();
+
+	MappedLog(const MappedLog&) = delete;
+	MappedLog& operator=(const MappedLog&) = delete;
+
+	// Replays every segment numbered >= firstSegment in order and positions the tail after
+	// the last intact record. Must be called once, before append().
+	void recover(std::uint64_t firstSegment, const Visitor& visit);
+
+	void append(std::uint8_t type, std::string_view payload);
+
+	// Closes the current segment and starts the next one; returns the new segment's number
+	std::uint64_t rotate();
+	void sync();
+	void removeSegmentsBefore(std::uint64_t segment);
+
+	std::uint64_t currentSegment() const;
+	std::size_t bytesInSegment() const;
+
+	// Record framing, shared with snapshot files
+	static void encode(std::string& out, std::uint8_t type, std::string_view payload);
+	// Visits intact records from the start of `data`; returns the bytes consumed
+	static std::size_t decode(const char* data, std::size_t size, const Visitor& visit);
+	static std::uint32_t crc32(const char* data, std::size_t size, std::uint32_t crc = 0);
+
+private:
+	struct Mapping;
+
+	std::string segmentPath(std::uint64_t segment) const;
+	void openSegment(std::uint64_t segment);
+	void closeSegment();
+
+	std::string directory;
+	std::size_t segmentBytes;
+
+	mutable std::mutex mutex;
+	Mapping* mapping = nullptr;
+	std::uint64_t segment = 0;
+	std::size_t tail = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "istorage.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// Process-local IStorage: plans and users live in hash maps split into independently
+// locked shards, so request threads only contend when they touch the same shard.
+// Nothing survives a restart; EmbeddedStorage adds a log and snapshots on top.
+class MemoryStorage : public IStorage {
+public:
+	struct User {
+		int id = 0;
+		std::string username;
+		std::string email;
+		std::string passwordHash;
+	};
+
+	void savePlan(int userId, const Plan& plan) override;
+	void savePlans(const std::vector<PlanWrite>& batch) override;
+	std::optional<Plan> loadPlan(int userId) override;
+
+	void saveUser(const std::string& username, const std::string& email, const std::string& password) override;
+	bool validateUser(const std::string& username, const std::string& password) override;
+	std::optional<json> getUser(const std::string& username) override;
+
+	static std::string hashPassword(const std::string& password);
+
+	// Runs `write` under the plan's shard lock, before the plan is stored; EmbeddedStorage
+	// logs there so the log order of one user's plans matches the order they were applied in
+	void savePlan(int userId, const Plan& plan, const std::function<void()>& write);
+	// Same for users: `write` receives the new user once username and email are known to be free
+	void saveUser(const std::string& username, const std::string& email, const std::string& password,
+	              const std::function<void(const User&)>& write);
+
+	// Recovery and snapshots: restore* overwrite (replay is idempotent), forEach* visit
+	// shard by shard under the shard's lock
+	void restorePlan(int userId, Plan plan);
+	void restoreUser(User user);
+	void forEachPlan(const std::function<void(int, const Plan&)>& visit) const;
+	void forEachUser(const std::function<void(const User&)>& visit) const;
+
+	std::size_t planCount() const;
+	std::size_t userCount() const;
+
+private:
+	static constexpr std::size_t Shards = 32;
+
+	struct alignas(64) PlanShard {
+		mutable std::shared_mutex mutex;
+		std::unordered_map<int, Plan> plans;
+	};
+
+	struct alignas(64) UserShard {
+		mutable std::shared_mutex mutex;
+		std::unordered_map<std::string, User> users;   // by username
+	};
+
+	struct alignas(64) EmailShard {
+		mutable std::shared_mutex mutex;
+		std::unordered_map<std::string, int> emails;
+	};
+
+	PlanShard& planShard(int userId) { return planShards[static_cast<unsigned>(userId) % Shards]; }
+	UserShard& userShard(const std::string& username);
+	EmailShard& emailShard(const std::string& email);
+
+	std::array<PlanShard, Shards> planShards;
+	std::array<UserShard, Shards> userShards;
+	std::array<EmailShard, Shards> emailShards;
+	std::atomic<int> nextUserId{1};
+};
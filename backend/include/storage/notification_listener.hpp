@@ -0,0 +1,38 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Subscribes to one Postgres NOTIFY channel on a dedicated connection and hands each
+// payload to a callback, reconnecting after errors. Used for `plan_changed` (trigger on
+// `plans`, see PostgresStorage::createTables) to keep plan caches of several backend
+// instances coherent, and for `courses_changed` (PostgresCatalog) to reload the catalog.
+//
+// NOTIFYs sent while the listener is disconnected are lost, so `onConnect` runs each time
+// LISTEN is (re-)established, before any notification of that connection: the place to
+// resynchronize (clear a cache, queue a catch-up) for whatever was missed in between.
+class NotificationListener {
+public:
+	using Callback = std::function<void(const std::string& payload)>;
+	using ConnectCallback = std::function<void()>;
+
+	NotificationListener(std::string connectionString, std::string channel, Callback onNotify,
+		ConnectCallback onConnect = {});
+	~NotificationListener();
+
+	NotificationListener(const NotificationListener&) = delete;
+	NotificationListener& operator=(const NotificationListener&) = delete;
+
+private:
+	std::string connStr;
+	std::string channelName;
+	Callback callback;
+	ConnectCallback connectCallback;
+	std::atomic<bool> stopping{false};
+	std::thread worker;
+
+	void run();
+};
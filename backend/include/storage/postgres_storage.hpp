@@ -1,27 +1,31 @@
 #pragma once
 
 #include "istorage.hpp"
+#include "connection_pool.hpp"
 #include <pqxx/pqxx>
 #include <string>
 #include <memory>
 
 class PostgresStorage : public IStorage {
-	std::string connStr;
-	std::unique_ptr<pqxx::connection> conn;
+	std::shared_ptr<ConnectionPool> pool;
 
 public:
 	explicit PostgresStorage(const std::string& connectionString);
+	explicit PostgresStorage(std::shared_ptr<ConnectionPool> connectionPool);
 	~PostgresStorage();
 
 	void savePlan(int userId, const Plan& plan) override;
+	void savePlans(const std::vector<PlanWrite>& batch) override;
 	std::optional<Plan> loadPlan(int userId) override;
 
 	void saveUser(const std::string& username, const std::string& email, const std::string& password) override;
 	bool validateUser(const std::string& username, const std::string& password) override;
 	std::optional<json> getUser(const std::string& username) override;
 
+	PoolStats poolStats() const { return pool->stats(); }
+
 private:
 	void createTables();
+	static void prepareStatements(pqxx::connection& conn);
 	std::string hashPassword(const std::string& password);
-	void reconnect();
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "istorage.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+enum class DurabilityMode {
+	Sync,                // savePlan writes through before returning
+	Async,               // queued; plans still pending at shutdown are dropped
+	AsyncFlushOnShutdown // queued; the destructor drains the queue
+};
+
+// Parses "sync", "async" or "async-flush"; anything else gives AsyncFlushOnShutdown
+DurabilityMode parseDurabilityMode(const std::string& value);
+
+struct WriteBehindOptions {
+	DurabilityMode mode = DurabilityMode::AsyncFlushOnShutdown;
+	std::size_t capacity = 10000;                          // max distinct users waiting to be written
+	std::size_t maxBatch = 256;                            // flush as soon as this many plans are pending
+	std::chrono::milliseconds flushInterval{50};           // ...or when the oldest pending plan is this old
+	std::chrono::milliseconds enqueueTimeout{100};         // backpressure wait before writing synchronously
+};
+
+struct WriteBehindStats {
+	std::size_t queueDepth = 0;       // plans pending or being flushed
+	std::uint64_t enqueued = 0;
+	std::uint64_t coalesced = 0;      // enqueues that replaced an older pending plan of the same user
+	std::uint64_t written = 0;
+	std::uint64_t dropped = 0;        // plans that failed even when retried one by one
+	std::uint64_t flushes = 0;
+	std::uint64_t failedBatches = 0;
+	std::uint64_t syncFallbacks = 0;  // queue full: written on the caller's thread instead
+	std::uint64_t bulkWrites = 0;     // savePlans batches written through in one call
+	double lastFlushMs = 0.0;
+	double maxFlushMs = 0.0;
+	double totalFlushMs = 0.0;
+};
+
+// IStorage decorator that moves plan writes off the request path. savePlan puts the
+// plan into a bounded queue (many request threads, one flusher) keyed by userId, so
+// only the latest plan per user is written. The flusher sends everything pending
+// through one IStorage::savePlans call per batch. loadPlan sees queued plans
+// (read-your-writes); user methods pass straight through. savePlans (cohort batches) is
+// written through in one call on the caller's thread, ordered after the plans already queued.
+class WriteBehindStorage : public IStorage {
+	IStorage& backend;
+	WriteBehindOptions options;
+
+	mutable std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable spaceAvailable;
+	std::condition_variable drained;
+	std::unordered_map<int, Plan> pending;
+	std::unordered_map<int, Plan> inFlight;
+	std::chrono::steady_clock::time_point oldestPending;
+	bool flushRequested = false;
+	bool bulkWriting = false;         // a savePlans batch is being written; the flusher waits
+	bool stopping = false;
+	WriteBehindStats counters;
+	std::thread flusher;
+
+public:
+	WriteBehindStorage(IStorage& storage, WriteBehindOptions writeOptions = {});
+	~WriteBehindStorage();
+
+	WriteBehindStorage(const WriteBehindStorage&) = delete;
+	WriteBehindStorage& operator=(const WriteBehindStorage&) = delete;
+
+	void savePlan(int userId, const Plan& plan) override;
+	void savePlans(const std::vector<PlanWrite>& batch) override;
+	std::optional<Plan> loadPlan(int userId) override;
+
+	void saveUser(const std::string& username, const std::string& email, const std::string& password) override;
+	bool validateUser(const std::string& username, const std::string& password) override;
+	std::optional<json> getUser(const std::string& username) override;
+
+	// Blocks until every plan queued before the call has been written (or dropped)
+	void flush();
+
+	DurabilityMode mode() const { return options.mode; }
+	WriteBehindStats stats() const;
+
+private:
+	void run();
+	void write(const std::unordered_map<int, Plan>& batch);
+};
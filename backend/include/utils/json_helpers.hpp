@@ -37,6 +37,9 @@ inline Course jsonToCourse(const json& j) {
 
     if (j.contains("prerequisiteCourseIds")) {
         course.setPrerequisiteCourseIds(j["prerequisiteCourseIds"].get<std::vector<int>>());
+    } else if (j.contains("prereqIds")) {
+        // data/courses.json spelling
+        course.setPrerequisiteCourseIds(j["prereqIds"].get<std::vector<int>>());
     }
 
     return course;
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Asynchronous structured logger. Each thread appends fixed-size records to its own
+// single-producer ring (no locks, no flushing on the request path); a background thread
+// drains all rings, orders records by time and writes compact logfmt lines:
+//   2026-10-16T12:34:56.789Z INFO  t3 request route=/api/courses status=200 bytes=5120
+namespace logging {
+
+enum class Level : std::uint8_t { Debug, Info, Warn, Error };
+
+Level parseLevel(std::string_view name);   // "debug" | "info" | "warn" | "error", defaults to Info
+
+struct LoggerOptions {
+    Level level = Level::Info;
+    std::uint32_t bodySampleRate = 100;    // log 1 in N request bodies, 0 disables
+    std::chrono::milliseconds drainInterval{10};
+    std::FILE* sink = stdout;
+};
+
+struct LoggerStats {
+    std::uint64_t written = 0;
+    std::uint64_t dropped = 0;             // records lost because a thread's ring was full
+    std::uint64_t threads = 0;
+};
+
+// Until start() is called (and after stop()) records are written synchronously to the sink
+void start(const LoggerOptions& options);
+void stop();   // drains every ring and joins the background thread
+
+bool enabled(Level level);
+bool sampleBody();                         // true for 1 in bodySampleRate calls on this thread
+LoggerStats stats();
+
+// One log record, committed when the temporary goes out of scope:
+//   logging::info("request").kv("route", "/api/courses").kv("status", 200);
+class Line {
+public:
+    static constexpr std::size_t MaxLength = 1000;
+
+    Line(Level level, std::string_view event);
+    ~Line();
+
+    Line(const Line&) = delete;
+    Line& operator=(const Line&) = delete;
+
+    Line& kv(std::string_view key, std::string_view value);
+    Line& kv(std::string_view key, const char* value) { return kv(key, std::string_view(value)); }
+    Line& kv(std::string_view key, const std::string& value) { return kv(key, std::string_view(value)); }
+    Line& kv(std::string_view key, bool value) { return kv(key, value ? std::string_view("true") : std::string_view("false")); }
+    Line& kv(std::string_view key, double value);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    Line& kv(std::string_view key, T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return kvSigned(key, value);
+        } else {
+            return kvUnsigned(key, value);
+        }
+    }
+
+private:
+    Line& kvSigned(std::string_view key, long long value);
+    Line& kvUnsigned(std::string_view key, unsigned long long value);
+    void append(std::string_view text);
+    void appendKey(std::string_view key);
+
+    Level level;
+    bool active;
+    std::size_t length = 0;
+    char text[MaxLength];
+};
+
+inline Line debug(std::string_view event) { return Line(Level::Debug, event); }
+inline Line info(std::string_view event) { return Line(Level::Info, event); }
+inline Line warn(std::string_view event) { return Line(Level::Warn, event); }
+inline Line error(std::string_view event) { return Line(Level::Error, event); }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// PostgreSQL array literals for binding whole columns as one parameter
+// (e.g. `unnest($1::int[], $2::text[])`), so multi-row writes are one statement,
+// and parsing of the text form returned for array columns.
+
+inline std::string toPgArray(const std::vector<int>& values) {
+    std::string out = "{";
+    out.reserve(values.size() * 4 + 2);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out += ',';
+        out += std::to_string(values[i]);
+    }
+    out += '}';
+    return out;
+}
+
+// Every element is double-quoted; backslashes and quotes are escaped
+inline std::string toPgArray(const std::vector<std::string>& values) {
+    std::string out = "{";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out += ',';
+        out += '"';
+        for (char c : values[i]) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        out += '"';
+    }
+    out += '}';
+    return out;
+}
+
+// "{a,\"b c\"}" -> {"a", "b c"}; elements are split on ',' and surrounding quotes dropped
+inline std::vector<std::string> parsePgTextArray(std::string text) {
+    std::vector<std::string> values;
+    if (text.empty() || text == "{}") {
+        return values;
+    }
+    text = text.substr(1, text.length() - 2); // Remove {}
+    size_t pos = 0;
+    while ((pos = text.find(',')) != std::string::npos) {
+        std::string value = text.substr(0, pos);
+        if (!value.empty()) {
+            if (value.front() == '"') value = value.substr(1, value.length() - 2);
+            values.push_back(value);
+        }
+        text.erase(0, pos + 1);
+    }
+    if (!text.empty()) {
+        if (text.front() == '"') text = text.substr(1, text.length() - 2);
+        values.push_back(text);
+    }
+    return values;
+}
+
+// "{1,2,3}" -> {1, 2, 3}
+inline std::vector<int> parsePgIntArray(std::string text) {
+    std::vector<int> values;
+    if (text.empty() || text == "{}") {
+        return values;
+    }
+    text = text.substr(1, text.length() - 2); // Remove {}
+    size_t pos = 0;
+    while ((pos = text.find(',')) != std::string::npos) {
+        values.push_back(std::stoi(text.substr(0, pos)));
+        text.erase(0, pos + 1);
+    }
+    if (!text.empty()) {
+        values.push_back(std::stoi(text));
+    }
+    return values;
+}
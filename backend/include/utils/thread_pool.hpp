@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel jobs such as batch planning.
+//
+// forEach splits the index range into one contiguous block per participant. A participant
+// whose block runs dry steals the back half of the largest block left, so uneven tasks
+// (large and small domain partitions) still finish together. The calling thread takes part
+// as well. Several jobs may be in progress at once; idle workers join them in arrival order.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    // Runs task(i) for every i in [0, count) and returns once all calls have finished.
+    // If tasks throw, the first exception is rethrown after the remaining tasks have run.
+    void forEach(std::size_t count, const std::function<void(std::size_t)>& task);
+
+private:
+    struct Job;
+
+    void run(std::size_t worker);
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<Job>> jobs;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
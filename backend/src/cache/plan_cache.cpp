@@ -0,0 +1,174 @@
+#include "../../include/cache/plan_cache.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// Rough per-entry bookkeeping (list node, hash node, control block) on top of the body
+constexpr std::size_t kEntryOverhead = 128;
+
+}
+
+PlanCache::PlanCache(std::size_t maxBytes, std::size_t shardCount)
+	: shardCapacity(maxBytes / std::max<std::size_t>(1, shardCount)),
+	  shards(std::max<std::size_t>(1, shardCount)) {
+}
+
+PlanCache::Shard& PlanCache::shardFor(int userId) {
+	return shards[std::hash<int>{}(userId) % shards.size()];
+}
+
+PlanCache::Body PlanCache::get(int userId) {
+	Shard& shard = shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.entries.find(userId);
+	if (it == shard.entries.end()) {
+		++shard.misses;
+		return nullptr;
+	}
+	++shard.hits;
+	shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+	return it->second->body;
+}
+
+PlanCache::Token PlanCache::token(int userId) {
+	Shard& shard = shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return shard.generation;
+}
+
+bool PlanCache::putIfUnchanged(int userId, Token token, std::string body) {
+	Shard& shard = shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if (shard.generation != token || shard.writing.count(userId)) {
+		++shard.staleFills;
+		return false;
+	}
+	store(shard, userId, std::move(body));
+	return true;
+}
+
+void PlanCache::invalidate(int userId) {
+	Shard& shard = shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	++shard.generation;
+	erase(shard, userId);
+}
+
+PlanCache::Write::Write(PlanCache& planCache, int user)
+	: cache(&planCache), userId(user) {
+	Shard& shard = cache->shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	++shard.generation;
+	clearEpoch = shard.clears;
+	Writing& writing = shard.writing[userId];
+	if (writing.active++ > 0) {
+		writing.overlapped = true;
+	}
+	cache->erase(shard, userId);
+}
+
+PlanCache::Write::Write(Write&& other) noexcept
+	: cache(other.cache), userId(other.userId), clearEpoch(other.clearEpoch) {
+	other.cache = nullptr;
+}
+
+PlanCache::Write::~Write() {
+	if (!cache) {
+		return;
+	}
+	Shard& shard = cache->shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	cache->endWrite(shard, userId);
+}
+
+void PlanCache::Write::commit(std::string body) {
+	if (!cache) {
+		return;
+	}
+	Shard& shard = cache->shardFor(userId);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	// Another write for the user overlapping this one may have reached storage last: cache neither
+	// body. A clear() since the Write opened means the body may be rendered against a retired catalog.
+	if (cache->endWrite(shard, userId) && shard.clears == clearEpoch) {
+		cache->store(shard, userId, std::move(body));
+	} else {
+		++shard.staleFills;
+	}
+	cache = nullptr;
+}
+
+bool PlanCache::endWrite(Shard& shard, int userId) {
+	// Readers that loaded the plan while it was being written must not fill afterwards
+	++shard.generation;
+	auto it = shard.writing.find(userId);
+	bool alone = !it->second.overlapped;
+	if (--it->second.active == 0) {
+		shard.writing.erase(it);
+	}
+	return alone;
+}
+
+void PlanCache::erase(Shard& shard, int userId) {
+	auto it = shard.entries.find(userId);
+	if (it == shard.entries.end()) {
+		return;
+	}
+	shard.bytes -= it->second->bytes;
+	shard.lru.erase(it->second);
+	shard.entries.erase(it);
+	++shard.invalidations;
+}
+
+void PlanCache::store(Shard& shard, int userId, std::string body) {
+	auto it = shard.entries.find(userId);
+	if (it != shard.entries.end()) {
+		shard.bytes -= it->second->bytes;
+		shard.lru.erase(it->second);
+		shard.entries.erase(it);
+	}
+	std::size_t bytes = body.size() + kEntryOverhead;
+	if (bytes > shardCapacity) {
+		return; // too large to cache
+	}
+
+	shard.lru.push_front({userId, std::make_shared<const std::string>(std::move(body)), bytes});
+	shard.entries[userId] = shard.lru.begin();
+	shard.bytes += bytes;
+
+	while (shard.bytes > shardCapacity && !shard.lru.empty()) {
+		const Entry& victim = shard.lru.back();
+		shard.bytes -= victim.bytes;
+		shard.entries.erase(victim.userId);
+		shard.lru.pop_back();
+		++shard.evictions;
+	}
+}
+
+void PlanCache::clear() {
+	for (auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		++shard.generation;
+		++shard.clears;
+		shard.invalidations += shard.entries.size();
+		shard.lru.clear();
+		shard.entries.clear();
+		shard.bytes = 0;
+	}
+}
+
+PlanCacheStats PlanCache::stats() const {
+	PlanCacheStats total;
+	total.capacityBytes = shardCapacity * shards.size();
+	for (const auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		total.entries += shard.entries.size();
+		total.bytes += shard.bytes;
+		total.hits += shard.hits;
+		total.misses += shard.misses;
+		total.evictions += shard.evictions;
+		total.invalidations += shard.invalidations;
+		total.staleFills += shard.staleFills;
+	}
+	return total;
+}
@@ -0,0 +1,224 @@
+#include "../../include/cache/recommendation_cache.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Rough per-entry bookkeeping (list node, hash node, control block, Plan) on top of the strings
+constexpr std::size_t kEntryOverhead = 256;
+
+std::size_t entryBytes(const std::string& key, const RecommendationCache::Value& value) {
+	std::size_t bytes = kEntryOverhead + key.size() + value.body.size();
+	for (const auto& step : value.plan.getSteps()) {
+		bytes += sizeof(PlanStep) + step.note.capacity();
+	}
+	return bytes;
+}
+
+void appendField(std::string& key, std::string_view field) {
+	key += std::to_string(field.size());
+	key += ':';
+	key += field;
+}
+
+}
+
+RecommendationCache::FrequencySketch::FrequencySketch(std::size_t width)
+	: mask(std::bit_ceil(std::max<std::size_t>(width, 64)) - 1),
+	  counters(4 * (mask + 1), 0),
+	  sampleSize(10 * (mask + 1)) {
+}
+
+std::size_t RecommendationCache::FrequencySketch::index(std::uint64_t hash, int row) const {
+	static constexpr std::uint64_t seeds[4] = {
+		0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull};
+	std::uint64_t h = (hash + seeds[row]) * seeds[(row + 1) % 4];
+	h ^= h >> 32;
+	return static_cast<std::size_t>(row) * (mask + 1) + (h & mask);
+}
+
+void RecommendationCache::FrequencySketch::record(std::uint64_t hash) {
+	for (int row = 0; row < 4; ++row) {
+		std::uint8_t& counter = counters[index(hash, row)];
+		if (counter < 255) {
+			++counter;
+		}
+	}
+	// Aging: halve everything once per sample, so the sketch tracks recent popularity
+	if (++recorded >= sampleSize) {
+		for (auto& counter : counters) {
+			counter >>= 1;
+		}
+		recorded /= 2;
+	}
+}
+
+std::uint8_t RecommendationCache::FrequencySketch::estimate(std::uint64_t hash) const {
+	std::uint8_t least = 255;
+	for (int row = 0; row < 4; ++row) {
+		least = std::min(least, counters[index(hash, row)]);
+	}
+	return least;
+}
+
+RecommendationCache::RecommendationCache(std::size_t maxBytes, std::size_t shardCount)
+	: shardCapacity(maxBytes / std::max<std::size_t>(1, shardCount)) {
+	// About one counter per 512 bytes of capacity: a few per entry the shard can hold
+	std::size_t sketchWidth = shardCapacity / 512;
+	for (std::size_t i = 0; i < std::max<std::size_t>(1, shardCount); ++i) {
+		shards.push_back(std::make_unique<Shard>(sketchWidth));
+	}
+}
+
+std::string RecommendationCache::key(std::uint64_t catalogVersion, const UserProfile& profile) {
+	// Scoring counts matching interests, so their order is irrelevant but duplicates count
+	std::vector<std::string_view> interests(profile.getInterests().begin(), profile.getInterests().end());
+	std::sort(interests.begin(), interests.end());
+
+	std::string key;
+	key.reserve(64);
+	key += std::to_string(catalogVersion);
+	key += '|';
+	appendField(key, profile.getTargetDomain());
+	appendField(key, profile.getCurrentLevel());
+	key += std::to_string(static_cast<long long>(profile.getHoursPerWeek()) * profile.getDeadlineWeeks());
+	key += '|';
+	for (std::string_view interest : interests) {
+		appendField(key, interest);
+	}
+	return key;
+}
+
+RecommendationCache::Entry RecommendationCache::getOrCompute(const std::string& key, const Compute& compute, bool* hit) {
+	const std::uint64_t hash = std::hash<std::string>{}(key);
+	Shard& shard = *shards[(hash >> 16) % shards.size()];
+
+	std::promise<Entry> result;
+	std::shared_future<Entry> pending;
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.sketch.record(hash);
+		auto it = shard.entries.find(key);
+		if (it != shard.entries.end()) {
+			++shard.hits;
+			shard.savedNs += static_cast<std::uint64_t>(it->second->value->cost.count());
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+			if (hit) {
+				*hit = true;
+			}
+			return it->second->value;
+		}
+		auto flight = shard.inFlight.find(key);
+		if (flight != shard.inFlight.end()) {
+			++shard.coalesced;
+			pending = flight->second;
+		} else {
+			++shard.misses;
+			shard.inFlight.emplace(key, result.get_future().share());
+		}
+	}
+
+	// Identical request already computing: wait for its plan
+	if (pending.valid()) {
+		Entry value = pending.get();
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.savedNs += static_cast<std::uint64_t>(value->cost.count());
+		if (hit) {
+			*hit = true;
+		}
+		return value;
+	}
+
+	if (hit) {
+		*hit = false;
+	}
+	Entry value;
+	try {
+		auto start = std::chrono::steady_clock::now();
+		Value computed = compute();
+		computed.cost = std::chrono::steady_clock::now() - start;
+		value = std::make_shared<const Value>(std::move(computed));
+	} catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.inFlight.erase(key);
+		}
+		result.set_exception(std::current_exception());
+		throw;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.inFlight.erase(key);
+		shard.computeNs += static_cast<std::uint64_t>(value->cost.count());
+		store(shard, key, hash, value);
+	}
+	result.set_value(value);
+	return value;
+}
+
+void RecommendationCache::store(Shard& shard, const std::string& key, std::uint64_t hash, const Entry& value) {
+	const std::size_t bytes = entryBytes(key, *value);
+	if (bytes > shardCapacity) {
+		++shard.rejected;
+		return;
+	}
+
+	auto existing = shard.entries.find(key);
+	if (existing != shard.entries.end()) {
+		shard.bytes -= existing->second->bytes;
+		shard.lru.erase(existing->second);
+		shard.entries.erase(existing);
+	}
+
+	// TinyLFU admission: every entry that would have to go must be colder than the newcomer
+	std::size_t freed = 0;
+	std::size_t victims = 0;
+	const std::uint8_t frequency = shard.sketch.estimate(hash);
+	for (auto it = shard.lru.rbegin(); it != shard.lru.rend() && shard.bytes - freed + bytes > shardCapacity; ++it) {
+		if (shard.sketch.estimate(it->hash) >= frequency) {
+			++shard.rejected;
+			return;
+		}
+		freed += it->bytes;
+		++victims;
+	}
+	for (; victims > 0; --victims) {
+		const Slot& victim = shard.lru.back();
+		shard.bytes -= victim.bytes;
+		shard.entries.erase(victim.key);
+		shard.lru.pop_back();
+		++shard.evictions;
+	}
+
+	shard.lru.push_front({key, hash, value, bytes});
+	shard.entries[key] = shard.lru.begin();
+	shard.bytes += bytes;
+}
+
+void RecommendationCache::clear() {
+	for (auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		shard->lru.clear();
+		shard->entries.clear();
+		shard->bytes = 0;
+	}
+}
+
+RecommendationCacheStats RecommendationCache::stats() const {
+	RecommendationCacheStats total;
+	total.capacityBytes = shardCapacity * shards.size();
+	for (const auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		total.entries += shard->entries.size();
+		total.bytes += shard->bytes;
+		total.hits += shard->hits;
+		total.misses += shard->misses;
+		total.coalesced += shard->coalesced;
+		total.rejected += shard->rejected;
+		total.evictions += shard->evictions;
+		total.computeNs += shard->computeNs;
+		total.savedNs += shard->savedNs;
+	}
+	return total;
+}
@@ -0,0 +1,191 @@
+#include "../../include/catalog/catalog_holder.hpp"
+#include "../../include/catalog/prereq_graph.hpp"
+#include "../../include/services/affinity.hpp"
+#include "../../include/utils/json_helpers.hpp"
+#include "../../include/utils/logger.hpp"
+#include <algorithm>
+#include <filesystem>
+
+LoadedCatalog::LoadedCatalog(std::uint64_t catalogVersion, CatalogIndex catalogIndex)
+	: version(catalogVersion),
+	  index(std::move(catalogIndex)),
+	  coursesBody([this] {
+		  std::string body = coursesToJson(index.courses()).dump();
+		  logging::info("catalog.prerendered").kv("version", version).kv("body", "courses").kv("bytes", body.size());
+		  return body;
+	  }),
+	  tagsBody([this] { return json(index.tags()).dump(); }),
+	  planFragments(index) {
+	// Build the affinity tables and prerequisite graph here, on the loading thread, rather than in the first request
+	index.affinity();
+	const PrereqGraph::Report& report = index.prerequisiteGraph().report();
+	if (report.cycles.empty() && report.missing.empty()) {
+		return;
+	}
+	std::string cycles;   // the first few, so a broken import does not flood the log
+	for (std::size_t c = 0; c < std::min<std::size_t>(report.cycles.size(), 10); ++c) {
+		const auto& cycle = report.cycles[c];
+		cycles += cycles.empty() ? "[" : " [";
+		for (std::size_t i = 0; i < cycle.size(); ++i) {
+			cycles += (i ? "," : "") + std::to_string(cycle[i]);
+		}
+		cycles += "]";
+	}
+	logging::warn("catalog.prereq_problems").kv("version", version).kv("cycles", report.cycles.size())
+		.kv("missing", report.missing.size()).kv("blocked", report.blocked).kv("cycle_ids", cycles);
+}
+
+CatalogHolder::CatalogHolder(Loader catalogLoader)
+	: loader(std::move(catalogLoader)) {
+	auto start = std::chrono::steady_clock::now();
+	auto first = std::make_shared<const LoadedCatalog>(1, loader());
+	published.store(first, std::memory_order_release);
+	logging::info("catalog.indexed").kv("version", first->version).kv("courses", first->index.size())
+		.kv("tags", first->index.tags().size()).kv("mapped", first->index.snapshot()->mapped())
+		.kv("ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	worker = std::thread(&CatalogHolder::run, this);
+}
+
+CatalogHolder::~CatalogHolder() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	worker.join();
+}
+
+void CatalogHolder::requestReload(const std::string& reason) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (reloadQueued) {
+			return;
+		}
+		reloadQueued = true;
+		pending.push_back(Update{reason.empty() ? "requested" : reason, nullptr});
+	}
+	wake.notify_all();
+}
+
+void CatalogHolder::requestPatch(const std::string& reason, Patch patch) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.push_back(Update{reason, std::move(patch)});
+	}
+	wake.notify_all();
+}
+
+void CatalogHolder::watchFile(std::string path, std::chrono::milliseconds interval) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		watchPath = std::move(path);
+		watchInterval = interval;
+		watchStamp.clear();
+	}
+	// Record the current stamp so the file as loaded does not trigger a reload
+	fileChanged();
+	wake.notify_all();
+}
+
+void CatalogHolder::onReload(Listener callback) {
+	std::lock_guard<std::mutex> lock(mutex);
+	listener = std::move(callback);
+}
+
+bool CatalogHolder::fileChanged() {
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		path = watchPath;
+	}
+	std::error_code error;
+	auto size = std::filesystem::file_size(path, error);
+	auto modified = std::filesystem::last_write_time(path, error);
+	if (error) {
+		// Missing while it is being replaced; look again next time
+		return false;
+	}
+	std::string stamp = std::to_string(size) + "@" + std::to_string(modified.time_since_epoch().count());
+	std::lock_guard<std::mutex> lock(mutex);
+	bool changed = !watchStamp.empty() && stamp != watchStamp;
+	watchStamp = stamp;
+	return changed;
+}
+
+void CatalogHolder::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping) {
+		if (watchPath.empty()) {
+			wake.wait(lock, [this] { return stopping || !pending.empty() || !watchPath.empty(); });
+		} else {
+			wake.wait_for(lock, watchInterval, [this] { return stopping || !pending.empty(); });
+		}
+		if (stopping) {
+			break;
+		}
+		bool watching = !watchPath.empty();
+		lock.unlock();
+		if (watching && fileChanged()) {
+			requestReload("file changed");
+		}
+		lock.lock();
+		if (pending.empty()) {
+			continue;
+		}
+		Update update = std::move(pending.front());
+		pending.pop_front();
+		if (!update.patch) {
+			reloadQueued = false;
+		}
+		lock.unlock();
+		apply(update);
+		lock.lock();
+	}
+}
+
+void CatalogHolder::apply(const Update& update) {
+	auto start = std::chrono::steady_clock::now();
+	auto base = current();
+	std::uint64_t version = base->version + 1;
+	try {
+		std::optional<CatalogIndex> index;
+		if (update.patch) {
+			index = update.patch(base->index);
+			if (!index) {
+				return;
+			}
+		} else {
+			index = loader();
+		}
+		auto next = std::make_shared<const LoadedCatalog>(version, std::move(*index));
+		published.store(next, std::memory_order_release);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		(update.patch ? patches : reloads).fetch_add(1);
+		lastReloadMs.store(ms);
+		logging::info("catalog.reloaded").kv("version", version).kv("reason", update.reason)
+			.kv("mode", update.patch ? "patch" : "full").kv("courses", next->index.size()).kv("ms", ms);
+
+		Listener callback;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			callback = listener;
+		}
+		if (callback) {
+			callback(*next);
+		}
+	} catch (const std::exception& e) {
+		failures.fetch_add(1);
+		logging::error("catalog.reload_failed").kv("reason", update.reason).kv("error", e.what())
+			.kv("serving_version", version - 1);
+	}
+}
+
+CatalogHolderStats CatalogHolder::stats() const {
+	CatalogHolderStats s;
+	s.version = current()->version;
+	s.reloads = reloads.load();
+	s.patches = patches.load();
+	s.failures = failures.load();
+	s.lastReloadMs = lastReloadMs.load();
+	return s;
+}
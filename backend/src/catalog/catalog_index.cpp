@@ -0,0 +1,172 @@
+#include "../../include/catalog/catalog_index.hpp"
+#include "../../include/catalog/prereq_graph.hpp"
+#include "../../include/services/affinity.hpp"
+#include <algorithm>
+#include <mutex>
+
+// Structures derived from the image on demand
+struct CatalogIndex::Derived {
+	std::once_flag graphOnce;
+	std::unique_ptr<const PrereqGraph> graph;
+	std::once_flag affinityOnce;
+	std::unique_ptr<const CatalogAffinity> affinity;
+};
+
+CatalogIndex::CatalogIndex(const std::vector<Course>& catalogCourses)
+	: image(CatalogSnapshot::build(catalogCourses)) {
+	bind();
+}
+
+CatalogIndex::CatalogIndex(std::shared_ptr<const CatalogSnapshot> snapshot)
+	: image(std::move(snapshot)) {
+	bind();
+}
+
+CatalogIndex CatalogIndex::apply(const CatalogDelta& delta) const {
+	return CatalogIndex(CatalogSnapshot::patch(*image, delta));
+}
+
+void CatalogIndex::bind() {
+	derived = std::make_shared<Derived>();
+	std::span<const char> arenaBytes = image->section<char>(Section::Arena);
+	arena = std::string_view(arenaBytes.data(), arenaBytes.size());
+	tagNameRefs = image->section<StrRef>(Section::TagNames);
+	domainNameRefs = image->section<StrRef>(Section::DomainNames);
+	levelNameRefs = image->section<StrRef>(Section::LevelNames);
+
+	idColumn = image->section<std::int32_t>(Section::Ids);
+	titleColumn = image->section<StrRef>(Section::Titles);
+	domainColumn = image->section<DomainCode>(Section::DomainCodes);
+	levelColumn = image->section<LevelCode>(Section::LevelCodes);
+	durationColumn = image->section<std::int32_t>(Section::Durations);
+	scoreColumn = image->section<double>(Section::Scores);
+
+	tagListOffsets = image->section<std::uint32_t>(Section::TagOffsets);
+	tagList = image->section<std::uint32_t>(Section::TagList);
+	prereqOffsets = image->section<std::uint32_t>(Section::PrereqOffsets);
+	prereqList = image->section<std::int32_t>(Section::PrereqList);
+	idOrder = image->section<std::uint32_t>(Section::IdOrder);
+	domainPostingOffsets = image->section<std::uint32_t>(Section::DomainPostingOffsets);
+	domainPostings = image->section<std::uint32_t>(Section::DomainPostings);
+	levelPostingOffsets = image->section<std::uint32_t>(Section::LevelPostingOffsets);
+	levelPostings = image->section<std::uint32_t>(Section::LevelPostings);
+	tagPostingOffsets = image->section<std::uint32_t>(Section::TagPostingOffsets);
+	tagPostings = image->section<std::uint32_t>(Section::TagPostings);
+
+	// Dictionaries are small next to the columns, so their hash maps are cheap to rebuild
+	sortedTags.reserve(tagNameRefs.size());
+	tagIds.reserve(tagNameRefs.size());
+	for (std::uint32_t id = 0; id < tagNameRefs.size(); ++id) {
+		sortedTags.emplace_back(tagName(id));
+		tagIds.emplace(sortedTags.back(), id);
+	}
+	for (std::size_t code = 0; code < domainNameRefs.size(); ++code) {
+		domainCodeByName.emplace(std::string(domainName(static_cast<DomainCode>(code))), static_cast<DomainCode>(code));
+	}
+	for (std::size_t code = 0; code < levelNameRefs.size(); ++code) {
+		levelCodeByName.emplace(std::string(levelName(static_cast<LevelCode>(code))), static_cast<LevelCode>(code));
+	}
+}
+
+const PrereqGraph& CatalogIndex::prerequisiteGraph() const {
+	static const PrereqGraph empty;
+	if (!derived) {
+		return empty;
+	}
+	std::call_once(derived->graphOnce, [this] { derived->graph = std::make_unique<const PrereqGraph>(*this); });
+	return *derived->graph;
+}
+
+const CatalogAffinity& CatalogIndex::affinity() const {
+	static const CatalogAffinity empty;
+	if (!derived) {
+		return empty;
+	}
+	std::call_once(derived->affinityOnce, [this] { derived->affinity = std::make_unique<const CatalogAffinity>(*this); });
+	return *derived->affinity;
+}
+
+Course CatalogIndex::course(Slot slot) const {
+	CourseView view(*this, slot);
+	Course course;
+	course.setId(view.getId());
+	course.setTitle(std::string(view.getTitle()));
+	course.setDomain(std::string(view.getDomain()));
+	course.setLevel(std::string(view.getLevel()));
+	course.setDurationHours(view.getDurationHours());
+	course.setScore(view.getScore());
+	std::vector<std::string> courseTags;
+	courseTags.reserve(view.getTagIds().size());
+	for (std::uint32_t id : view.getTagIds()) {
+		courseTags.emplace_back(tagName(id));
+	}
+	course.setTags(courseTags);
+	auto prereqs = view.getPrerequisiteCourseIds();
+	course.setPrerequisiteCourseIds(std::vector<int>(prereqs.begin(), prereqs.end()));
+	return course;
+}
+
+std::vector<Course> CatalogIndex::courses() const {
+	std::vector<Course> result;
+	result.reserve(size());
+	for (Slot slot = 0; slot < size(); ++slot) {
+		result.push_back(course(slot));
+	}
+	return result;
+}
+
+std::optional<CatalogIndex::Slot> CatalogIndex::slotOf(int courseId) const {
+	auto it = std::lower_bound(idOrder.begin(), idOrder.end(), courseId,
+		[this](Slot slot, int id) { return idColumn[slot] < id; });
+	if (it == idOrder.end() || idColumn[*it] != courseId) {
+		return std::nullopt;
+	}
+	return *it;
+}
+
+std::optional<CourseView> CatalogIndex::find(int courseId) const {
+	auto slot = slotOf(courseId);
+	if (!slot) {
+		return std::nullopt;
+	}
+	return CourseView(*this, *slot);
+}
+
+std::optional<std::uint32_t> CatalogIndex::tagId(const std::string& tag) const {
+	auto it = tagIds.find(tag);
+	if (it == tagIds.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+std::optional<CatalogIndex::DomainCode> CatalogIndex::domainCode(const std::string& domain) const {
+	auto it = domainCodeByName.find(domain);
+	if (it == domainCodeByName.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+std::optional<CatalogIndex::LevelCode> CatalogIndex::levelCode(const std::string& level) const {
+	auto it = levelCodeByName.find(level);
+	if (it == levelCodeByName.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+CatalogIndex::SlotSpan CatalogIndex::byDomain(const std::string& domain) const {
+	auto code = domainCode(domain);
+	return code ? row(domainPostingOffsets, domainPostings, *code) : SlotSpan();
+}
+
+CatalogIndex::SlotSpan CatalogIndex::byLevel(const std::string& level) const {
+	auto code = levelCode(level);
+	return code ? row(levelPostingOffsets, levelPostings, *code) : SlotSpan();
+}
+
+CatalogIndex::SlotSpan CatalogIndex::byTag(const std::string& tag) const {
+	auto id = tagId(tag);
+	return id ? row(tagPostingOffsets, tagPostings, *id) : SlotSpan();
+}
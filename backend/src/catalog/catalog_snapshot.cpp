@@ -0,0 +1,804 @@
+#include "../../include/catalog/catalog_snapshot.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char Magic[8] = {'R', 'M', 'C', 'A', 'T', 'L', 'O', 'G'};
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+constexpr std::size_t SectionCount = static_cast<std::size_t>(CatalogSnapshot::Section::Count);
+
+struct Header {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint32_t sectionCount;
+	std::uint32_t reserved;
+	std::uint64_t fileBytes;
+	struct {
+		std::uint64_t offset;
+		std::uint64_t bytes;
+	} sections[SectionCount];
+};
+
+std::size_t aligned(std::size_t bytes) {
+	return (bytes + 7) & ~static_cast<std::size_t>(7);
+}
+
+// Section contents collected before the image is laid out
+struct Pending {
+	const void* data = nullptr;
+	std::size_t bytes = 0;
+
+	template <typename T>
+	void set(const std::vector<T>& values) {
+		data = values.data();
+		bytes = values.size() * sizeof(T);
+	}
+};
+
+// Counting sort of slots into one posting list per key, each in ascending slot order
+template <typename Key>
+void buildPostings(const std::vector<Key>& keys, std::size_t keyCount,
+                   std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& postings) {
+	offsets.assign(keyCount + 1, 0);
+	for (Key key : keys) {
+		++offsets[key + 1];
+	}
+	for (std::size_t k = 0; k < keyCount; ++k) {
+		offsets[k + 1] += offsets[k];
+	}
+	postings.resize(keys.size());
+	std::vector<std::uint32_t> next(offsets.begin(), offsets.end() - 1);
+	for (std::uint32_t slot = 0; slot < keys.size(); ++slot) {
+		postings[next[keys[slot]]++] = slot;
+	}
+}
+
+// Header plus the sections in order, as 8-byte words; returns the image and its size in bytes
+std::pair<std::unique_ptr<std::uint64_t[]>, std::size_t> assemble(const std::array<Pending, SectionCount>& pending) {
+	Header header{};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = CatalogSnapshot::Version;
+	header.byteOrder = ByteOrderMark;
+	header.sectionCount = static_cast<std::uint32_t>(SectionCount);
+	std::size_t offset = aligned(sizeof(Header));
+	for (std::size_t i = 0; i < SectionCount; ++i) {
+		header.sections[i].offset = offset;
+		header.sections[i].bytes = pending[i].bytes;
+		offset += aligned(pending[i].bytes);
+	}
+	header.fileBytes = offset;
+
+	// Left uninitialized: every byte is written below, so large images are touched only once
+	std::unique_ptr<std::uint64_t[]> words(new std::uint64_t[offset / 8]);
+	char* image = reinterpret_cast<char*>(words.get());
+	std::memset(image, 0, aligned(sizeof(Header)));
+	std::memcpy(image, &header, sizeof(Header));
+	for (std::size_t i = 0; i < SectionCount; ++i) {
+		char* section = image + header.sections[i].offset;
+		if (pending[i].bytes) {
+			std::memcpy(section, pending[i].data, pending[i].bytes);
+		}
+		std::memset(section + pending[i].bytes, 0, aligned(pending[i].bytes) - pending[i].bytes);
+	}
+	return {std::move(words), offset};
+}
+
+constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+// Posting lists after a patch. Row k is the old row whose key maps to k, without the slots
+// that were dropped or replaced (keptSlot[s] == None) and with survivors renumbered, merged
+// with the `added` (key, slot) pairs. Both inputs are in ascending slot order, so each row
+// is one linear merge.
+void patchPostings(std::span<const std::uint32_t> oldOffsets, std::span<const std::uint32_t> oldPostings,
+                   const std::vector<std::uint32_t>& keyMap, std::size_t keyCount,
+                   const std::vector<std::uint32_t>& keptSlot,
+                   const std::vector<std::pair<std::uint32_t, std::uint32_t>>& added,
+                   std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& postings) {
+	std::vector<std::uint32_t> oldKeyOf(keyCount, None);
+	for (std::uint32_t key = 0; key < keyMap.size(); ++key) {
+		if (keyMap[key] != None) {
+			oldKeyOf[keyMap[key]] = key;
+		}
+	}
+	std::vector<std::uint32_t> addedOffsets(keyCount + 1, 0);
+	for (const auto& entry : added) {
+		++addedOffsets[entry.first + 1];
+	}
+	for (std::size_t k = 0; k < keyCount; ++k) {
+		addedOffsets[k + 1] += addedOffsets[k];
+	}
+	std::vector<std::uint32_t> addedSlots(added.size());
+	std::vector<std::uint32_t> next(addedOffsets.begin(), addedOffsets.end() - 1);
+	for (const auto& entry : added) {
+		addedSlots[next[entry.first]++] = entry.second;
+	}
+
+	offsets.assign(1, 0);
+	offsets.reserve(keyCount + 1);
+	postings.clear();
+	postings.reserve(oldPostings.size() + added.size());
+	for (std::size_t k = 0; k < keyCount; ++k) {
+		std::uint32_t i = 0, end = 0;
+		if (oldKeyOf[k] != None) {
+			i = oldOffsets[oldKeyOf[k]];
+			end = oldOffsets[oldKeyOf[k] + 1];
+		}
+		std::uint32_t j = addedOffsets[k];
+		while (i < end || j < addedOffsets[k + 1]) {
+			std::uint32_t kept = i < end ? keptSlot[oldPostings[i]] : None;
+			if (i < end && kept == None) {
+				++i;
+			} else if (j == addedOffsets[k + 1] || (i < end && kept < addedSlots[j])) {
+				postings.push_back(kept);
+				++i;
+			} else {
+				postings.push_back(addedSlots[j++]);
+			}
+		}
+		offsets.push_back(static_cast<std::uint32_t>(postings.size()));
+	}
+}
+
+// Each distinct value of a short list, calling f once per value in order of first occurrence
+template <typename T, typename F>
+void forEachDistinct(std::span<const T> values, F&& f) {
+	for (std::size_t i = 0; i < values.size(); ++i) {
+		if (std::find(values.begin(), values.begin() + i, values[i]) == values.begin() + i) {
+			f(values[i]);
+		}
+	}
+}
+
+}
+
+struct CatalogSnapshot::Mapping {
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE view = nullptr;
+#else
+	int fd = -1;
+#endif
+	void* base = nullptr;
+	std::size_t size = 0;
+
+	explicit Mapping(const std::string& path) {
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER length{};
+		if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &length)) {
+			release();
+			throw std::runtime_error("Cannot open catalog snapshot " + path);
+		}
+		size = static_cast<std::size_t>(length.QuadPart);
+		view = size ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		base = view ? MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+		fd = ::open(path.c_str(), O_RDONLY);
+		struct stat info{};
+		if (fd < 0 || ::fstat(fd, &info) != 0) {
+			release();
+			throw std::runtime_error("Cannot open catalog snapshot " + path);
+		}
+		size = static_cast<std::size_t>(info.st_size);
+		if (size) {
+			base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (base == MAP_FAILED) {
+				base = nullptr;
+			}
+		}
+#endif
+		if (!base) {
+			release();
+			throw std::runtime_error("Cannot map catalog snapshot " + path);
+		}
+	}
+
+	~Mapping() { release(); }
+
+	void release() {
+#ifdef _WIN32
+		if (base) UnmapViewOfFile(base);
+		if (view) CloseHandle(view);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		view = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (base) ::munmap(base, size);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		base = nullptr;
+	}
+};
+
+CatalogSnapshot::~CatalogSnapshot() {
+	delete mapping;
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::build(const std::vector<Course>& courses) {
+	if (courses.size() >= std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("Catalog too large for a snapshot");
+	}
+	const std::size_t n = courses.size();
+	std::string arena;
+	auto intern = [&arena](std::string_view value) {
+		StrRef ref{static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(value.size())};
+		arena.append(value);
+		return ref;
+	};
+
+	// Tag dictionary: distinct tags in lexicographic order, position = tag id
+	std::unordered_map<std::string_view, std::uint32_t> tagIds;
+	for (const auto& course : courses) {
+		for (const auto& tag : course.getTags()) {
+			tagIds.emplace(tag, 0);
+		}
+	}
+	std::vector<std::string_view> sortedTags;
+	sortedTags.reserve(tagIds.size());
+	for (const auto& [tag, id] : tagIds) {
+		sortedTags.push_back(tag);
+	}
+	std::sort(sortedTags.begin(), sortedTags.end());
+	std::vector<StrRef> tagNames;
+	tagNames.reserve(sortedTags.size());
+	for (std::uint32_t id = 0; id < sortedTags.size(); ++id) {
+		tagIds[sortedTags[id]] = id;
+		tagNames.push_back(intern(sortedTags[id]));
+	}
+
+	// Domain / level dictionaries, codes in order of first appearance
+	std::unordered_map<std::string_view, std::uint16_t> domainCodes;
+	std::unordered_map<std::string_view, std::uint8_t> levelCodes;
+	std::vector<StrRef> domainNames;
+	std::vector<StrRef> levelNames;
+
+	std::vector<std::int32_t> ids(n);
+	std::vector<StrRef> titles(n);
+	std::vector<std::uint16_t> domains(n);
+	std::vector<std::uint8_t> levels(n);
+	std::vector<std::int32_t> durations(n);
+	std::vector<double> scores(n);
+	std::vector<std::uint32_t> tagOffsets(1, 0);
+	std::vector<std::uint32_t> tagList;
+	std::vector<std::uint32_t> prereqOffsets(1, 0);
+	std::vector<std::int32_t> prereqList;
+	tagOffsets.reserve(n + 1);
+	prereqOffsets.reserve(n + 1);
+
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		const Course& course = courses[slot];
+
+		auto domainIt = domainCodes.find(course.getDomain());
+		if (domainIt == domainCodes.end()) {
+			if (domainNames.size() > std::numeric_limits<std::uint16_t>::max()) {
+				throw std::runtime_error("Too many distinct course domains");
+			}
+			domainIt = domainCodes.emplace(course.getDomain(), static_cast<std::uint16_t>(domainNames.size())).first;
+			domainNames.push_back(intern(course.getDomain()));
+		}
+		auto levelIt = levelCodes.find(course.getLevel());
+		if (levelIt == levelCodes.end()) {
+			if (levelNames.size() > std::numeric_limits<std::uint8_t>::max()) {
+				throw std::runtime_error("Too many distinct course levels");
+			}
+			levelIt = levelCodes.emplace(course.getLevel(), static_cast<std::uint8_t>(levelNames.size())).first;
+			levelNames.push_back(intern(course.getLevel()));
+		}
+
+		ids[slot] = course.getId();
+		titles[slot] = intern(course.getTitle());
+		domains[slot] = domainIt->second;
+		levels[slot] = levelIt->second;
+		durations[slot] = course.getDurationHours();
+		scores[slot] = course.getScore();
+
+		for (const auto& tag : course.getTags()) {
+			tagList.push_back(tagIds.at(tag));
+		}
+		tagOffsets.push_back(static_cast<std::uint32_t>(tagList.size()));
+
+		const auto& prereqs = course.getPrerequisiteCourseIds();
+		prereqList.insert(prereqList.end(), prereqs.begin(), prereqs.end());
+		prereqOffsets.push_back(static_cast<std::uint32_t>(prereqList.size()));
+	}
+	if (arena.size() > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("Catalog strings too large for a snapshot");
+	}
+
+	// Slots by course id; the stable sort keeps the first course first on duplicate ids
+	std::vector<std::uint32_t> idOrder(n);
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		idOrder[slot] = slot;
+	}
+	std::stable_sort(idOrder.begin(), idOrder.end(), [&ids](std::uint32_t a, std::uint32_t b) { return ids[a] < ids[b]; });
+
+	std::vector<std::uint32_t> domainPostingOffsets, domainPostings, levelPostingOffsets, levelPostings;
+	buildPostings(domains, domainNames.size(), domainPostingOffsets, domainPostings);
+	buildPostings(levels, levelNames.size(), levelPostingOffsets, levelPostings);
+
+	// Tag postings; a course listing the same tag twice still gets one posting
+	std::vector<std::uint32_t> tagPostingOffsets(sortedTags.size() + 1, 0);
+	std::vector<std::uint32_t> lastSlot(sortedTags.size(), std::numeric_limits<std::uint32_t>::max());
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		for (std::uint32_t i = tagOffsets[slot]; i < tagOffsets[slot + 1]; ++i) {
+			if (lastSlot[tagList[i]] != slot) {
+				lastSlot[tagList[i]] = slot;
+				++tagPostingOffsets[tagList[i] + 1];
+			}
+		}
+	}
+	for (std::size_t t = 0; t < sortedTags.size(); ++t) {
+		tagPostingOffsets[t + 1] += tagPostingOffsets[t];
+	}
+	std::vector<std::uint32_t> tagPostings(tagPostingOffsets.back());
+	std::vector<std::uint32_t> next(tagPostingOffsets.begin(), tagPostingOffsets.end() - 1);
+	std::fill(lastSlot.begin(), lastSlot.end(), std::numeric_limits<std::uint32_t>::max());
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		for (std::uint32_t i = tagOffsets[slot]; i < tagOffsets[slot + 1]; ++i) {
+			if (lastSlot[tagList[i]] != slot) {
+				lastSlot[tagList[i]] = slot;
+				tagPostings[next[tagList[i]]++] = slot;
+			}
+		}
+	}
+
+	std::array<Pending, SectionCount> pending;
+	pending[static_cast<std::size_t>(Section::Arena)] = Pending{arena.data(), arena.size()};
+	pending[static_cast<std::size_t>(Section::Ids)].set(ids);
+	pending[static_cast<std::size_t>(Section::Titles)].set(titles);
+	pending[static_cast<std::size_t>(Section::DomainCodes)].set(domains);
+	pending[static_cast<std::size_t>(Section::LevelCodes)].set(levels);
+	pending[static_cast<std::size_t>(Section::Durations)].set(durations);
+	pending[static_cast<std::size_t>(Section::Scores)].set(scores);
+	pending[static_cast<std::size_t>(Section::TagOffsets)].set(tagOffsets);
+	pending[static_cast<std::size_t>(Section::TagList)].set(tagList);
+	pending[static_cast<std::size_t>(Section::PrereqOffsets)].set(prereqOffsets);
+	pending[static_cast<std::size_t>(Section::PrereqList)].set(prereqList);
+	pending[static_cast<std::size_t>(Section::TagNames)].set(tagNames);
+	pending[static_cast<std::size_t>(Section::DomainNames)].set(domainNames);
+	pending[static_cast<std::size_t>(Section::LevelNames)].set(levelNames);
+	pending[static_cast<std::size_t>(Section::IdOrder)].set(idOrder);
+	pending[static_cast<std::size_t>(Section::DomainPostingOffsets)].set(domainPostingOffsets);
+	pending[static_cast<std::size_t>(Section::DomainPostings)].set(domainPostings);
+	pending[static_cast<std::size_t>(Section::LevelPostingOffsets)].set(levelPostingOffsets);
+	pending[static_cast<std::size_t>(Section::LevelPostings)].set(levelPostings);
+	pending[static_cast<std::size_t>(Section::TagPostingOffsets)].set(tagPostingOffsets);
+	pending[static_cast<std::size_t>(Section::TagPostings)].set(tagPostings);
+
+	std::shared_ptr<CatalogSnapshot> snapshot(new CatalogSnapshot());
+	auto [image, bytes] = assemble(pending);
+	snapshot->owned = std::move(image);
+	snapshot->data = reinterpret_cast<const char*>(snapshot->owned.get());
+	snapshot->size = bytes;
+	return snapshot;
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::patch(const CatalogSnapshot& base, const CatalogDelta& delta) {
+	auto baseArenaBytes = base.section<char>(Section::Arena);
+	std::string_view baseArena(baseArenaBytes.data(), baseArenaBytes.size());
+	auto baseIds = base.section<std::int32_t>(Section::Ids);
+	auto baseTitles = base.section<StrRef>(Section::Titles);
+	auto baseDomains = base.section<std::uint16_t>(Section::DomainCodes);
+	auto baseLevels = base.section<std::uint8_t>(Section::LevelCodes);
+	auto baseDurations = base.section<std::int32_t>(Section::Durations);
+	auto baseScores = base.section<double>(Section::Scores);
+	auto baseTagOffsets = base.section<std::uint32_t>(Section::TagOffsets);
+	auto baseTagList = base.section<std::uint32_t>(Section::TagList);
+	auto basePrereqOffsets = base.section<std::uint32_t>(Section::PrereqOffsets);
+	auto basePrereqList = base.section<std::int32_t>(Section::PrereqList);
+	auto baseTagNames = base.section<StrRef>(Section::TagNames);
+	auto baseDomainNames = base.section<StrRef>(Section::DomainNames);
+	auto baseLevelNames = base.section<StrRef>(Section::LevelNames);
+	auto baseIdOrder = base.section<std::uint32_t>(Section::IdOrder);
+	auto baseTagPostingOffsets = base.section<std::uint32_t>(Section::TagPostingOffsets);
+	const std::size_t n = baseIds.size();
+	auto baseStr = [&baseArena](StrRef ref) { return baseArena.substr(ref.offset, ref.length); };
+
+	// Resolve the delta to slots: the last upsert of an id wins over earlier ones and over removals
+	std::unordered_map<int, const Course*> upsertById;
+	for (const auto& course : delta.upserts) {
+		upsertById[course.getId()] = &course;
+	}
+	auto slotOf = [&](int id) {
+		auto it = std::lower_bound(baseIdOrder.begin(), baseIdOrder.end(), id,
+			[&baseIds](std::uint32_t slot, int key) { return baseIds[slot] < key; });
+		return it != baseIdOrder.end() && baseIds[*it] == id ? *it : None;
+	};
+	std::vector<const Course*> replacement(n, nullptr);
+	std::vector<bool> removed(n, false);
+	std::vector<const Course*> added;
+	for (const auto& [id, course] : upsertById) {
+		std::uint32_t slot = slotOf(id);
+		if (slot == None) {
+			added.push_back(course);
+		} else {
+			replacement[slot] = course;
+		}
+	}
+	std::sort(added.begin(), added.end(), [](const Course* a, const Course* b) { return a->getId() < b->getId(); });
+	for (int id : delta.removals) {
+		std::uint32_t slot = upsertById.count(id) ? None : slotOf(id);
+		if (slot != None) {
+			removed[slot] = true;
+		}
+	}
+
+	// Survivors keep their relative order, added courses follow
+	std::vector<std::uint32_t> newSlotOf(n, None);
+	std::vector<std::uint32_t> keptSlot(n, None);   // None for removed and replaced slots
+	std::uint32_t survivors = 0;
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		if (!removed[slot]) {
+			newSlotOf[slot] = survivors++;
+			if (!replacement[slot]) {
+				keptSlot[slot] = newSlotOf[slot];
+			}
+		}
+	}
+	if (survivors + added.size() >= std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("Catalog too large for a snapshot");
+	}
+	const std::size_t m = survivors + added.size();
+	std::vector<std::uint32_t> oldSlotOf(m, None);
+	std::vector<const Course*> changed(m, nullptr);   // new contents of replaced and added slots
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		if (newSlotOf[slot] != None) {
+			oldSlotOf[newSlotOf[slot]] = slot;
+			changed[newSlotOf[slot]] = replacement[slot];
+		}
+	}
+	for (std::size_t i = 0; i < added.size(); ++i) {
+		changed[survivors + i] = added[i];
+	}
+
+	// Tag dictionary: per-tag course counts, less the courses that went away, plus the changed ones
+	auto findBaseTag = [&](std::string_view name) {
+		auto it = std::lower_bound(baseTagNames.begin(), baseTagNames.end(), name,
+			[&baseStr](StrRef ref, std::string_view key) { return baseStr(ref) < key; });
+		return it != baseTagNames.end() && baseStr(*it) == name ? static_cast<std::uint32_t>(it - baseTagNames.begin()) : None;
+	};
+	std::vector<std::uint32_t> usage(baseTagNames.size());
+	for (std::size_t tag = 0; tag < usage.size(); ++tag) {
+		usage[tag] = baseTagPostingOffsets[tag + 1] - baseTagPostingOffsets[tag];
+	}
+	for (std::uint32_t slot = 0; slot < n; ++slot) {
+		if (removed[slot] || replacement[slot]) {
+			forEachDistinct(baseTagList.subspan(baseTagOffsets[slot], baseTagOffsets[slot + 1] - baseTagOffsets[slot]),
+				[&usage](std::uint32_t tag) { --usage[tag]; });
+		}
+	}
+	std::vector<std::string_view> newTags;
+	for (const Course* course : changed) {
+		if (!course) {
+			continue;
+		}
+		std::vector<std::string_view> names(course->getTags().begin(), course->getTags().end());
+		forEachDistinct(std::span<const std::string_view>(names), [&](std::string_view name) {
+			std::uint32_t tag = findBaseTag(name);
+			if (tag == None) {
+				newTags.push_back(name);
+			} else {
+				++usage[tag];
+			}
+		});
+	}
+	std::sort(newTags.begin(), newTags.end());
+	newTags.erase(std::unique(newTags.begin(), newTags.end()), newTags.end());
+
+	// Compact the arena instead of appending to it once it would be more than half garbage
+	std::size_t appended = 0;
+	std::size_t live = 0;
+	for (std::uint32_t slot = 0; slot < m; ++slot) {
+		if (changed[slot]) {
+			appended += changed[slot]->getTitle().size() + changed[slot]->getDomain().size() + changed[slot]->getLevel().size();
+		} else {
+			live += baseTitles[oldSlotOf[slot]].length;
+		}
+	}
+	for (std::string_view tag : newTags) {
+		appended += tag.size();
+	}
+	const bool compact = baseArena.size() > 2 * (live + appended) + 4096;
+	std::string arena;
+	if (compact) {
+		arena.reserve(live + appended + 4096);
+	} else {
+		arena.reserve(baseArena.size() + appended);
+		arena.append(baseArena);
+	}
+	auto intern = [&arena](std::string_view value) {
+		StrRef ref{static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(value.size())};
+		arena.append(value);
+		return ref;
+	};
+	auto carry = [&](StrRef ref) { return compact ? intern(baseStr(ref)) : ref; };
+	auto str = [&arena](StrRef ref) { return std::string_view(arena).substr(ref.offset, ref.length); };
+
+	// Merge the surviving tags with the new ones; ids shift only when the set of names changes
+	std::vector<std::uint32_t> tagMap(baseTagNames.size(), None);
+	std::vector<StrRef> tagNames;
+	tagNames.reserve(baseTagNames.size() + newTags.size());
+	for (std::uint32_t tag = 0, j = 0; tag < baseTagNames.size() || j < newTags.size();) {
+		if (tag < baseTagNames.size() && usage[tag] == 0) {
+			++tag;
+		} else if (j == newTags.size() || (tag < baseTagNames.size() && baseStr(baseTagNames[tag]) < newTags[j])) {
+			tagMap[tag] = static_cast<std::uint32_t>(tagNames.size());
+			tagNames.push_back(carry(baseTagNames[tag++]));
+		} else {
+			tagNames.push_back(intern(newTags[j++]));
+		}
+	}
+	auto findTag = [&](std::string_view name) {
+		auto it = std::lower_bound(tagNames.begin(), tagNames.end(), name,
+			[&str](StrRef ref, std::string_view key) { return str(ref) < key; });
+		return static_cast<std::uint32_t>(it - tagNames.begin());
+	};
+
+	// Domain / level codes are stable; new names get the next codes
+	std::vector<StrRef> domainNames, levelNames;
+	std::unordered_map<std::string_view, std::uint16_t> domainCodes;
+	std::unordered_map<std::string_view, std::uint8_t> levelCodes;
+	for (std::size_t code = 0; code < baseDomainNames.size(); ++code) {
+		domainCodes.emplace(baseStr(baseDomainNames[code]), static_cast<std::uint16_t>(code));
+		domainNames.push_back(carry(baseDomainNames[code]));
+	}
+	for (std::size_t code = 0; code < baseLevelNames.size(); ++code) {
+		levelCodes.emplace(baseStr(baseLevelNames[code]), static_cast<std::uint8_t>(code));
+		levelNames.push_back(carry(baseLevelNames[code]));
+	}
+
+	std::vector<std::int32_t> ids(m);
+	std::vector<StrRef> titles(m);
+	std::vector<std::uint16_t> domains(m);
+	std::vector<std::uint8_t> levels(m);
+	std::vector<std::int32_t> durations(m);
+	std::vector<double> scores(m);
+	std::vector<std::uint32_t> tagOffsets(1, 0);
+	std::vector<std::uint32_t> tagList;
+	std::vector<std::uint32_t> prereqOffsets(1, 0);
+	std::vector<std::int32_t> prereqList;
+	tagOffsets.reserve(m + 1);
+	prereqOffsets.reserve(m + 1);
+	tagList.reserve(baseTagList.size());
+	prereqList.reserve(basePrereqList.size());
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> addedDomains, addedLevels, addedTags;
+
+	for (std::uint32_t slot = 0; slot < m;) {
+		const Course* course = changed[slot];
+		if (!course) {
+			// Copy the whole run of unchanged slots that were contiguous in the base image
+			std::uint32_t first = oldSlotOf[slot];
+			std::uint32_t count = 1;
+			while (slot + count < m && !changed[slot + count] && oldSlotOf[slot + count] == first + count) {
+				++count;
+			}
+			std::copy_n(baseIds.begin() + first, count, ids.begin() + slot);
+			std::copy_n(baseDomains.begin() + first, count, domains.begin() + slot);
+			std::copy_n(baseLevels.begin() + first, count, levels.begin() + slot);
+			std::copy_n(baseDurations.begin() + first, count, durations.begin() + slot);
+			std::copy_n(baseScores.begin() + first, count, scores.begin() + slot);
+			std::transform(baseTitles.begin() + first, baseTitles.begin() + first + count, titles.begin() + slot, carry);
+
+			std::uint32_t tagBegin = baseTagOffsets[first];
+			std::uint32_t tagShift = static_cast<std::uint32_t>(tagList.size()) - tagBegin;
+			std::transform(baseTagList.begin() + tagBegin, baseTagList.begin() + baseTagOffsets[first + count],
+				std::back_inserter(tagList), [&tagMap](std::uint32_t tag) { return tagMap[tag]; });
+			std::uint32_t prereqBegin = basePrereqOffsets[first];
+			std::uint32_t prereqShift = static_cast<std::uint32_t>(prereqList.size()) - prereqBegin;
+			prereqList.insert(prereqList.end(), basePrereqList.begin() + prereqBegin,
+				basePrereqList.begin() + basePrereqOffsets[first + count]);
+			for (std::uint32_t i = 1; i <= count; ++i) {
+				tagOffsets.push_back(baseTagOffsets[first + i] + tagShift);
+				prereqOffsets.push_back(basePrereqOffsets[first + i] + prereqShift);
+			}
+			slot += count;
+			continue;
+		}
+
+		auto domainIt = domainCodes.find(course->getDomain());
+		if (domainIt == domainCodes.end()) {
+			if (domainNames.size() > std::numeric_limits<std::uint16_t>::max()) {
+				throw std::runtime_error("Too many distinct course domains");
+			}
+			domainIt = domainCodes.emplace(course->getDomain(), static_cast<std::uint16_t>(domainNames.size())).first;
+			domainNames.push_back(intern(course->getDomain()));
+		}
+		auto levelIt = levelCodes.find(course->getLevel());
+		if (levelIt == levelCodes.end()) {
+			if (levelNames.size() > std::numeric_limits<std::uint8_t>::max()) {
+				throw std::runtime_error("Too many distinct course levels");
+			}
+			levelIt = levelCodes.emplace(course->getLevel(), static_cast<std::uint8_t>(levelNames.size())).first;
+			levelNames.push_back(intern(course->getLevel()));
+		}
+		ids[slot] = course->getId();
+		titles[slot] = intern(course->getTitle());
+		domains[slot] = domainIt->second;
+		levels[slot] = levelIt->second;
+		durations[slot] = course->getDurationHours();
+		scores[slot] = course->getScore();
+		for (const auto& tag : course->getTags()) {
+			tagList.push_back(findTag(tag));
+		}
+		const auto& prereqs = course->getPrerequisiteCourseIds();
+		prereqList.insert(prereqList.end(), prereqs.begin(), prereqs.end());
+
+		addedDomains.emplace_back(domains[slot], slot);
+		addedLevels.emplace_back(levels[slot], slot);
+		forEachDistinct(std::span<const std::uint32_t>(tagList).subspan(tagOffsets.back()),
+			[&addedTags, slot](std::uint32_t tag) { addedTags.emplace_back(tag, slot); });
+		tagOffsets.push_back(static_cast<std::uint32_t>(tagList.size()));
+		prereqOffsets.push_back(static_cast<std::uint32_t>(prereqList.size()));
+		++slot;
+	}
+	if (arena.size() > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("Catalog strings too large for a snapshot");
+	}
+
+	// Id order: surviving slots keep their positions (a replaced course keeps its id), and
+	// the added slots, already in id order, are merged in
+	std::vector<std::uint32_t> idOrder;
+	idOrder.reserve(m);
+	std::uint32_t nextAdded = survivors;
+	for (std::uint32_t old : baseIdOrder) {
+		if (newSlotOf[old] == None) {
+			continue;
+		}
+		while (nextAdded < m && ids[nextAdded] < ids[newSlotOf[old]]) {
+			idOrder.push_back(nextAdded++);
+		}
+		idOrder.push_back(newSlotOf[old]);
+	}
+	while (nextAdded < m) {
+		idOrder.push_back(nextAdded++);
+	}
+
+	std::vector<std::uint32_t> identityDomains(baseDomainNames.size()), identityLevels(baseLevelNames.size());
+	for (std::uint32_t code = 0; code < identityDomains.size(); ++code) {
+		identityDomains[code] = code;
+	}
+	for (std::uint32_t code = 0; code < identityLevels.size(); ++code) {
+		identityLevels[code] = code;
+	}
+	std::vector<std::uint32_t> domainPostingOffsets, domainPostings, levelPostingOffsets, levelPostings;
+	std::vector<std::uint32_t> tagPostingOffsets, tagPostings;
+	patchPostings(base.section<std::uint32_t>(Section::DomainPostingOffsets), base.section<std::uint32_t>(Section::DomainPostings),
+		identityDomains, domainNames.size(), keptSlot, addedDomains, domainPostingOffsets, domainPostings);
+	patchPostings(base.section<std::uint32_t>(Section::LevelPostingOffsets), base.section<std::uint32_t>(Section::LevelPostings),
+		identityLevels, levelNames.size(), keptSlot, addedLevels, levelPostingOffsets, levelPostings);
+	patchPostings(baseTagPostingOffsets, base.section<std::uint32_t>(Section::TagPostings),
+		tagMap, tagNames.size(), keptSlot, addedTags, tagPostingOffsets, tagPostings);
+
+	std::array<Pending, SectionCount> pending;
+	pending[static_cast<std::size_t>(Section::Arena)] = Pending{arena.data(), arena.size()};
+	pending[static_cast<std::size_t>(Section::Ids)].set(ids);
+	pending[static_cast<std::size_t>(Section::Titles)].set(titles);
+	pending[static_cast<std::size_t>(Section::DomainCodes)].set(domains);
+	pending[static_cast<std::size_t>(Section::LevelCodes)].set(levels);
+	pending[static_cast<std::size_t>(Section::Durations)].set(durations);
+	pending[static_cast<std::size_t>(Section::Scores)].set(scores);
+	pending[static_cast<std::size_t>(Section::TagOffsets)].set(tagOffsets);
+	pending[static_cast<std::size_t>(Section::TagList)].set(tagList);
+	pending[static_cast<std::size_t>(Section::PrereqOffsets)].set(prereqOffsets);
+	pending[static_cast<std::size_t>(Section::PrereqList)].set(prereqList);
+	pending[static_cast<std::size_t>(Section::TagNames)].set(tagNames);
+	pending[static_cast<std::size_t>(Section::DomainNames)].set(domainNames);
+	pending[static_cast<std::size_t>(Section::LevelNames)].set(levelNames);
+	pending[static_cast<std::size_t>(Section::IdOrder)].set(idOrder);
+	pending[static_cast<std::size_t>(Section::DomainPostingOffsets)].set(domainPostingOffsets);
+	pending[static_cast<std::size_t>(Section::DomainPostings)].set(domainPostings);
+	pending[static_cast<std::size_t>(Section::LevelPostingOffsets)].set(levelPostingOffsets);
+	pending[static_cast<std::size_t>(Section::LevelPostings)].set(levelPostings);
+	pending[static_cast<std::size_t>(Section::TagPostingOffsets)].set(tagPostingOffsets);
+	pending[static_cast<std::size_t>(Section::TagPostings)].set(tagPostings);
+
+	std::shared_ptr<CatalogSnapshot> snapshot(new CatalogSnapshot());
+	auto [image, bytes] = assemble(pending);
+	snapshot->owned = std::move(image);
+	snapshot->data = reinterpret_cast<const char*>(snapshot->owned.get());
+	snapshot->size = bytes;
+	return snapshot;
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::map(const std::string& path) {
+	std::shared_ptr<CatalogSnapshot> snapshot(new CatalogSnapshot());
+	snapshot->mapping = new Mapping(path);
+	snapshot->data = static_cast<const char*>(snapshot->mapping->base);
+	snapshot->size = snapshot->mapping->size;
+	snapshot->validate(path);
+	return snapshot;
+}
+
+// Header, section table and the CSR/dictionary sizes; element contents are trusted, since
+// snapshots are only produced by build() and published with a rename
+void CatalogSnapshot::validate(const std::string& source) const {
+	auto fail = [&source](const std::string& reason) {
+		throw std::runtime_error("Invalid catalog snapshot " + source + ": " + reason);
+	};
+	if (size < sizeof(Header)) {
+		fail("file too short");
+	}
+	const Header* header = reinterpret_cast<const Header*>(data);
+	if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0) {
+		fail("bad magic");
+	}
+	if (header->version != Version) {
+		fail("unsupported version " + std::to_string(header->version));
+	}
+	if (header->byteOrder != ByteOrderMark) {
+		fail("written on a machine with a different byte order");
+	}
+	if (header->sectionCount != SectionCount || header->fileBytes != size) {
+		fail("truncated or wrong section table");
+	}
+	for (const auto& entry : header->sections) {
+		if (entry.offset % 8 != 0 || entry.offset > size || entry.bytes > size - entry.offset) {
+			fail("section out of bounds");
+		}
+	}
+
+	const std::size_t n = section<std::int32_t>(Section::Ids).size();
+	const std::size_t tags = section<StrRef>(Section::TagNames).size();
+	const std::size_t domains = section<StrRef>(Section::DomainNames).size();
+	const std::size_t levels = section<StrRef>(Section::LevelNames).size();
+	auto csr = [&](Section offsetsId, std::size_t rows, std::size_t entries) {
+		auto offsets = section<std::uint32_t>(offsetsId);
+		if (offsets.size() != rows + 1 || offsets.front() != 0 || offsets.back() != entries) {
+			fail("inconsistent offsets");
+		}
+	};
+	if (section<StrRef>(Section::Titles).size() != n || section<std::uint16_t>(Section::DomainCodes).size() != n
+	    || section<std::uint8_t>(Section::LevelCodes).size() != n || section<std::int32_t>(Section::Durations).size() != n
+	    || section<double>(Section::Scores).size() != n || section<std::uint32_t>(Section::IdOrder).size() != n) {
+		fail("column lengths differ");
+	}
+	csr(Section::TagOffsets, n, section<std::uint32_t>(Section::TagList).size());
+	csr(Section::PrereqOffsets, n, section<std::int32_t>(Section::PrereqList).size());
+	csr(Section::DomainPostingOffsets, domains, section<std::uint32_t>(Section::DomainPostings).size());
+	csr(Section::LevelPostingOffsets, levels, section<std::uint32_t>(Section::LevelPostings).size());
+	csr(Section::TagPostingOffsets, tags, section<std::uint32_t>(Section::TagPostings).size());
+}
+
+CatalogSnapshot::SectionEntry CatalogSnapshot::sectionEntry(Section id) const {
+	const Header* header = reinterpret_cast<const Header*>(data);
+	const auto& entry = header->sections[static_cast<std::size_t>(id)];
+	return SectionEntry{entry.offset, entry.bytes};
+}
+
+void CatalogSnapshot::save(const std::string& path) const {
+	std::string tmp = path + ".tmp";
+	FILE* file = std::fopen(tmp.c_str(), "wb");
+	if (!file) {
+		throw std::runtime_error("Cannot create " + tmp);
+	}
+	bool ok = std::fwrite(data, 1, size, file) == size;
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok) {
+		std::remove(tmp.c_str());
+		throw std::runtime_error("Cannot write " + tmp);
+	}
+	std::filesystem::rename(tmp, path);
+}
@@ -0,0 +1,28 @@
+#include "../../include/catalog/memory_catalog.hpp"
+#include "../../include/utils/json_helpers.hpp"
+#include "../../include/utils/logger.hpp"
+#include <fstream>
+#include <stdexcept>
+
+MemoryCatalog::MemoryCatalog(const std::string& jsonPath) {
+	std::ifstream file(jsonPath);
+	if (!file.is_open()) {
+		throw std::runtime_error("Cannot open JSON file: " + jsonPath);
+	}
+
+	try {
+		json coursesJson;
+		file >> coursesJson;
+		courses.reserve(coursesJson.size());
+		for (const auto& courseJson : coursesJson) {
+			courses.push_back(jsonToCourse(courseJson));
+		}
+	} catch (const std::exception& e) {
+		throw std::runtime_error("Failed to load courses from " + jsonPath + ": " + e.what());
+	}
+	logging::info("catalog.loaded").kv("courses", courses.size()).kv("source", jsonPath);
+}
+
+std::vector<Course> MemoryCatalog::getAll() {
+	return courses;
+}
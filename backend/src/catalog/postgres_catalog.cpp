@@ -1,38 +1,48 @@
 #include "../../include/catalog/postgres_catalog.hpp"
-#include "../../third_party/json.hpp"
+#include "../../include/utils/json_helpers.hpp"
+#include "../../include/utils/pg_array.hpp"
+#include "../../include/utils/logger.hpp"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <stdexcept>
-#include <iostream>
+#include <unordered_map>
 
-using json = nlohmann::json;
+namespace {
+
+// Columns: id, title, domain, level, duration_hours, tags, prereq_ids
+Course courseFromRow(const pqxx::row& row) {
+	Course course;
+	course.setId(row[0].as<int>());
+	course.setTitle(row[1].as<std::string>());
+	course.setDomain(row[2].as<std::string>());
+	course.setLevel(row[3].as<std::string>());
+	course.setDurationHours(row[4].as<int>());
+	course.setTags(parsePgTextArray(row[5].as<std::string>()));
+	course.setPrerequisiteCourseIds(parsePgIntArray(row[6].as<std::string>()));
+	return course;
+}
+
+}
 
 PostgresCatalog::PostgresCatalog(const std::string& connectionString)
-	: connStr(connectionString) {
+	: PostgresCatalog(std::make_shared<ConnectionPool>(connectionString, 2)) {
+}
+
+PostgresCatalog::PostgresCatalog(std::shared_ptr<ConnectionPool> connectionPool)
+	: pool(std::move(connectionPool)) {
 	try {
-		conn = std::make_unique<pqxx::connection>(connStr);
-		if (!conn->is_open()) {
-			throw std::runtime_error("Failed to connect to PostgreSQL");
-		}
 		createTables();
 	} catch (const std::exception& e) {
 		throw std::runtime_error("PostgreSQL catalog error: " + std::string(e.what()));
 	}
 }
 
-PostgresCatalog::~PostgresCatalog() {
-	if (conn && conn->is_open()) {
-		conn->close();
-	}
-}
-
-void PostgresCatalog::reconnect() {
-	if (!conn || !conn->is_open()) {
-		conn = std::make_unique<pqxx::connection>(connStr);
-	}
-}
+PostgresCatalog::~PostgresCatalog() = default;
 
 void PostgresCatalog::createTables() {
 	try {
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
 		txn.exec(R"(
@@ -50,14 +60,50 @@ void PostgresCatalog::createTables() {
 		txn.exec("CREATE INDEX IF NOT EXISTS idx_courses_domain ON courses(domain)");
 		txn.exec("CREATE INDEX IF NOT EXISTS idx_courses_level ON courses(level)");
 
+		// Catalog versioning for delta ingestion: the version of the last change to each row,
+		// tombstones for removed ids, and the current version (one row)
+		txn.exec("ALTER TABLE courses ADD COLUMN IF NOT EXISTS catalog_version BIGINT NOT NULL DEFAULT 0");
+		txn.exec("CREATE INDEX IF NOT EXISTS idx_courses_catalog_version ON courses(catalog_version)");
+		txn.exec(R"(
+			CREATE TABLE IF NOT EXISTS course_removals (
+				id INTEGER PRIMARY KEY,
+				catalog_version BIGINT NOT NULL
+			)
+		)");
+		txn.exec(R"(
+			CREATE TABLE IF NOT EXISTS catalog_state (
+				only_row BOOLEAN PRIMARY KEY DEFAULT TRUE CHECK (only_row),
+				version BIGINT NOT NULL
+			)
+		)");
+		txn.exec("INSERT INTO catalog_state (version) VALUES (0) ON CONFLICT DO NOTHING");
+
+		// One notification per statement, carrying the catalog version (Postgres folds duplicates
+		// within a transaction), so backends catch up once per delta rather than once per row
+		txn.exec(R"(
+			CREATE OR REPLACE FUNCTION notify_courses_changed() RETURNS trigger AS $$
+			BEGIN
+				PERFORM pg_notify('courses_changed', (SELECT version::text FROM catalog_state));
+				RETURN NULL;
+			END;
+			$$ LANGUAGE plpgsql
+		)");
+		txn.exec("DROP TRIGGER IF EXISTS courses_notify_changed ON courses");
+		txn.exec(R"(
+			CREATE TRIGGER courses_notify_changed
+			AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON courses
+			FOR EACH STATEMENT EXECUTE FUNCTION notify_courses_changed()
+		)");
+
 		txn.commit();
-		std::cout << "Courses table created/verified" << std::endl;
+		logging::info("db.schema").kv("table", "courses");
 	} catch (const std::exception& e) {
 		throw std::runtime_error("Failed to create courses table: " + std::string(e.what()));
 	}
 }
 
-void PostgresCatalog::importFromJson(const std::string& jsonPath) {
+std::uint64_t PostgresCatalog::importFromJson(const std::string& jsonPath) {
+	CatalogDelta delta;
 	try {
 		std::ifstream file(jsonPath);
 		if (!file.is_open()) {
@@ -66,108 +112,183 @@ void PostgresCatalog::importFromJson(const std::string& jsonPath) {
 
 		json coursesJson;
 		file >> coursesJson;
+		delta.upserts.reserve(coursesJson.size());
+		for (const auto& courseJson : coursesJson) {
+			delta.upserts.push_back(jsonToCourse(courseJson));
+		}
+	} catch (const std::exception& e) {
+		throw std::runtime_error("Import failed: " + std::string(e.what()));
+	}
 
-		reconnect();
-		pqxx::work txn(*conn);
+	std::uint64_t version = writeDelta(delta, true);
+	logging::info("catalog.imported").kv("courses", delta.upserts.size()).kv("source", jsonPath).kv("version", version);
+	return version;
+}
 
-		// Clear existing courses
-		txn.exec("DELETE FROM courses");
+std::uint64_t PostgresCatalog::applyDelta(const CatalogDelta& delta) {
+	return writeDelta(delta, false);
+}
 
-		// Insert courses
-		for (const auto& courseJson : coursesJson) {
-			int id = courseJson["id"];
-			std::string title = courseJson["title"];
-			std::string domain = courseJson["domain"];
-			std::string level = courseJson["level"];
-			int duration = courseJson["durationHours"];
-
-			// Convert tags array to PostgreSQL array format
-			std::string tagsArray = "{";
-			for (size_t i = 0; i < courseJson["tags"].size(); ++i) {
-				if (i > 0) tagsArray += ",";
-				tagsArray += "\"" + courseJson["tags"][i].get<std::string>() + "\"";
-			}
-			tagsArray += "}";
+std::uint64_t PostgresCatalog::writeDelta(const CatalogDelta& delta, bool removeUnlisted) {
+	constexpr std::size_t BatchRows = 1000;
+	auto start = std::chrono::steady_clock::now();
 
-			// Convert prereqIds array
-			std::string prereqArray = "{";
-			for (size_t i = 0; i < courseJson["prereqIds"].size(); ++i) {
-				if (i > 0) prereqArray += ",";
-				prereqArray += std::to_string(courseJson["prereqIds"][i].get<int>());
+	// The last upsert of an id wins, and upserted ids are never removed
+	std::unordered_map<int, std::size_t> latest;
+	for (std::size_t i = 0; i < delta.upserts.size(); ++i) {
+		latest[delta.upserts[i].getId()] = i;
+	}
+	std::vector<const Course*> upserts;
+	std::vector<int> upsertIds;
+	upserts.reserve(latest.size());
+	upsertIds.reserve(latest.size());
+	for (std::size_t i = 0; i < delta.upserts.size(); ++i) {
+		if (latest[delta.upserts[i].getId()] == i) {
+			upserts.push_back(&delta.upserts[i]);
+			upsertIds.push_back(delta.upserts[i].getId());
+		}
+	}
+	std::vector<int> removals;
+	for (int id : delta.removals) {
+		if (!latest.count(id)) {
+			removals.push_back(id);
+		}
+	}
+
+	try {
+		auto conn = pool->acquire();
+		pqxx::work txn(*conn);
+
+		// The row lock on catalog_state serializes writers, so versions commit in order
+		auto version = static_cast<std::uint64_t>(
+			txn.exec("UPDATE catalog_state SET version = version + 1 RETURNING version")[0][0].as<long long>());
+		long changedRows = 0;
+
+		// Multi-row upserts: each column goes in as one array parameter (per-row tags and
+		// prerequisites as array literals). Unchanged rows keep their old catalog_version.
+		for (std::size_t begin = 0; begin < upserts.size(); begin += BatchRows) {
+			std::size_t end = std::min(upserts.size(), begin + BatchRows);
+			std::vector<int> ids, durations;
+			std::vector<std::string> titles, domains, levels, tags, prereqs;
+			for (std::size_t i = begin; i < end; ++i) {
+				const Course& course = *upserts[i];
+				ids.push_back(course.getId());
+				titles.push_back(course.getTitle());
+				domains.push_back(course.getDomain());
+				levels.push_back(course.getLevel());
+				durations.push_back(course.getDurationHours());
+				tags.push_back(toPgArray(course.getTags()));
+				prereqs.push_back(toPgArray(course.getPrerequisiteCourseIds()));
 			}
-			prereqArray += "}";
+			auto result = txn.exec(R"(
+				INSERT INTO courses (id, title, domain, level, duration_hours, tags, prereq_ids, catalog_version)
+				SELECT id, title, domain, level, duration_hours, tags::text[], prereq_ids::integer[], $8::bigint
+				FROM unnest($1::integer[], $2::text[], $3::text[], $4::text[], $5::integer[], $6::text[], $7::text[])
+					AS batch(id, title, domain, level, duration_hours, tags, prereq_ids)
+				ON CONFLICT (id) DO UPDATE SET
+					title = EXCLUDED.title, domain = EXCLUDED.domain, level = EXCLUDED.level,
+					duration_hours = EXCLUDED.duration_hours, tags = EXCLUDED.tags,
+					prereq_ids = EXCLUDED.prereq_ids, catalog_version = EXCLUDED.catalog_version
+				WHERE (courses.title, courses.domain, courses.level, courses.duration_hours, courses.tags, courses.prereq_ids)
+					IS DISTINCT FROM (EXCLUDED.title, EXCLUDED.domain, EXCLUDED.level, EXCLUDED.duration_hours, EXCLUDED.tags, EXCLUDED.prereq_ids)
+			)", pqxx::params(toPgArray(ids), toPgArray(titles), toPgArray(domains), toPgArray(levels),
+				toPgArray(durations), toPgArray(tags), toPgArray(prereqs), static_cast<long long>(version)));
+			changedRows += result.affected_rows();
+		}
+		if (!upsertIds.empty()) {
+			txn.exec("DELETE FROM course_removals WHERE id = ANY($1::integer[])", pqxx::params(toPgArray(upsertIds)));
+		}
 
-			txn.exec(
-				"INSERT INTO courses (id, title, domain, level, duration_hours, tags, prereq_ids) VALUES ($1, $2, $3, $4, $5, $6::text[], $7::integer[])",
-				pqxx::params(id, title, domain, level, duration, tagsArray, prereqArray)
-			);
+		// Removed rows leave a tombstone so readers holding an older version drop them too
+		std::string removeWhere = removeUnlisted ? "id <> ALL($1::integer[])" : "id = ANY($1::integer[])";
+		if (removeUnlisted || !removals.empty()) {
+			auto result = txn.exec(
+				"WITH gone AS (DELETE FROM courses WHERE " + removeWhere + " RETURNING id) "
+				"INSERT INTO course_removals (id, catalog_version) SELECT id, $2::bigint FROM gone "
+				"ON CONFLICT (id) DO UPDATE SET catalog_version = EXCLUDED.catalog_version",
+				pqxx::params(toPgArray(removeUnlisted ? upsertIds : removals), static_cast<long long>(version)));
+			changedRows += result.affected_rows();
 		}
 
+		if (changedRows == 0) {
+			txn.abort();
+			logging::debug("catalog.delta_unchanged").kv("upserts", upserts.size()).kv("removals", removals.size());
+			return version - 1;
+		}
 		txn.commit();
-		std::cout << "Imported " << coursesJson.size() << " courses from JSON" << std::endl;
+		logging::info("catalog.delta_applied").kv("version", version).kv("upserts", upserts.size())
+			.kv("removals", removals.size()).kv("changed_rows", changedRows)
+			.kv("ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		return version;
 	} catch (const std::exception& e) {
-		throw std::runtime_error("Import failed: " + std::string(e.what()));
+		throw std::runtime_error("Catalog delta failed: " + std::string(e.what()));
 	}
 }
 
 std::vector<Course> PostgresCatalog::getAll() {
+	std::uint64_t version = 0;
+	return getAll(version);
+}
+
+std::vector<Course> PostgresCatalog::getAll(std::uint64_t& version) {
 	try {
-		reconnect();
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
+		// The version and the rows come from the same snapshot
+		txn.exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ READ ONLY");
+		auto snapshotVersion = static_cast<std::uint64_t>(txn.exec("SELECT version FROM catalog_state")[0][0].as<long long>());
 
 		auto result = txn.exec("SELECT id, title, domain, level, duration_hours, tags, prereq_ids FROM courses ORDER BY id");
 
 		std::vector<Course> courses;
+		courses.reserve(result.size());
 		for (const auto& row : result) {
-			Course course;
-			course.setId(row[0].as<int>());
-			course.setTitle(row[1].as<std::string>());
-			course.setDomain(row[2].as<std::string>());
-			course.setLevel(row[3].as<std::string>());
-			course.setDurationHours(row[4].as<int>());
-
-			// Parse tags array
-			std::string tagsStr = row[5].as<std::string>();
-			std::vector<std::string> tags;
-			if (!tagsStr.empty() && tagsStr != "{}") {
-				tagsStr = tagsStr.substr(1, tagsStr.length() - 2); // Remove {}
-				size_t pos = 0;
-				while ((pos = tagsStr.find(',')) != std::string::npos) {
-					std::string tag = tagsStr.substr(0, pos);
-					if (!tag.empty()) {
-						if (tag.front() == '"') tag = tag.substr(1, tag.length() - 2);
-						tags.push_back(tag);
-					}
-					tagsStr.erase(0, pos + 1);
-				}
-				if (!tagsStr.empty()) {
-					if (tagsStr.front() == '"') tagsStr = tagsStr.substr(1, tagsStr.length() - 2);
-					tags.push_back(tagsStr);
-				}
-			}
-			course.setTags(tags);
-
-			// Parse prereq array
-			std::string prereqStr = row[6].as<std::string>();
-			std::vector<int> prereqs;
-			if (!prereqStr.empty() && prereqStr != "{}") {
-				prereqStr = prereqStr.substr(1, prereqStr.length() - 2); // Remove {}
-				size_t pos = 0;
-				while ((pos = prereqStr.find(',')) != std::string::npos) {
-					prereqs.push_back(std::stoi(prereqStr.substr(0, pos)));
-					prereqStr.erase(0, pos + 1);
-				}
-				if (!prereqStr.empty()) {
-					prereqs.push_back(std::stoi(prereqStr));
-				}
-			}
-			course.setPrerequisiteCourseIds(prereqs);
-
-			courses.push_back(course);
+			courses.push_back(courseFromRow(row));
 		}
 
+		version = snapshotVersion;
 		return courses;
 	} catch (const std::exception& e) {
 		throw std::runtime_error("Failed to get courses: " + std::string(e.what()));
 	}
 }
+
+std::uint64_t PostgresCatalog::currentVersion() {
+	try {
+		auto conn = pool->acquire();
+		pqxx::nontransaction txn(*conn);
+		return static_cast<std::uint64_t>(txn.exec("SELECT version FROM catalog_state")[0][0].as<long long>());
+	} catch (const std::exception& e) {
+		throw std::runtime_error("Failed to read catalog version: " + std::string(e.what()));
+	}
+}
+
+CatalogChangeSet PostgresCatalog::changesSince(std::uint64_t version) {
+	try {
+		auto conn = pool->acquire();
+		pqxx::work txn(*conn);
+		txn.exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ READ ONLY");
+
+		CatalogChangeSet changes;
+		changes.version = static_cast<std::uint64_t>(txn.exec("SELECT version FROM catalog_state")[0][0].as<long long>());
+		if (changes.version <= version) {
+			return changes;
+		}
+
+		auto rows = txn.exec(
+			"SELECT id, title, domain, level, duration_hours, tags, prereq_ids FROM courses WHERE catalog_version > $1 ORDER BY id",
+			pqxx::params(static_cast<long long>(version)));
+		changes.delta.upserts.reserve(rows.size());
+		for (const auto& row : rows) {
+			changes.delta.upserts.push_back(courseFromRow(row));
+		}
+		auto removed = txn.exec("SELECT id FROM course_removals WHERE catalog_version > $1",
+			pqxx::params(static_cast<long long>(version)));
+		for (const auto& row : removed) {
+			changes.delta.removals.push_back(row[0].as<int>());
+		}
+		return changes;
+	} catch (const std::exception& e) {
+		throw std::runtime_error("Failed to read catalog changes: " + std::string(e.what()));
+	}
+}
@@ -0,0 +1,132 @@
+#include "../../include/catalog/prereq_graph.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+}
+
+PrereqGraph::PrereqGraph(const CatalogIndex& catalog) {
+	const std::size_t n = catalog.size();
+
+	// CSR adjacency course -> prerequisite, resolved to slots
+	std::vector<std::uint8_t> unresolved(n, 0);
+	edgeOffsets.reserve(n + 1);
+	edgeOffsets.push_back(0);
+	for (Slot slot = 0; slot < n; ++slot) {
+		CourseView course = catalog.view(slot);
+		for (int prereqId : course.getPrerequisiteCourseIds()) {
+			if (auto prereq = catalog.slotOf(prereqId)) {
+				edges.push_back(*prereq);
+			} else {
+				unresolved[slot] = 1;
+				problems.missing.emplace_back(course.getId(), prereqId);
+			}
+		}
+		edgeOffsets.push_back(static_cast<std::uint32_t>(edges.size()));
+	}
+
+	// Tarjan's strongly connected components, iteratively. A component is emitted only after
+	// every component it reaches, i.e. prerequisites first, so emission order is a topological
+	// order; components with more than one course (or a self-loop) are cycles.
+	std::vector<std::uint32_t> index(n, None), low(n, 0);
+	std::vector<std::uint8_t> onStack(n, 0), cyclic(n, 0);
+	std::vector<Slot> stack;
+	std::vector<std::pair<Slot, std::uint32_t>> calls;   // (course, next edge to visit)
+	std::uint32_t nextIndex = 0;
+	rankOfSlot.assign(n, 0);
+	slotOfRank.reserve(n);
+	for (Slot root = 0; root < n; ++root) {
+		if (index[root] != None) {
+			continue;
+		}
+		calls.emplace_back(root, edgeOffsets[root]);
+		index[root] = low[root] = nextIndex++;
+		stack.push_back(root);
+		onStack[root] = 1;
+		while (!calls.empty()) {
+			auto& [v, edge] = calls.back();
+			if (edge < edgeOffsets[v + 1]) {
+				Slot w = edges[edge++];
+				if (index[w] == None) {
+					index[w] = low[w] = nextIndex++;
+					stack.push_back(w);
+					onStack[w] = 1;
+					calls.emplace_back(w, edgeOffsets[w]);
+				} else if (onStack[w]) {
+					low[v] = std::min(low[v], index[w]);
+				}
+				continue;
+			}
+			Slot done = v;
+			calls.pop_back();
+			if (!calls.empty()) {
+				low[calls.back().first] = std::min(low[calls.back().first], low[done]);
+			}
+			if (low[done] != index[done]) {
+				continue;
+			}
+			auto first = stack.end();
+			do {
+				--first;
+				onStack[*first] = 0;
+			} while (*first != done);
+			bool selfLoop = std::find(edges.begin() + edgeOffsets[done], edges.begin() + edgeOffsets[done + 1], done)
+				!= edges.begin() + edgeOffsets[done + 1];
+			if (stack.end() - first > 1 || selfLoop) {
+				std::vector<int> ids;
+				for (auto it = first; it != stack.end(); ++it) {
+					cyclic[*it] = 1;
+					ids.push_back(catalog.view(*it).getId());
+				}
+				std::sort(ids.begin(), ids.end());
+				problems.cycles.push_back(std::move(ids));
+			}
+			for (auto it = first; it != stack.end(); ++it) {
+				rankOfSlot[*it] = static_cast<Rank>(slotOfRank.size());
+				slotOfRank.push_back(*it);
+			}
+			stack.erase(first, stack.end());
+		}
+	}
+
+	// Blocked courses and closures, in topological order (prerequisites are final before use)
+	blockedSlots.assign(n, 0);
+	closureOffsets.reserve(n + 1);
+	closureOffsets.push_back(0);
+	std::vector<std::pair<std::uint32_t, Word>> words;
+	for (Slot slot : slotOfRank) {
+		bool isBlocked = cyclic[slot] || unresolved[slot];
+		words.clear();
+		for (Slot prereq : isBlocked ? std::span<const Slot>() : prerequisites(slot)) {
+			if (blockedSlots[prereq]) {
+				isBlocked = true;
+				break;
+			}
+			Rank r = rankOfSlot[prereq];
+			words.emplace_back(r / 64, Word{1} << (r % 64));
+			Closure inherited = closure(prereq);
+			for (std::size_t i = 0; i < inherited.words.size(); ++i) {
+				words.emplace_back(inherited.words[i], inherited.bits[i]);
+			}
+		}
+		if (isBlocked) {
+			blockedSlots[slot] = 1;
+			++problems.blocked;
+			words.clear();
+		}
+		std::sort(words.begin(), words.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		for (std::size_t i = 0; i < words.size();) {
+			Word bits = 0;
+			std::uint32_t word = words[i].first;
+			for (; i < words.size() && words[i].first == word; ++i) {
+				bits |= words[i].second;
+			}
+			closureWordIndex.push_back(word);
+			closureBits.push_back(bits);
+		}
+		closureOffsets.push_back(static_cast<std::uint32_t>(closureBits.size()));
+	}
+}
@@ -0,0 +1,138 @@
+#include "../../include/http/plan_writer.hpp"
+#include <charconv>
+
+namespace {
+
+bool needsEscaping(std::string_view value) {
+	for (char c : value) {
+		if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void appendInt(std::string& out, int value) {
+	char digits[16];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	out.append(digits, result.ptr);
+}
+
+}
+
+void appendJsonEscaped(std::string& out, std::string_view value) {
+	static constexpr char hex[] = "0123456789abcdef";
+	std::size_t run = 0;
+	for (std::size_t i = 0; i < value.size(); ++i) {
+		unsigned char c = static_cast<unsigned char>(value[i]);
+		if (c != '"' && c != '\\' && c >= 0x20) {
+			continue;
+		}
+		out.append(value.data() + run, i - run);
+		run = i + 1;
+		switch (c) {
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\b': out += "\\b"; break;
+		case '\f': out += "\\f"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			out += "\\u00";
+			out += hex[c >> 4];
+			out += hex[c & 0xF];
+		}
+	}
+	out.append(value.data() + run, value.size() - run);
+}
+
+PlanFragments::PlanFragments(const CatalogIndex& catalog) {
+	domainOffsets.push_back(0);
+	for (std::size_t code = 0; code < catalog.domainCount(); ++code) {
+		text += "{\"courseDomain\":\"";
+		appendJsonEscaped(text, catalog.domainName(static_cast<CatalogIndex::DomainCode>(code)));
+		text += "\",\"courseId\":";
+		domainOffsets.push_back(static_cast<std::uint32_t>(text.size()));
+	}
+	levelOffsets.push_back(static_cast<std::uint32_t>(text.size()));
+	for (std::size_t code = 0; code < catalog.levelCount(); ++code) {
+		text += ",\"courseLevel\":\"";
+		appendJsonEscaped(text, catalog.levelName(static_cast<CatalogIndex::LevelCode>(code)));
+		text += "\",\"courseTags\":[";
+		levelOffsets.push_back(static_cast<std::uint32_t>(text.size()));
+	}
+	tagOffsets.push_back(static_cast<std::uint32_t>(text.size()));
+	for (std::size_t id = 0; id < catalog.tags().size(); ++id) {
+		text += '"';
+		appendJsonEscaped(text, catalog.tagName(static_cast<std::uint32_t>(id)));
+		text += '"';
+		tagOffsets.push_back(static_cast<std::uint32_t>(text.size()));
+	}
+
+	for (CatalogIndex::Slot slot = 0; slot < catalog.size(); ++slot) {
+		std::string_view title = catalog.view(slot).getTitle();
+		if (needsEscaping(title)) {
+			std::string escaped;
+			appendJsonEscaped(escaped, title);
+			escapedTitles.emplace(slot, std::move(escaped));
+		}
+	}
+}
+
+std::string_view PlanFragments::title(const CourseView& course) const {
+	if (!escapedTitles.empty()) {
+		auto it = escapedTitles.find(course.getSlot());
+		if (it != escapedTitles.end()) {
+			return it->second;
+		}
+	}
+	return course.getTitle();
+}
+
+void writeEnrichedPlan(std::string& out, const Plan& plan, const CatalogIndex& catalog, const PlanFragments& fragments) {
+	out += "{\"steps\":[";
+	bool first = true;
+	for (const auto& step : plan.getSteps()) {
+		if (!first) {
+			out += ',';
+		}
+		first = false;
+
+		if (auto course = catalog.find(step.courseId)) {
+			out += fragments.domainPrefix(course->getDomainCode());
+			appendInt(out, step.courseId);
+			out += fragments.levelPart(course->getLevelCode());
+			auto tagIds = course->getTagIds();
+			for (std::size_t i = 0; i < tagIds.size(); ++i) {
+				if (i) {
+					out += ',';
+				}
+				out += fragments.tag(tagIds[i]);
+			}
+			out += "],\"courseTitle\":\"";
+			out += fragments.title(*course);
+			out += "\",\"hours\":";
+		} else {
+			out += "{\"courseId\":";
+			appendInt(out, step.courseId);
+			out += ",\"hours\":";
+		}
+		appendInt(out, step.hours);
+		out += ",\"note\":\"";
+		appendJsonEscaped(out, step.note);
+		out += "\",\"step\":";
+		appendInt(out, step.step);
+		out += '}';
+	}
+	out += "],\"totalHours\":";
+	appendInt(out, plan.getTotalHours());
+	out += '}';
+}
+
+std::string_view renderEnrichedPlan(const Plan& plan, const CatalogIndex& catalog, const PlanFragments& fragments) {
+	thread_local std::string buffer;
+	buffer.clear();
+	writeEnrichedPlan(buffer, plan, catalog, fragments);
+	return buffer;
+}
@@ -0,0 +1,122 @@
+#include "../../include/http/prerendered_body.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <zlib.h>
+
+namespace {
+
+// windowBits: 15 = zlib stream (HTTP "deflate"), 15 | 16 = gzip wrapper
+std::string compress(const std::string& input, int windowBits) {
+	z_stream stream{};
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		return {};
+	}
+
+	std::string output(deflateBound(&stream, static_cast<uLong>(input.size())) + 32, '\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	stream.avail_in = static_cast<uInt>(input.size());
+	stream.next_out = reinterpret_cast<Bytef*>(output.data());
+	stream.avail_out = static_cast<uInt>(output.size());
+
+	int code = deflate(&stream, Z_FINISH);
+	output.resize(code == Z_STREAM_END ? stream.total_out : 0);
+	deflateEnd(&stream);
+	return output;
+}
+
+std::string strongEtag(const std::string& body, const char* suffix) {
+	// FNV-1a over the identity bytes: equal bodies give equal tags across restarts and instances
+	std::uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : body) {
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "\"%016llx%s\"", static_cast<unsigned long long>(hash), suffix);
+	return buffer;
+}
+
+std::string_view trim(std::string_view value) {
+	while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+	while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+	return value;
+}
+
+// Calls f(item) for each comma-separated item of a header value
+template <typename F>
+void forEachItem(std::string_view header, F&& f) {
+	while (!header.empty()) {
+		std::size_t comma = header.find(',');
+		f(trim(header.substr(0, comma)));
+		if (comma == std::string_view::npos) {
+			break;
+		}
+		header.remove_prefix(comma + 1);
+	}
+}
+
+}
+
+PrerenderedBody::PrerenderedBody(std::string body)
+	: identity(std::move(body)),
+	  gzip(compress(identity, 15 | 16)),
+	  deflate(compress(identity, 15)),
+	  tag(strongEtag(identity, "")),
+	  gzipTag(strongEtag(identity, "-gz")),
+	  deflateTag(strongEtag(identity, "-df")) {
+}
+
+const std::string& PrerenderedBody::select(std::string_view acceptEncoding, std::string_view& encoding, std::string_view& etag) const {
+	bool acceptsGzip = false;
+	bool acceptsDeflate = false;
+	forEachItem(acceptEncoding, [&](std::string_view item) {
+		std::string_view coding = trim(item.substr(0, item.find(';')));
+		bool refused = item.find("q=0") != std::string_view::npos &&
+		               item.find_first_of("123456789", item.find("q=0")) == std::string_view::npos;
+		if (refused) {
+			return;
+		}
+		if (coding == "gzip" || coding == "*") acceptsGzip = true;
+		if (coding == "deflate") acceptsDeflate = true;
+	});
+
+	// Only send a compressed variant when it is actually smaller
+	if (acceptsGzip && !gzip.empty() && gzip.size() < identity.size()) {
+		encoding = "gzip";
+		etag = gzipTag;
+		return gzip;
+	}
+	if (acceptsDeflate && !deflate.empty() && deflate.size() < identity.size()) {
+		encoding = "deflate";
+		etag = deflateTag;
+		return deflate;
+	}
+	encoding = "";
+	etag = tag;
+	return identity;
+}
+
+bool PrerenderedBody::matches(std::string_view ifNoneMatch) const {
+	bool matched = false;
+	forEachItem(ifNoneMatch, [&](std::string_view candidate) {
+		if (candidate.substr(0, 2) == "W/") {
+			candidate.remove_prefix(2);
+		}
+		if (candidate == "*" || candidate == tag || candidate == gzipTag || candidate == deflateTag) {
+			matched = true;
+		}
+	});
+	return matched;
+}
+
+LazyPrerenderedBody::LazyPrerenderedBody(std::function<std::string()> renderBody)
+	: render(std::move(renderBody)) {}
+
+const PrerenderedBody& LazyPrerenderedBody::get() const {
+	std::call_once(once, [this] {
+		body = PrerenderedBody(render());
+		render = nullptr;
+	});
+	return body;
+}
@@ -0,0 +1,500 @@
+#include "../../include/http/request_decoder.hpp"
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Single-pass reader over one body. Values are read in the order the schema code asks for
+// them; everything it does not ask for goes through skip(). Failures throw RequestDecodeError.
+class Reader {
+public:
+	Reader(std::string_view text, const DecodeLimits& bodyLimits)
+		: begin(text.data()), p(text.data()), end(text.data() + text.size()), limits(bodyLimits) {
+		if (text.size() > limits.maxBodyBytes) {
+			throw RequestDecodeError("request body of " + std::to_string(text.size()) + " bytes exceeds the " +
+				std::to_string(limits.maxBodyBytes) + "-byte limit");
+		}
+	}
+
+	// Calls member(name) for every member; member must read or skip the value
+	template <typename Member>
+	void object(Member&& member) {
+		expect('{', "'{'");
+		enter();
+		if (!consume('}')) {
+			do {
+				skipSpace();
+				if (p == end || *p != '"') {
+					fail("expected a member name");
+				}
+				++p;
+				std::string_view name = key();
+				expect(':', "':'");
+				member(name);
+			} while (consume(','));
+			expect('}', "',' or '}'");
+		}
+		--depth;
+	}
+
+	// Calls item() for every element, at most maxItems of them
+	template <typename Item>
+	void list(Item&& item) {
+		array(std::forward<Item>(item), limits.maxItems);
+	}
+
+	void string(std::string& out) {
+		skipSpace();
+		if (p == end || *p != '"') {
+			fail("expected a string");
+		}
+		++p;
+		out.clear();
+		restOfString(out);
+	}
+
+	int integer() {
+		skipSpace();
+		const char* start = p;
+		bool fraction = scanNumber();
+		if (!fraction) {
+			int value = 0;
+			if (std::from_chars(start, p, value).ec != std::errc{}) {
+				fail("integer out of range");
+			}
+			return value;
+		}
+		// 7.0 or 1e2: truncated like json_helpers' get<int>()
+		double value = 0.0;
+		if (std::from_chars(start, p, value).ec != std::errc{} ||
+			!(value > static_cast<double>(std::numeric_limits<int>::min()) - 1.0 &&
+			  value < static_cast<double>(std::numeric_limits<int>::max()) + 1.0)) {
+			// 1e400 overflows the double itself (out_of_range, value left at 0)
+			fail("integer out of range");
+		}
+		return static_cast<int>(value);
+	}
+
+	void skip() {
+		skipSpace();
+		if (p == end) {
+			fail("unexpected end of body");
+		}
+		switch (*p) {
+		case '{':
+			object([this](std::string_view) { skip(); });
+			return;
+		case '[':
+			array([this] { skip(); }, std::numeric_limits<std::size_t>::max());
+			return;
+		case '"':
+			string(scratch);
+			return;
+		case 't':
+			literal("true");
+			return;
+		case 'f':
+			literal("false");
+			return;
+		case 'n':
+			literal("null");
+			return;
+		default:
+			scanNumber();
+			return;
+		}
+	}
+
+	void finish() {
+		skipSpace();
+		if (p != end) {
+			fail("unexpected data after the body");
+		}
+	}
+
+private:
+	[[noreturn]] void fail(std::string_view what) const {
+		throw RequestDecodeError(std::string(what) + " at offset " + std::to_string(p - begin));
+	}
+
+	void skipSpace() {
+		while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+			++p;
+		}
+	}
+
+	bool consume(char c) {
+		skipSpace();
+		if (p != end && *p == c) {
+			++p;
+			return true;
+		}
+		return false;
+	}
+
+	void expect(char c, const char* what) {
+		if (!consume(c)) {
+			fail(std::string("expected ") + what);
+		}
+	}
+
+	void enter() {
+		if (++depth > limits.maxDepth) {
+			fail("nesting deeper than " + std::to_string(limits.maxDepth));
+		}
+	}
+
+	template <typename Item>
+	void array(Item&& item, std::size_t maxItems) {
+		expect('[', "'['");
+		enter();
+		if (!consume(']')) {
+			std::size_t count = 0;
+			do {
+				if (++count > maxItems) {
+					fail("more than " + std::to_string(maxItems) + " items");
+				}
+				item();
+			} while (consume(','));
+			expect(']', "',' or ']'");
+		}
+		--depth;
+	}
+
+	// Member name after its opening quote: a view of the body unless it has escapes
+	std::string_view key() {
+		const char* start = p;
+		while (p != end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20 &&
+			   static_cast<unsigned char>(*p) < 0x80) {
+			++p;
+		}
+		if (p != end && *p == '"') {
+			return std::string_view(start, static_cast<std::size_t>(p++ - start));
+		}
+		scratch.assign(start, p);
+		restOfString(scratch);
+		return scratch;
+	}
+
+	// Appends the string after its opening quote (or after what the caller already copied)
+	void restOfString(std::string& out) {
+		while (true) {
+			const char* run = p;
+			while (p != end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20 &&
+				   static_cast<unsigned char>(*p) < 0x80) {
+				++p;
+			}
+			out.append(run, p);
+			if (out.size() > limits.maxStringBytes) {
+				fail("string longer than " + std::to_string(limits.maxStringBytes) + " bytes");
+			}
+			if (p == end) {
+				fail("unterminated string");
+			}
+			unsigned char c = static_cast<unsigned char>(*p);
+			if (c == '"') {
+				++p;
+				return;
+			}
+			if (c == '\\') {
+				++p;
+				escape(out);
+			} else if (c < 0x20) {
+				fail("control character in string");
+			} else {
+				utf8(out);
+			}
+		}
+	}
+
+	void escape(std::string& out) {
+		if (p == end) {
+			fail("unterminated string");
+		}
+		switch (*p++) {
+		case '"': out += '"'; return;
+		case '\\': out += '\\'; return;
+		case '/': out += '/'; return;
+		case 'b': out += '\b'; return;
+		case 'f': out += '\f'; return;
+		case 'n': out += '\n'; return;
+		case 'r': out += '\r'; return;
+		case 't': out += '\t'; return;
+		case 'u': break;
+		default: --p; fail("invalid escape");
+		}
+
+		std::uint32_t codePoint = hex4();
+		if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+			fail("unpaired surrogate");
+		}
+		if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+			if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+				fail("unpaired surrogate");
+			}
+			p += 2;
+			std::uint32_t low = hex4();
+			if (low < 0xDC00 || low > 0xDFFF) {
+				fail("unpaired surrogate");
+			}
+			codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+		}
+
+		if (codePoint < 0x80) {
+			out += static_cast<char>(codePoint);
+		} else if (codePoint < 0x800) {
+			out += static_cast<char>(0xC0 | (codePoint >> 6));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		} else if (codePoint < 0x10000) {
+			out += static_cast<char>(0xE0 | (codePoint >> 12));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		} else {
+			out += static_cast<char>(0xF0 | (codePoint >> 18));
+			out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	std::uint32_t hex4() {
+		if (end - p < 4) {
+			fail("truncated \\u escape");
+		}
+		std::uint32_t value = 0;
+		for (int i = 0; i < 4; ++i, ++p) {
+			char c = *p;
+			value <<= 4;
+			if (c >= '0' && c <= '9') {
+				value |= static_cast<std::uint32_t>(c - '0');
+			} else if (c >= 'a' && c <= 'f') {
+				value |= static_cast<std::uint32_t>(c - 'a' + 10);
+			} else if (c >= 'A' && c <= 'F') {
+				value |= static_cast<std::uint32_t>(c - 'A' + 10);
+			} else {
+				fail("invalid \\u escape");
+			}
+		}
+		return value;
+	}
+
+	// One multi-byte UTF-8 sequence, validated (no overlong forms, surrogates or values past U+10FFFF)
+	void utf8(std::string& out) {
+		const auto* s = reinterpret_cast<const unsigned char*>(p);
+		std::size_t length = 0;
+		unsigned char low = 0x80;
+		unsigned char high = 0xBF;
+		if (s[0] >= 0xC2 && s[0] <= 0xDF) {
+			length = 2;
+		} else if (s[0] >= 0xE0 && s[0] <= 0xEF) {
+			length = 3;
+			low = s[0] == 0xE0 ? 0xA0 : 0x80;
+			high = s[0] == 0xED ? 0x9F : 0xBF;
+		} else if (s[0] >= 0xF0 && s[0] <= 0xF4) {
+			length = 4;
+			low = s[0] == 0xF0 ? 0x90 : 0x80;
+			high = s[0] == 0xF4 ? 0x8F : 0xBF;
+		} else {
+			fail("invalid UTF-8");
+		}
+		if (static_cast<std::size_t>(end - p) < length || s[1] < low || s[1] > high) {
+			fail("invalid UTF-8");
+		}
+		for (std::size_t i = 2; i < length; ++i) {
+			if (s[i] < 0x80 || s[i] > 0xBF) {
+				fail("invalid UTF-8");
+			}
+		}
+		out.append(p, length);
+		p += length;
+	}
+
+	// JSON number grammar; true when it has a fraction or exponent
+	bool scanNumber() {
+		auto digit = [this] { return p != end && *p >= '0' && *p <= '9'; };
+		auto digits = [&] {
+			if (!digit()) {
+				fail("expected a number");
+			}
+			while (digit()) {
+				++p;
+			}
+		};
+		if (p != end && *p == '-') {
+			++p;
+		}
+		if (p != end && *p == '0') {
+			++p;
+		} else {
+			digits();
+		}
+		bool fraction = false;
+		if (p != end && *p == '.') {
+			++p;
+			digits();
+			fraction = true;
+		}
+		if (p != end && (*p == 'e' || *p == 'E')) {
+			++p;
+			if (p != end && (*p == '+' || *p == '-')) {
+				++p;
+			}
+			digits();
+			fraction = true;
+		}
+		return fraction;
+	}
+
+	void literal(std::string_view word) {
+		if (static_cast<std::size_t>(end - p) < word.size() || std::string_view(p, word.size()) != word) {
+			fail("invalid literal");
+		}
+		p += word.size();
+	}
+
+	const char* begin;
+	const char* p;
+	const char* end;
+	const DecodeLimits& limits;
+	std::size_t depth = 0;
+	std::string scratch;   // escaped member names and skipped strings
+};
+
+UserProfile readProfile(Reader& in) {
+	UserProfile profile;
+	in.object([&](std::string_view name) {
+		if (name == "userId") {
+			profile.setUserId(in.integer());
+		} else if (name == "targetDomain") {
+			std::string domain;
+			in.string(domain);
+			profile.setTargetDomain(std::move(domain));
+		} else if (name == "currentLevel") {
+			std::string level;
+			in.string(level);
+			profile.setCurrentLevel(std::move(level));
+		} else if (name == "interests") {
+			std::vector<std::string> interests;
+			in.list([&] {
+				in.string(interests.emplace_back());
+			});
+			profile.setInterests(std::move(interests));
+		} else if (name == "hoursPerWeek") {
+			profile.setHoursPerWeek(in.integer());
+		} else if (name == "deadlineWeeks") {
+			profile.setDeadlineWeeks(in.integer());
+		} else {
+			in.skip();
+		}
+	});
+	return profile;
+}
+
+PlanStep readStep(Reader& in, std::size_t index) {
+	PlanStep step{};
+	unsigned seen = 0;
+	in.object([&](std::string_view name) {
+		if (name == "step") {
+			step.step = in.integer();
+			seen |= 1;
+		} else if (name == "courseId") {
+			step.courseId = in.integer();
+			seen |= 2;
+		} else if (name == "hours") {
+			step.hours = in.integer();
+			seen |= 4;
+		} else if (name == "note") {
+			in.string(step.note);
+			seen |= 8;
+		} else {
+			in.skip();
+		}
+	});
+	static constexpr const char* fields[] = {"step", "courseId", "hours", "note"};
+	for (unsigned bit = 0; bit < 4; ++bit) {
+		if (!(seen & (1u << bit))) {
+			throw RequestDecodeError("missing field \"" + std::string(fields[bit]) + "\" in step " + std::to_string(index));
+		}
+	}
+	return step;
+}
+
+}
+
+UserProfile decodeRecommendationRequest(std::string_view body, const DecodeLimits& limits) {
+	Reader in(body, limits);
+	std::optional<UserProfile> profile;
+	in.object([&](std::string_view name) {
+		if (name == "profile") {
+			profile = readProfile(in);
+		} else {
+			in.skip();
+		}
+	});
+	in.finish();
+	if (!profile) {
+		throw RequestDecodeError("missing field \"profile\"");
+	}
+	return std::move(*profile);
+}
+
+Plan decodePlan(std::string_view body, const DecodeLimits& limits) {
+	Reader in(body, limits);
+	std::vector<PlanStep> steps;
+	std::optional<int> totalHours;
+	in.object([&](std::string_view name) {
+		if (name == "steps") {
+			steps.clear();
+			in.list([&] {
+				steps.push_back(readStep(in, steps.size()));
+			});
+		} else if (name == "totalHours") {
+			totalHours = in.integer();
+		} else {
+			in.skip();
+		}
+	});
+	in.finish();
+	if (!totalHours) {
+		throw RequestDecodeError("missing field \"totalHours\"");
+	}
+	Plan plan;
+	plan.setSteps(std::move(steps));
+	plan.setTotalHours(*totalHours);
+	return plan;
+}
+
+Credentials decodeCredentials(std::string_view body, bool withEmail, const DecodeLimits& limits) {
+	Reader in(body, limits);
+	Credentials credentials;
+	unsigned seen = 0;
+	in.object([&](std::string_view name) {
+		if (name == "username") {
+			in.string(credentials.username);
+			seen |= 1;
+		} else if (name == "password") {
+			in.string(credentials.password);
+			seen |= 2;
+		} else if (withEmail && name == "email") {
+			in.string(credentials.email);
+			seen |= 4;
+		} else {
+			in.skip();
+		}
+	});
+	in.finish();
+	if (!(seen & 1)) {
+		throw RequestDecodeError("missing field \"username\"");
+	}
+	if (!(seen & 2)) {
+		throw RequestDecodeError("missing field \"password\"");
+	}
+	if (withEmail && !(seen & 4)) {
+		throw RequestDecodeError("missing field \"email\"");
+	}
+	return credentials;
+}
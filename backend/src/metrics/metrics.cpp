@@ -0,0 +1,251 @@
+#include "../../include/metrics/metrics.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+namespace metrics {
+
+namespace {
+
+// Bucket boundaries (seconds) exported for every histogram
+constexpr double ExportedBounds[] = {
+	0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+constexpr double ExportedQuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+void appendNumber(std::string& out, double value) {
+	char buffer[32];
+	int length = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+	out.append(buffer, static_cast<std::size_t>(length));
+}
+
+void appendSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+	out += name;
+	if (!labels.empty()) {
+		out += '{';
+		out += labels;
+		out += '}';
+	}
+	out += ' ';
+	appendNumber(out, value);
+	out += '\n';
+}
+
+std::string withLabel(const std::string& labels, const std::string& extra) {
+	return labels.empty() ? extra : labels + "," + extra;
+}
+
+std::string quantileName(const std::string& name) {
+	const std::string suffix = "_seconds";
+	if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+		return name.substr(0, name.size() - suffix.size()) + "_quantile_seconds";
+	}
+	return name + "_quantile";
+}
+
+}
+
+std::size_t threadStripe() {
+	static std::atomic<std::size_t> next{0};
+	thread_local std::size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % Stripes;
+	return stripe;
+}
+
+std::uint64_t Counter::value() const {
+	std::uint64_t total = 0;
+	for (const auto& cell : cells) {
+		total += cell.value.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+std::size_t Histogram::bucketOf(std::uint64_t ns) {
+	if (ns < 16) {
+		return static_cast<std::size_t>(ns);
+	}
+	int exponent = 63 - std::countl_zero(ns);
+	std::size_t sub = static_cast<std::size_t>(ns >> (exponent - SubBits)) & 7;
+	std::size_t bucket = 16 + static_cast<std::size_t>(exponent - 4) * 8 + sub;
+	return bucket < Buckets ? bucket : Buckets - 1;
+}
+
+std::uint64_t Histogram::upperEdge(std::size_t bucket) {
+	if (bucket < 16) {
+		return bucket;
+	}
+	int exponent = 4 + static_cast<int>((bucket - 16) / 8);
+	std::uint64_t sub = (bucket - 16) % 8;
+	std::uint64_t width = std::uint64_t{1} << (exponent - SubBits);
+	return (8 + sub) * width + width - 1;
+}
+
+void Histogram::record(std::chrono::nanoseconds duration) {
+	std::uint64_t ns = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+	Stripe& stripe = stripes[threadStripe()];
+	stripe.counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+	stripe.sumNs.fetch_add(ns, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+	Snapshot result;
+	for (std::size_t s = 0; s < Stripes; ++s) {
+		const Stripe& stripe = stripes[s];
+		for (std::size_t b = 0; b < Buckets; ++b) {
+			std::uint64_t n = stripe.counts[b].load(std::memory_order_relaxed);
+			result.counts[b] += n;
+			result.count += n;
+		}
+		result.sumNs += stripe.sumNs.load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+std::uint64_t Histogram::Snapshot::countAtOrBelow(std::uint64_t ns) const {
+	std::uint64_t total = 0;
+	for (std::size_t b = 0; b < Buckets && upperEdge(b) <= ns; ++b) {
+		total += counts[b];
+	}
+	return total;
+}
+
+std::uint64_t Histogram::Snapshot::quantile(double q) const {
+	if (count == 0) {
+		return 0;
+	}
+	std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+	std::uint64_t seen = 0;
+	for (std::size_t b = 0; b < Buckets; ++b) {
+		seen += counts[b];
+		if (seen >= rank && seen > 0) {
+			return upperEdge(b);
+		}
+	}
+	return upperEdge(Buckets - 1);
+}
+
+Registry::Family& Registry::family(const std::string& name, const std::string& help, Type type) {
+	for (auto& existing : families) {
+		if (existing.name == name) {
+			return existing;
+		}
+	}
+	families.push_back(Family{name, help, type, {}});
+	return families.back();
+}
+
+Registry::Series* Registry::find(Family& family, const std::string& labels) {
+	for (auto& series : family.series) {
+		if (series.labels == labels) {
+			return &series;
+		}
+	}
+	return nullptr;
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Family& target = family(name, help, Type::Counter);
+	if (Series* existing = find(target, labels); existing && existing->counter) {
+		return *existing->counter;
+	}
+	Counter& created = counters.emplace_back();
+	target.series.push_back(Series{labels, &created, nullptr, {}});
+	return created;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Family& target = family(name, help, Type::Histogram);
+	if (Series* existing = find(target, labels); existing && existing->histogram) {
+		return *existing->histogram;
+	}
+	Histogram& created = histograms.emplace_back();
+	target.series.push_back(Series{labels, nullptr, &created, {}});
+	return created;
+}
+
+void Registry::gauge(const std::string& name, const std::string& help, const std::string& labels,
+                     std::function<double()> read) {
+	std::lock_guard<std::mutex> lock(mutex);
+	family(name, help, Type::Gauge).series.push_back(Series{labels, nullptr, nullptr, std::move(read)});
+}
+
+void Registry::counterFunction(const std::string& name, const std::string& help, const std::string& labels,
+                               std::function<double()> read) {
+	std::lock_guard<std::mutex> lock(mutex);
+	family(name, help, Type::Counter).series.push_back(Series{labels, nullptr, nullptr, std::move(read)});
+}
+
+std::string Registry::render() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::string out;
+	out.reserve(64 * 1024);
+
+	for (const auto& family : families) {
+		const char* type = family.type == Type::Counter ? "counter"
+		                 : family.type == Type::Gauge ? "gauge" : "histogram";
+		out += "# HELP " + family.name + " " + family.help + "\n";
+		out += "# TYPE " + family.name + " " + type + "\n";
+
+		if (family.type != Type::Histogram) {
+			for (const auto& series : family.series) {
+				double value = series.counter ? static_cast<double>(series.counter->value()) : series.read();
+				appendSample(out, family.name, series.labels, value);
+			}
+			continue;
+		}
+
+		std::vector<Histogram::Snapshot> snapshots;
+		snapshots.reserve(family.series.size());
+		for (const auto& series : family.series) {
+			const Histogram::Snapshot& snap = snapshots.emplace_back(series.histogram->snapshot());
+			for (double bound : ExportedBounds) {
+				std::string le = "le=\"";
+				appendNumber(le, bound);
+				le += '"';
+				appendSample(out, family.name + "_bucket", withLabel(series.labels, le),
+				             static_cast<double>(snap.countAtOrBelow(static_cast<std::uint64_t>(bound * 1e9))));
+			}
+			appendSample(out, family.name + "_bucket", withLabel(series.labels, "le=\"+Inf\""),
+			             static_cast<double>(snap.count));
+			appendSample(out, family.name + "_sum", series.labels, static_cast<double>(snap.sumNs) / 1e9);
+			appendSample(out, family.name + "_count", series.labels, static_cast<double>(snap.count));
+		}
+
+		// Percentiles straight from the HDR buckets, finer than the exported `le` boundaries
+		std::string quantiles = quantileName(family.name);
+		out += "# HELP " + quantiles + " " + family.help + " (percentiles since start)\n";
+		out += "# TYPE " + quantiles + " gauge\n";
+		for (std::size_t i = 0; i < family.series.size(); ++i) {
+			for (double q : ExportedQuantiles) {
+				std::string label = "quantile=\"";
+				appendNumber(label, q);
+				label += '"';
+				appendSample(out, quantiles, withLabel(family.series[i].labels, label),
+				             static_cast<double>(snapshots[i].quantile(q)) / 1e9);
+			}
+		}
+	}
+	return out;
+}
+
+Registry& registry() {
+	static Registry instance;
+	return instance;
+}
+
+Histogram& phase(Phase which) {
+	static const auto histograms = [] {
+		const char* help = "Time spent in each phase of request handling";
+		Registry& r = registry();
+		return std::array<Histogram*, 4>{
+			&r.histogram("roadmap_phase_duration_seconds", help, "phase=\"json_parse\""),
+			&r.histogram("roadmap_phase_duration_seconds", help, "phase=\"make_plan\""),
+			&r.histogram("roadmap_phase_duration_seconds", help, "phase=\"scoring\""),
+			&r.histogram("roadmap_phase_duration_seconds", help, "phase=\"serialize\""),
+		};
+	}();
+	return *histograms[static_cast<std::size_t>(which)];
+}
+
+}
@@ -0,0 +1,39 @@
+#include "../../include/recommender/candidate_set.hpp"
+#include "../../include/services/affinity.hpp"
+#include "../../include/services/scoring.hpp"
+#include <algorithm>
+
+void CandidateSet::slotsFor(const std::string& targetDomain, const CatalogIndex& catalog,
+                            CatalogIndex::SlotList& slots) {
+    auto appendDomain = [&](CatalogIndex::DomainCode code) {
+        CatalogIndex::SlotSpan domainSlots = catalog.byDomain(code);
+        slots.insert(slots.end(), domainSlots.begin(), domainSlots.end());
+    };
+    slots.clear();
+    // Related domains (DomainRelations) are allowed cross-domain, after the target's own courses
+    if (auto target = catalog.domainCode(targetDomain)) {
+        appendDomain(*target);
+        for (CatalogIndex::DomainCode related : catalog.affinity().related(*target)) {
+            appendDomain(related);
+        }
+        return;
+    }
+    // A target without courses of its own: its related domains by name (each once)
+    std::vector<CatalogIndex::DomainCode> added;
+    for (const auto& relation : DomainRelations::current()) {
+        const std::string* related = relation.first == targetDomain ? &relation.second
+                                   : relation.second == targetDomain ? &relation.first : nullptr;
+        auto code = related ? catalog.domainCode(*related) : std::nullopt;
+        if (code && std::find(added.begin(), added.end(), *code) == added.end()) {
+            added.push_back(*code);
+            appendDomain(*code);
+        }
+    }
+}
+
+void CandidateSet::assign(const CatalogIndex& catalog, const std::string& domain, const std::string& userLevel) {
+    targetDomain = domain;
+    level = userLevel;
+    slotsFor(targetDomain, catalog, slots);
+    ScoringService::baseScores(catalog, slots, targetDomain, level, baseScores);
+}
@@ -1,75 +1,340 @@
 #include "../../include/recommender/greedy.hpp"
+#include "../../include/catalog/prereq_graph.hpp"
+#include "../../include/metrics/metrics.hpp"
+#include "../../include/utils/thread_pool.hpp"
 #include <algorithm>
-#include <set>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
 
-Plan GreedyRecommender::makePlan(const UserProfile& profile, const std::vector<Course>& allCourses) {
-    Plan plan;
+namespace {
+
+// A candidate in selection order: higher score first, ties in catalog order. `exact` is false
+// while `score` is only ScoringService::upperBound (the course was pruned from the first round).
+struct Candidate {
+    double score;
+    double base;   // domain and level part of the score
+    CatalogIndex::Slot slot;
+    bool exact;
+};
+
+bool before(const Candidate& a, const Candidate& b) {
+    return a.score > b.score || (a.score == b.score && a.slot < b.slot);
+}
+
+// Per-thread working set reused across requests, so steady-state planning only
+// allocates the returned plan itself
+struct PlanScratch {
+    CatalogIndex::SlotList relevantSlots;
+    InterestMask interests;
+    std::vector<double> domainLevel;
+    std::vector<Candidate> candidates;
+    std::vector<std::uint32_t> heap;                // first-round top-k, as positions in `candidates`
+    std::vector<PrereqGraph::Word> taken;           // dense bitset over prerequisite-graph ranks
+    std::vector<std::uint32_t> takenWords;          // words set in `taken`, to reset it cheaply
+    std::vector<PrereqGraph::Rank> missing;
     std::vector<PlanStep> steps;
-    int totalHours = 0;
+};
 
-    int totalAvailableHours = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+thread_local PlanScratch scratch;
 
-    // Filter courses by domain FIRST (strict requirement)
-    std::vector<Course> relevantCourses;
-    for (const auto& course : allCourses) {
-        // Only include courses from the target domain or closely related domains
-        if (course.getDomain() == profile.getTargetDomain()) {
-            relevantCourses.push_back(course);
-        }
-        // For AI/Data Science - they're related, allow cross-domain
-        else if ((profile.getTargetDomain() == "AI" && course.getDomain() == "Data Science") ||
-                 (profile.getTargetDomain() == "Data Science" && course.getDomain() == "AI")) {
-            relevantCourses.push_back(course);
+// First-round size: about twice the number of courses the budget holds at the candidates'
+// mean duration, plus slack for courses skipped because their prerequisites do not fit
+std::size_t roundSize(std::span<const Candidate> candidates, std::span<const std::int32_t> durations, int budget) {
+    if (candidates.empty()) {
+        return 0;
+    }
+    long long hours = 0;
+    for (const Candidate& c : candidates) {
+        hours += durations[c.slot];
+    }
+    long long meanHours = std::max(1LL, hours / static_cast<long long>(candidates.size()));
+    return std::min(candidates.size(), static_cast<std::size_t>(16 + 2 * std::max(0, budget) / meanHours));
+}
+
+// Greedy selection in score order. A course whose missing prerequisites (transitively) fit in
+// the remaining budget together with it is taken with them, prerequisites first in topological
+// order; blocked courses (prerequisite cycles, unknown ids) are skipped.
+class Selection {
+public:
+    Selection(const CatalogIndex& catalog, int budget)
+        : catalog(catalog), graph(catalog.prerequisiteGraph()), durations(catalog.durations()), budget(budget) {
+        scratch.taken.resize(graph.words(), 0);
+        scratch.steps.clear();
+    }
+
+    ~Selection() {
+        for (std::uint32_t word : scratch.takenWords) {
+            scratch.taken[word] = 0;
         }
+        scratch.takenWords.clear();
     }
 
-    // Score filtered courses
-    std::vector<std::pair<double, Course>> scoredCourses;
-    for (const auto& course : relevantCourses) {
-        double score = scorer.matchScore(course, profile);
-        scoredCourses.push_back({score, course});
+    int remaining() const { return budget - totalHours; }
+    bool taken(CatalogIndex::Slot slot) const {
+        PrereqGraph::Rank rank = graph.rank(slot);
+        return (scratch.taken[rank / 64] >> (rank % 64)) & 1;
+    }
+    // Courses that can never be taken from here on: too long for what is left, already taken, blocked
+    bool excluded(CatalogIndex::Slot slot) const {
+        return durations[slot] > remaining() || graph.blocked(slot) || taken(slot);
     }
 
-    // Sort by score descending
-    std::sort(scoredCourses.begin(), scoredCourses.end(),
-              [](const auto& a, const auto& b) { return a.first > b.first; });
+    void consider(double score, CatalogIndex::Slot slot) {
+        if (graph.blocked(slot) || taken(slot)) {
+            return;
+        }
 
-    // Greedy selection with prerequisite handling
-    std::set<int> completedCourseIds;
-    int stepNumber = 1;
+        // Time for the course plus whatever it still needs
+        int hours = durations[slot];
+        auto& missing = scratch.missing;
+        missing.clear();
+        graph.forEachMissing(slot, scratch.taken, [&](PrereqGraph::Rank rank) {
+            missing.push_back(rank);
+            hours += durations[graph.slotAt(rank)];
+        });
+        if (totalHours + hours > budget) {
+            return;
+        }
 
-    for (const auto& [score, course] : scoredCourses) {
-        // Check if we have enough time
-        if (totalHours + course.getDurationHours() > totalAvailableHours) {
-            continue;
+        std::snprintf(note, sizeof(note), "Prerequisite for course %d", catalog.view(slot).getId());
+        for (PrereqGraph::Rank rank : missing) {
+            addStep(graph.slotAt(rank));
         }
+        std::snprintf(note, sizeof(note), "Score: %f", score); // same text as "Score: " + std::to_string(score)
+        addStep(slot);
+    }
 
-        // Check prerequisites are met
-        bool prereqsMet = true;
-        for (int prereqId : course.getPrerequisiteCourseIds()) {
-            if (completedCourseIds.find(prereqId) == completedCourseIds.end()) {
-                prereqsMet = false;
-                break;
+    // Considers every candidate left, best first: each round takes the next `k` in order
+    // (nth_element + sorting only those) after dropping the ones that no longer fit, and the
+    // next round is twice as large. Pruned candidates get their exact score from `rescore`
+    // once they survive that filter. Stops when nothing left fits the remaining budget.
+    template <typename Rescore>
+    void rounds(std::vector<Candidate>& left, std::size_t k, Rescore&& rescore) {
+        while (true) {
+            left.erase(std::remove_if(left.begin(), left.end(),
+                                      [this](const Candidate& c) { return excluded(c.slot); }),
+                       left.end());
+            if (left.empty()) {
+                return;
+            }
+            for (Candidate& c : left) {
+                if (!c.exact) {
+                    c.score = rescore(c);
+                    c.exact = true;
+                }
+            }
+            k = std::clamp<std::size_t>(k, 1, left.size());
+            auto end = left.begin() + static_cast<std::ptrdiff_t>(k);
+            if (k < left.size()) {
+                std::nth_element(left.begin(), end - 1, left.end(), before);
             }
+            std::sort(left.begin(), end, before);
+            for (auto it = left.begin(); it != end; ++it) {
+                consider(it->score, it->slot);
+            }
+            left.erase(left.begin(), end);
+            k *= 2;
         }
+    }
 
-        if (!prereqsMet) {
-            continue;
-        }
+    Plan finish() {
+        Plan plan;
+        plan.setSteps(std::vector<PlanStep>(std::make_move_iterator(scratch.steps.begin()),
+                                            std::make_move_iterator(scratch.steps.end())));
+        plan.setTotalHours(totalHours);
+        return plan;
+    }
 
-        // Add course to plan
+private:
+    void addStep(CatalogIndex::Slot slot) {
         PlanStep step;
         step.step = stepNumber++;
-        step.courseId = course.getId();
-        step.hours = course.getDurationHours();
-        step.note = "Score: " + std::to_string(score);
+        step.courseId = catalog.view(slot).getId();
+        step.hours = durations[slot];
+        step.note = note;
+        scratch.steps.push_back(std::move(step));
+        totalHours += durations[slot];
+
+        PrereqGraph::Rank rank = graph.rank(slot);
+        scratch.taken[rank / 64] |= PrereqGraph::Word{1} << (rank % 64);
+        scratch.takenWords.push_back(rank / 64);
+    }
+
+    const CatalogIndex& catalog;
+    const PrereqGraph& graph;
+    std::span<const std::int32_t> durations;
+    const int budget;
+    int totalHours = 0;
+    int stepNumber = 1;
+    char note[64];
+};
 
-        steps.push_back(step);
-        totalHours += course.getDurationHours();
-        completedCourseIds.insert(course.getId());
+// Scores candidates[begin, end) into `heap`, the positions of their best k. A course whose upper
+// bound cannot beat the heap's worst entry is not scored (no tag matching): it keeps the bound
+// and exact == false. Distinct ranges may be scored concurrently.
+void scoreTopK(std::vector<Candidate>& candidates, std::size_t begin, std::size_t end, std::size_t k,
+               const CatalogIndex& catalog, const InterestMask& interests, std::vector<std::uint32_t>& heap) {
+    // Min-heap on selection order: heap.front() is the worst of the current top k
+    auto worse = [&candidates](std::uint32_t a, std::uint32_t b) { return before(candidates[a], candidates[b]); };
+    heap.clear();
+    for (std::size_t i = begin; i < end; ++i) {
+        Candidate& c = candidates[i];
+        if (heap.size() == k) {
+            c.score = ScoringService::upperBound(catalog, c.slot, c.base, interests);
+            if (!before(c, candidates[heap.front()])) {
+                continue;   // pruned: keeps its upper bound until rescored
+            }
+        }
+        c.score = ScoringService::scoreFromBase(catalog, c.slot, c.base, interests);
+        c.exact = true;
+        if (heap.size() < k) {
+            heap.push_back(static_cast<std::uint32_t>(i));
+            std::push_heap(heap.begin(), heap.end(), worse);
+        } else if (before(c, candidates[heap.front()])) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            heap.back() = static_cast<std::uint32_t>(i);
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
     }
+}
+
+// Streaming plan over `slots` with base scores from baseOf(i): courses that can never fit are
+// filtered out, and topK(candidates, k, top) leaves the positions of the best k in `top` (in any
+// order; it may return more). Pruned courses only get an exact score if the first round leaves
+// room for them.
+template <typename BaseOf, typename TopK>
+Plan streamPlan(const UserProfile& profile, const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                BaseOf&& baseOf, TopK&& topK) {
+    const int budget = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+    Selection selection(catalog, budget);
+    auto& candidates = scratch.candidates;
+    candidates.clear();
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        if (!selection.excluded(slots[i])) {
+            candidates.push_back({0.0, baseOf(i), slots[i], false});
+        }
+    }
+
+    const InterestMask& interests = scratch.interests;
+    auto& top = scratch.heap;
+    const std::size_t k = roundSize(candidates, catalog.durations(), budget);
+    {
+        metrics::ScopedTimer timer(metrics::phase(metrics::Phase::Scoring));
+        topK(candidates, k, top);
+    }
+
+    // Round one: the best k in order. Their entries are then dropped from the candidates.
+    auto ordered = [&candidates](std::uint32_t a, std::uint32_t b) { return before(candidates[a], candidates[b]); };
+    if (top.size() > k) {
+        std::nth_element(top.begin(), top.begin() + static_cast<std::ptrdiff_t>(k - 1), top.end(), ordered);
+        top.resize(k);
+    }
+    std::sort(top.begin(), top.end(), ordered);
+    for (std::uint32_t i : top) {
+        selection.consider(candidates[i].score, candidates[i].slot);
+        candidates[i].slot = CatalogIndex::Slot(-1);
+    }
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [](const Candidate& c) { return c.slot == CatalogIndex::Slot(-1); }),
+                     candidates.end());
+
+    selection.rounds(candidates, 2 * k, [&](const Candidate& c) {
+        return ScoringService::scoreFromBase(catalog, c.slot, c.base, interests);
+    });
+    return selection.finish();
+}
+
+}
 
-    plan.setSteps(steps);
-    plan.setTotalHours(totalHours);
-    return plan;
-}
\ No newline at end of file
+GreedyRecommender::GreedyRecommender(ParallelScoringOptions parallelOptions)
+    : parallel(parallelOptions) {
+}
+
+GreedyStats GreedyRecommender::stats() const {
+    return GreedyStats{inlineScorings.load(), parallelScorings.load(), nsPerCandidate.load()};
+}
+
+Plan GreedyRecommender::makePlan(const UserProfile& profile, const CatalogIndex& catalog) {
+    // Filter courses by domain FIRST (strict requirement) using the domain partitions
+    CatalogIndex::SlotList& relevantSlots = scratch.relevantSlots;
+    CandidateSet::slotsFor(profile.getTargetDomain(), catalog, relevantSlots);
+
+    // Score filtered courses; interests are matched against the tag dictionary once per request
+    scratch.interests.assign(catalog, profile.getInterests());
+    ScoringService::domainLevelTable(catalog, profile.getTargetDomain(), profile.getCurrentLevel(), scratch.domainLevel);
+    return streamPlan(profile, catalog, relevantSlots, [&](std::size_t i) {
+        return scratch.domainLevel[catalog.domainCodes()[relevantSlots[i]] * catalog.levelCount() + catalog.levelCodes()[relevantSlots[i]]];
+    }, [&](std::vector<Candidate>& candidates, std::size_t k, std::vector<std::uint32_t>& top) {
+        const InterestMask& interests = scratch.interests;
+        const std::size_t count = candidates.size();
+        using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+        // Moving average of the scoring cost per candidate. Parallel runs feed it too (summed
+        // chunk time), so one slow sample cannot keep every later large request parallel.
+        auto sample = [&](double ns) {
+            double perCandidate = ns / static_cast<double>(count);
+            double previous = nsPerCandidate.load(std::memory_order_relaxed);
+            nsPerCandidate.store(previous == 0.0 ? perCandidate : 0.9 * previous + 0.1 * perCandidate, std::memory_order_relaxed);
+        };
+
+        // Parallel only with a pool, enough candidates for two chunks, and inline scoring of this
+        // many expected to take longer than the budget (once it has been measured)
+        std::size_t chunks = std::min(parallel.maxThreads, count / std::max<std::size_t>(parallel.minChunk, 1));
+        double expectedNs = nsPerCandidate.load(std::memory_order_relaxed) * static_cast<double>(count);
+        if (!parallel.pool || chunks < 2 ||
+            expectedNs < Nanoseconds(parallel.inlineBudget).count()) {
+            inlineScorings.fetch_add(1, std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            scoreTopK(candidates, 0, count, k, catalog, interests, top);
+            if (count >= parallel.minChunk) {
+                sample(Nanoseconds(std::chrono::steady_clock::now() - start).count());
+            }
+            return;
+        }
+
+        // One task per chunk, so at most `chunks` threads (the request thread included) work on
+        // this request. Each chunk keeps its own top k; their union holds the overall top k.
+        parallelScorings.fetch_add(1, std::memory_order_relaxed);
+        std::vector<std::vector<std::uint32_t>> chunkTops(chunks);
+        std::vector<double> chunkNs(chunks, 0.0);
+        parallel.pool->forEach(chunks, [&](std::size_t c) {
+            auto start = std::chrono::steady_clock::now();
+            scoreTopK(candidates, count * c / chunks, count * (c + 1) / chunks, k, catalog, interests, chunkTops[c]);
+            chunkNs[c] = Nanoseconds(std::chrono::steady_clock::now() - start).count();
+        });
+        double totalNs = 0.0;
+        for (double ns : chunkNs) {
+            totalNs += ns;
+        }
+        sample(totalNs);
+        top.clear();
+        for (const auto& chunkTop : chunkTops) {
+            top.insert(top.end(), chunkTop.begin(), chunkTop.end());
+        }
+    });
+}
+
+// Batch plans are already spread over the pool one profile per task, so they score inline
+Plan GreedyRecommender::makePlan(const UserProfile& profile, const CatalogIndex& catalog, const CandidateSet& candidates) {
+    scratch.interests.assign(catalog, profile.getInterests());
+    return streamPlan(profile, catalog, candidates.slots, [&](std::size_t i) { return candidates.baseScores[i]; },
+        [&](std::vector<Candidate>& all, std::size_t k, std::vector<std::uint32_t>& top) {
+            scoreTopK(all, 0, all.size(), k, catalog, scratch.interests, top);
+        });
+}
+
+Plan GreedyRecommender::selectPlan(const UserProfile& profile, const CatalogIndex& catalog,
+                                   CatalogIndex::SlotSpan slots, std::span<const double> scores) {
+    const int budget = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+    Selection selection(catalog, budget);
+    auto& candidates = scratch.candidates;
+    candidates.clear();
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        candidates.push_back({scores[i], 0.0, slots[i], true});
+    }
+    selection.rounds(candidates, roundSize(candidates, catalog.durations(), budget),
+                     [](const Candidate& c) { return c.score; });
+    return selection.finish();
+}
@@ -0,0 +1,436 @@
+#include "../../include/recommender/knapsack.hpp"
+#include "../../include/catalog/prereq_graph.hpp"
+#include "../../include/metrics/metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <queue>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+constexpr double Eps = 1e-9;
+
+// Search state of a position: which branch was tried first, or that none is left
+enum class Branch : std::uint8_t { TakeFirst, SkipFirst, Done };
+
+// Per-thread working set reused across requests, like GreedyRecommender's
+struct KnapsackScratch {
+    CatalogIndex::SlotList candidates;
+    InterestMask interests;
+    std::vector<double> scores;
+    std::vector<std::uint32_t> itemOf;   // by slot: index into `found`, None outside the problem
+
+    // Items (candidates that fit plus their prerequisites) in discovery order
+    std::vector<CatalogIndex::Slot> found;
+    std::vector<double> foundValue;
+    std::vector<double> foundPriority;
+    std::vector<std::uint32_t> byRank;
+    std::vector<std::uint32_t> pendingPrereqs;
+    std::vector<std::uint32_t> dependentOffsets;
+    std::vector<std::uint32_t> dependents;
+    std::vector<std::uint32_t> positionOf;
+
+    // Items in search (topological) order
+    std::vector<CatalogIndex::Slot> slot;
+    std::vector<int> weight;
+    std::vector<double> value;
+    std::vector<double> priority;
+    std::vector<std::uint32_t> prereqOffsets;
+    std::vector<std::uint32_t> prereqs;      // positions, all before the dependent
+
+    // Bounds on what positions k.. can still add
+    std::vector<double> dp;                  // [k * (budget + 1) + hours]
+    std::vector<double> suffixValue;         // positive-hour items
+    std::vector<double> suffixFreeValue;     // zero-hour items
+    std::vector<double> suffixRatio;         // best score per hour
+
+    std::vector<std::uint8_t> taken;
+    std::vector<Branch> branch;
+    std::vector<std::uint32_t> chosen;
+    std::vector<std::uint32_t> best;
+
+    std::vector<PrereqGraph::Word> takenRanks;
+    std::vector<std::uint32_t> takenWords;
+    std::vector<std::pair<double, CatalogIndex::Slot>> planned;
+    std::vector<PrereqGraph::Rank> missing;
+    std::vector<PlanStep> steps;
+};
+
+thread_local KnapsackScratch scratch;
+
+// Sum of hours of a course's transitive prerequisites
+int closureHours(const PrereqGraph& graph, std::span<const std::int32_t> durations, CatalogIndex::Slot slot) {
+    int hours = 0;
+    PrereqGraph::Closure closure = graph.closure(slot);
+    for (std::size_t i = 0; i < closure.words.size(); ++i) {
+        for (PrereqGraph::Word bits = closure.bits[i]; bits; bits &= bits - 1) {
+            hours += durations[graph.slotAt(static_cast<PrereqGraph::Rank>(closure.words[i] * 64 + std::countr_zero(bits)))];
+        }
+    }
+    return hours;
+}
+
+}
+
+KnapsackRecommender::KnapsackRecommender(KnapsackOptions knapsackOptions)
+    : options(knapsackOptions) {
+}
+
+KnapsackStats KnapsackRecommender::stats() const {
+    return KnapsackStats{optimal.load(), cutOff.load(), improved.load()};
+}
+
+Plan KnapsackRecommender::makePlan(const UserProfile& profile, const CatalogIndex& catalog) {
+    const Clock::time_point deadline = Clock::now() + options.timeBudget;
+    auto& s = scratch;
+    CandidateSet::slotsFor(profile.getTargetDomain(), catalog, s.candidates);
+    s.interests.assign(catalog, profile.getInterests());
+    {
+        metrics::ScopedTimer timer(metrics::phase(metrics::Phase::Scoring));
+        scorer.scorePartition(catalog, s.candidates, profile, s.interests, s.scores);
+    }
+    return solve(profile, catalog, s.candidates, s.scores, deadline);
+}
+
+Plan KnapsackRecommender::makePlan(const UserProfile& profile, const CatalogIndex& catalog, const CandidateSet& candidates) {
+    const Clock::time_point deadline = Clock::now() + options.timeBudget;
+    auto& s = scratch;
+    s.interests.assign(catalog, profile.getInterests());
+    {
+        metrics::ScopedTimer timer(metrics::phase(metrics::Phase::Scoring));
+        scorer.scoreFromBase(catalog, candidates.slots, candidates.baseScores, s.interests, s.scores);
+    }
+    return solve(profile, catalog, candidates.slots, s.scores, deadline);
+}
+
+Plan KnapsackRecommender::solve(const UserProfile& profile, const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                                std::span<const double> scores, Clock::time_point deadline) {
+    // The greedy plan over the same candidates and scores is the fallback and first incumbent
+    Plan baseline = greedy.selectPlan(profile, catalog, slots, scores);
+    const int budget = profile.getHoursPerWeek() * profile.getDeadlineWeeks();
+    if (budget <= 0 || Clock::now() >= deadline) {
+        cutOff.fetch_add(1, std::memory_order_relaxed);
+        return baseline;
+    }
+    auto& s = scratch;
+
+    // Items: every candidate that fits the budget with its prerequisites, and those prerequisites
+    const PrereqGraph& graph = catalog.prerequisiteGraph();
+    auto durations = catalog.durations();
+    s.itemOf.resize(catalog.size(), None);
+    s.found.clear();
+    s.foundValue.clear();
+    auto addItem = [&](CatalogIndex::Slot slot) {
+        if (s.itemOf[slot] == None) {
+            s.itemOf[slot] = static_cast<std::uint32_t>(s.found.size());
+            s.found.push_back(slot);
+            s.foundValue.push_back(0.0);
+        }
+        return s.itemOf[slot];
+    };
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        CatalogIndex::Slot slot = slots[i];
+        if (graph.blocked(slot) || durations[slot] > budget || durations[slot] + closureHours(graph, durations, slot) > budget) {
+            continue;
+        }
+        PrereqGraph::Closure closure = graph.closure(slot);
+        for (std::size_t w = 0; w < closure.words.size(); ++w) {
+            for (PrereqGraph::Word bits = closure.bits[w]; bits; bits &= bits - 1) {
+                addItem(graph.slotAt(static_cast<PrereqGraph::Rank>(closure.words[w] * 64 + std::countr_zero(bits))));
+            }
+        }
+        s.foundValue[addItem(slot)] = std::max(scores[i], 0.0);
+    }
+    const std::size_t n = s.found.size();
+    auto release = [&] {
+        for (CatalogIndex::Slot slot : s.found) {
+            s.itemOf[slot] = None;
+        }
+    };
+    if (Clock::now() >= deadline) {
+        release();
+        cutOff.fetch_add(1, std::memory_order_relaxed);
+        return baseline;
+    }
+
+    // Priority of an item: the best score per hour of any course it leads to, counting the
+    // whole prerequisite chain. Propagated from dependents to prerequisites in reverse
+    // topological order.
+    s.foundPriority.assign(n, 0.0);
+    for (std::uint32_t d = 0; d < n; ++d) {
+        if (s.foundValue[d] <= 0.0) {
+            continue;
+        }
+        double chainValue = s.foundValue[d];
+        int chainHours = durations[s.found[d]];
+        PrereqGraph::Closure closure = graph.closure(s.found[d]);
+        for (std::size_t w = 0; w < closure.words.size(); ++w) {
+            for (PrereqGraph::Word bits = closure.bits[w]; bits; bits &= bits - 1) {
+                CatalogIndex::Slot prereq = graph.slotAt(static_cast<PrereqGraph::Rank>(closure.words[w] * 64 + std::countr_zero(bits)));
+                chainValue += s.foundValue[s.itemOf[prereq]];
+                chainHours += durations[prereq];
+            }
+        }
+        s.foundPriority[d] = chainValue / std::max(chainHours, 1);
+    }
+    s.byRank.resize(n);
+    for (std::uint32_t d = 0; d < n; ++d) {
+        s.byRank[d] = d;
+    }
+    std::sort(s.byRank.begin(), s.byRank.end(),
+              [&](std::uint32_t a, std::uint32_t b) { return graph.rank(s.found[a]) > graph.rank(s.found[b]); });
+    s.pendingPrereqs.assign(n, 0);
+    s.dependentOffsets.assign(n + 1, 0);
+    for (std::uint32_t d : s.byRank) {
+        for (CatalogIndex::Slot prereq : graph.prerequisites(s.found[d])) {
+            std::uint32_t p = s.itemOf[prereq];
+            s.foundPriority[p] = std::max(s.foundPriority[p], s.foundPriority[d]);
+            ++s.pendingPrereqs[d];
+            ++s.dependentOffsets[p + 1];
+        }
+    }
+    for (std::size_t d = 0; d < n; ++d) {
+        s.dependentOffsets[d + 1] += s.dependentOffsets[d];
+    }
+    s.dependents.resize(s.dependentOffsets[n]);
+    {
+        std::vector<std::uint32_t>& fill = s.positionOf;   // borrowed as a write cursor
+        fill.assign(s.dependentOffsets.begin(), s.dependentOffsets.end() - 1);
+        for (std::uint32_t d = 0; d < n; ++d) {
+            for (CatalogIndex::Slot prereq : graph.prerequisites(s.found[d])) {
+                s.dependents[fill[s.itemOf[prereq]]++] = d;
+            }
+        }
+    }
+
+    // Search order: topological, highest priority first among the items whose prerequisites
+    // are placed, so the first descent is a good plan already
+    auto lower = [&](std::uint32_t a, std::uint32_t b) {
+        return s.foundPriority[a] < s.foundPriority[b]
+            || (s.foundPriority[a] == s.foundPriority[b] && graph.rank(s.found[a]) > graph.rank(s.found[b]));
+    };
+    std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, decltype(lower)> ready(lower);
+    for (std::uint32_t d = 0; d < n; ++d) {
+        if (s.pendingPrereqs[d] == 0) {
+            ready.push(d);
+        }
+    }
+    s.positionOf.assign(n, 0);
+    s.slot.clear();
+    s.weight.clear();
+    s.value.clear();
+    s.priority.clear();
+    while (!ready.empty()) {
+        std::uint32_t d = ready.top();
+        ready.pop();
+        s.positionOf[d] = static_cast<std::uint32_t>(s.slot.size());
+        s.slot.push_back(s.found[d]);
+        s.weight.push_back(std::max(durations[s.found[d]], 0));
+        s.value.push_back(s.foundValue[d]);
+        s.priority.push_back(s.foundPriority[d]);
+        for (std::uint32_t i = s.dependentOffsets[d]; i < s.dependentOffsets[d + 1]; ++i) {
+            if (--s.pendingPrereqs[s.dependents[i]] == 0) {
+                ready.push(s.dependents[i]);
+            }
+        }
+    }
+    s.prereqOffsets.assign(1, 0);
+    s.prereqs.clear();
+    for (std::size_t k = 0; k < n; ++k) {
+        for (CatalogIndex::Slot prereq : graph.prerequisites(s.slot[k])) {
+            s.prereqs.push_back(s.positionOf[s.itemOf[prereq]]);
+        }
+        s.prereqOffsets.push_back(static_cast<std::uint32_t>(s.prereqs.size()));
+    }
+
+    if (Clock::now() >= deadline) {
+        release();
+        cutOff.fetch_add(1, std::memory_order_relaxed);
+        return baseline;
+    }
+
+    // Upper bounds for positions k..n-1 given the hours left
+    const std::size_t stride = static_cast<std::size_t>(budget) + 1;
+    const bool useDp = (n + 1) * stride <= options.dpCells;
+    if (useDp) {
+        s.dp.resize((n + 1) * stride);
+        std::fill(s.dp.begin() + n * stride, s.dp.end(), 0.0);
+        for (std::size_t k = n; k-- > 0;) {
+            const double* next = s.dp.data() + (k + 1) * stride;
+            double* row = s.dp.data() + k * stride;
+            for (std::size_t h = 0; h < stride; ++h) {
+                row[h] = next[h];
+                if (static_cast<std::size_t>(s.weight[k]) <= h) {
+                    row[h] = std::max(row[h], s.value[k] + next[h - s.weight[k]]);
+                }
+            }
+        }
+    } else {
+        s.suffixValue.assign(n + 1, 0.0);
+        s.suffixFreeValue.assign(n + 1, 0.0);
+        s.suffixRatio.assign(n + 1, 0.0);
+        for (std::size_t k = n; k-- > 0;) {
+            bool free = s.weight[k] == 0;
+            s.suffixValue[k] = s.suffixValue[k + 1] + (free ? 0.0 : s.value[k]);
+            s.suffixFreeValue[k] = s.suffixFreeValue[k + 1] + (free ? s.value[k] : 0.0);
+            s.suffixRatio[k] = free ? s.suffixRatio[k + 1] : std::max(s.suffixRatio[k + 1], s.value[k] / s.weight[k]);
+        }
+    }
+    auto bound = [&](std::size_t k, int hoursLeft) {
+        if (useDp) {
+            return s.dp[k * stride + static_cast<std::size_t>(hoursLeft)];
+        }
+        return s.suffixFreeValue[k] + std::min(s.suffixValue[k], hoursLeft * s.suffixRatio[k]);
+    };
+
+    double bestValue = 0.0;
+    for (const auto& step : baseline.getSteps()) {
+        auto slot = catalog.slotOf(step.courseId);
+        if (slot && s.itemOf[*slot] != None) {
+            bestValue += s.foundValue[s.itemOf[*slot]];
+        }
+    }
+
+    // Depth-first branch and bound: position k is taken or skipped once positions 0..k-1 are
+    // decided; taking it requires its direct prerequisites to be taken, so every node is a valid plan
+    s.taken.assign(n, 0);
+    s.branch.resize(n);
+    s.chosen.clear();
+    s.best.clear();
+    bool better = false;
+    bool finished = false;
+    double value = 0.0;
+    int hours = 0;
+    std::size_t k = 0;
+    std::uint64_t nodes = 0;
+    auto canTake = [&](std::size_t k) {
+        if (hours + s.weight[k] > budget) {
+            return false;
+        }
+        for (std::uint32_t i = s.prereqOffsets[k]; i < s.prereqOffsets[k + 1]; ++i) {
+            if (!s.taken[s.prereqs[i]]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto take = [&](std::size_t k) {
+        s.taken[k] = 1;
+        s.chosen.push_back(static_cast<std::uint32_t>(k));
+        hours += s.weight[k];
+        value += s.value[k];
+    };
+    for (;;) {
+        if (value > bestValue + Eps) {
+            bestValue = value;
+            s.best = s.chosen;
+            better = true;
+        }
+        if (k < n && value + bound(k, budget - hours) > bestValue + Eps) {
+            if ((++nodes & 1023) == 0 && (nodes >= options.maxNodes || Clock::now() >= deadline)) {
+                break;
+            }
+            bool feasible = canTake(k);
+            // Scored courses follow the DP when there is one; prerequisites are taken first when
+            // they lead anywhere, since the bound does not see that their dependents need them
+            bool takeFirst = feasible && (s.value[k] > 0.0 || s.priority[k] > 0.0);
+            if (takeFirst && useDp && s.value[k] > 0.0) {
+                takeFirst = s.value[k] + bound(k + 1, budget - hours - s.weight[k]) + Eps >= bound(k + 1, budget - hours);
+            }
+            s.branch[k] = !feasible ? Branch::Done : takeFirst ? Branch::TakeFirst : Branch::SkipFirst;
+            if (takeFirst) {
+                take(k);
+            }
+            ++k;
+            continue;
+        }
+
+        // Backtrack to the deepest position with a branch left
+        bool resumed = false;
+        while (k > 0) {
+            --k;
+            if (s.taken[k]) {
+                s.taken[k] = 0;
+                s.chosen.pop_back();
+                hours -= s.weight[k];
+                value -= s.value[k];
+            }
+            if (s.branch[k] != Branch::Done) {
+                if (s.branch[k] == Branch::SkipFirst) {
+                    take(k);
+                }
+                s.branch[k] = Branch::Done;
+                ++k;
+                resumed = true;
+                break;
+            }
+        }
+        if (!resumed) {
+            finished = true;
+            break;
+        }
+    }
+    (finished ? optimal : cutOff).fetch_add(1, std::memory_order_relaxed);
+
+    release();
+    if (!better) {
+        return baseline;
+    }
+    improved.fetch_add(1, std::memory_order_relaxed);
+
+    // Same layout as the greedy plan: scored courses by score, each preceded by the prerequisites
+    // it still needs in topological order. Prerequisites that only served dropped courses are left out.
+    s.planned.clear();
+    for (std::uint32_t position : s.best) {
+        if (s.value[position] > 0.0) {
+            s.planned.emplace_back(s.value[position], s.slot[position]);
+        }
+    }
+    std::sort(s.planned.begin(), s.planned.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+    s.takenRanks.resize(graph.words(), 0);
+    s.steps.clear();
+    int totalHours = 0;
+    char note[64];
+    auto addStep = [&](CatalogIndex::Slot slot) {
+        PlanStep step;
+        step.step = static_cast<int>(s.steps.size()) + 1;
+        step.courseId = catalog.view(slot).getId();
+        step.hours = durations[slot];
+        step.note = note;
+        s.steps.push_back(std::move(step));
+        totalHours += durations[slot];
+
+        PrereqGraph::Rank rank = graph.rank(slot);
+        s.takenRanks[rank / 64] |= PrereqGraph::Word{1} << (rank % 64);
+        s.takenWords.push_back(rank / 64);
+    };
+    for (const auto& [score, slot] : s.planned) {
+        PrereqGraph::Rank rank = graph.rank(slot);
+        if ((s.takenRanks[rank / 64] >> (rank % 64)) & 1) {
+            continue;
+        }
+        s.missing.clear();
+        graph.forEachMissing(slot, s.takenRanks, [&](PrereqGraph::Rank missing) { s.missing.push_back(missing); });
+        std::snprintf(note, sizeof(note), "Prerequisite for course %d", catalog.view(slot).getId());
+        for (PrereqGraph::Rank missing : s.missing) {
+            addStep(graph.slotAt(missing));
+        }
+        std::snprintf(note, sizeof(note), "Score: %f", score);
+        addStep(slot);
+    }
+    for (std::uint32_t word : s.takenWords) {
+        s.takenRanks[word] = 0;
+    }
+    s.takenWords.clear();
+
+    Plan plan;
+    plan.setSteps(std::vector<PlanStep>(std::make_move_iterator(s.steps.begin()),
+                                        std::make_move_iterator(s.steps.end())));
+    plan.setTotalHours(totalHours);
+    return plan;
+}
@@ -23,51 +23,316 @@
 
 #include "../third_party/json.hpp"
 #include "../include/catalog/postgres_catalog.hpp"
+#include "../include/catalog/catalog_index.hpp"
+#include "../include/catalog/catalog_snapshot.hpp"
+#include "../include/catalog/catalog_holder.hpp"
+#include "../include/catalog/memory_catalog.hpp"
 #include "../include/storage/postgres_storage.hpp"
+#include "../include/storage/memory_storage.hpp"
+#include "../include/storage/embedded_storage.hpp"
+#include "../include/storage/write_behind_storage.hpp"
+#include "../include/storage/notification_listener.hpp"
+#include "../include/cache/plan_cache.hpp"
+#include "../include/cache/recommendation_cache.hpp"
+#include "../include/http/prerendered_body.hpp"
+#include "../include/http/request_decoder.hpp"
+#include "../include/http/request_metrics.hpp"
+#include "../include/metrics/metrics.hpp"
 #include "../include/recommender/greedy.hpp"
+#include "../include/recommender/knapsack.hpp"
+#include "../include/services/affinity.hpp"
 #include "../include/utils/json_helpers.hpp"
+#include "../include/utils/logger.hpp"
+#include "../include/utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
 
 using json = nlohmann::json;
 
+// Plan with full course details, as returned by /api/recommendations and GET /api/plans/<int>
+static std::string renderEnrichedPlan(const Plan& plan, const LoadedCatalog& catalog) {
+	metrics::ScopedTimer timer(metrics::phase(metrics::Phase::Serialize));
+	return std::string(renderEnrichedPlan(plan, catalog.index, catalog.planFragments));
+}
+
+// Request bodies are parsed through here so the json_parse phase is timed in one place
+static json parseBody(const std::string& body) {
+	metrics::ScopedTimer timer(metrics::phase(metrics::Phase::JsonParse));
+	return json::parse(body);
+}
+
+// Same for the typed decoders (request_decoder.hpp) used by the single-profile, plan and auth routes
+template <typename Decode>
+static auto decodeBody(Decode&& decode) {
+	metrics::ScopedTimer timer(metrics::phase(metrics::Phase::JsonParse));
+	return decode();
+}
+
+// Largest cohort accepted by POST /api/recommendations/batch
+static constexpr std::size_t MaxBatchProfiles = 10000;
+
+// Answers a GET from a pre-rendered body: 304 on a matching If-None-Match, otherwise the
+// best encoded variant for the client's Accept-Encoding
+static crow::response servePrerendered(const crow::request& req, const PrerenderedBody& body) {
+	std::string_view encoding;
+	std::string_view etag;
+	const std::string& selected = body.select(req.get_header_value("Accept-Encoding"), encoding, etag);
+
+	crow::response res;
+	res.set_header("ETag", std::string(etag));
+	res.set_header("Vary", "Accept-Encoding");
+	res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
+	res.set_header("Access-Control-Allow-Credentials", "true");
+
+	if (body.matches(req.get_header_value("If-None-Match"))) {
+		res.code = 304;
+		return res;
+	}
+
+	res.code = 200;
+	res.body = selected;
+	res.set_header("Content-Type", "application/json");
+	if (!encoding.empty()) {
+		res.set_header("Content-Encoding", std::string(encoding));
+	}
+	return res;
+}
+
+// First run against an empty database: load data/courses.json into the courses table
+static void importCoursesIfEmpty(PostgresCatalog& catalog) {
+	try {
+		auto courses = catalog.getAll();
+		if (courses.empty()) {
+			logging::info("catalog.import").kv("reason", "empty database").kv("source", "data/courses.json");
+			catalog.importFromJson("data/courses.json");
+			logging::info("catalog.imported").kv("courses", catalog.getAll().size());
+		} else {
+			logging::info("catalog.found").kv("courses", courses.size());
+		}
+	} catch (const std::exception& e) {
+		logging::error("catalog.load_failed").kv("error", e.what()).kv("fallback", "data/courses.json");
+		catalog.importFromJson("data/courses.json");
+		logging::info("catalog.imported").kv("source", "data/courses.json");
+	}
+}
+
 int main() {
 	try {
-		crow::App<crow::CORSHandler> app;
-
-		std::cout << "Starting Course Recommendation Platform..." << std::endl;
-
-		// PostgreSQL connection string
-		std::string connStr = "host=localhost port=5432 dbname=roadmap user=postgres password=admin";
-
-		// Initialize PostgreSQL database
-		std::cout << "Connecting to PostgreSQL..." << std::endl;
-		PostgresCatalog catalog(connStr);
-		PostgresStorage storage(connStr);
-
-		// Import courses from JSON on first run
-		std::cout << "Checking courses in database..." << std::endl;
-		try {
-			auto courses = catalog.getAll();
-			if (courses.empty()) {
-				std::cout << "Database empty, importing from courses.json..." << std::endl;
-				catalog.importFromJson("data/courses.json");
-				std::cout << "Successfully imported " << catalog.getAll().size() << " courses" << std::endl;
-			} else {
-				std::cout << "Found " << courses.size() << " courses in database" << std::endl;
+		crow::App<crow::CORSHandler, RequestMetrics> app;
+
+		// Request logging goes through the async logger (ROADMAP_LOG_LEVEL, ROADMAP_LOG_SAMPLE=N bodies)
+		logging::LoggerOptions logOptions;
+		if (const char* level = std::getenv("ROADMAP_LOG_LEVEL")) {
+			logOptions.level = logging::parseLevel(level);
+		}
+		if (const char* sample = std::getenv("ROADMAP_LOG_SAMPLE")) {
+			logOptions.bodySampleRate = static_cast<std::uint32_t>(std::strtoul(sample, nullptr, 10));
+		}
+		logging::start(logOptions);
+		app.loglevel(crow::LogLevel::Warning);
+
+		logging::info("startup").kv("service", "Course Recommendation Platform");
+
+		// PostgreSQL connection string (ROADMAP_DB_URL accepts a libpq key/value string or URI)
+		std::string connStr = std::getenv("ROADMAP_DB_URL") ? std::getenv("ROADMAP_DB_URL")
+			: "host=localhost port=5432 dbname=roadmap user=postgres password=admin";
+
+		// ROADMAP_STORAGE=memory serves data/courses.json and keeps plans/users in process (no database);
+		// ROADMAP_STORAGE=embedded does the same but persists them under ROADMAP_DATA_DIR
+		std::string backend = std::getenv("ROADMAP_STORAGE") ? std::getenv("ROADMAP_STORAGE") : "postgres";
+		std::shared_ptr<ConnectionPool> dbPool;
+		std::unique_ptr<ICatalog> catalog;
+		PostgresCatalog* postgresCatalog = nullptr;
+		std::unique_ptr<IStorage> storage;
+		EmbeddedStorage* embeddedStorage = nullptr;
+		// ROADMAP_CATALOG_SNAPSHOT=path maps a snapshot built by roadmap_catalog_snapshot instead of
+		// loading the catalog from the database or courses.json
+		const char* catalogSnapshot = std::getenv("ROADMAP_CATALOG_SNAPSHOT");
+		if (backend == "memory") {
+			logging::info("storage.backend").kv("backend", "memory").kv("catalog", catalogSnapshot ? catalogSnapshot : "data/courses.json");
+			storage = std::make_unique<MemoryStorage>();
+		} else if (backend == "embedded") {
+			std::string dataDir = std::getenv("ROADMAP_DATA_DIR") ? std::getenv("ROADMAP_DATA_DIR") : "data/embedded";
+			logging::info("storage.backend").kv("backend", "embedded").kv("dir", dataDir)
+				.kv("catalog", catalogSnapshot ? catalogSnapshot : "data/courses.json");
+			auto embedded = std::make_unique<EmbeddedStorage>(dataDir);
+			embeddedStorage = embedded.get();
+			storage = std::move(embedded);
+		} else {
+			logging::info("db.connect").kv("backend", "postgres");
+			// One bounded pool shared by the catalog and storage, sized for Crow's worker threads
+			std::size_t poolSize = std::max(4u, std::thread::hardware_concurrency());
+			dbPool = std::make_shared<ConnectionPool>(connStr, poolSize);
+			if (!catalogSnapshot) {
+				auto courses = std::make_unique<PostgresCatalog>(dbPool);
+				importCoursesIfEmpty(*courses);
+				postgresCatalog = courses.get();
+				catalog = std::move(courses);
 			}
-		} catch (const std::exception& e) {
-			std::cerr << "Error loading courses: " << e.what() << std::endl;
-			std::cout << "Attempting to import from courses.json..." << std::endl;
-			catalog.importFromJson("data/courses.json");
-			std::cout << "Database initialized from courses.json" << std::endl;
+			storage = std::make_unique<PostgresStorage>(dbPool);
 		}
 
-		GreedyRecommender recommender;
+		// Plans are written behind the request path (ROADMAP_PLAN_DURABILITY=sync|async|async-flush)
+		WriteBehindOptions planWriteOptions;
+		if (const char* durability = std::getenv("ROADMAP_PLAN_DURABILITY")) {
+			planWriteOptions.mode = parseDurabilityMode(durability);
+		}
+		WriteBehindStorage planStore(*storage, planWriteOptions);
+
+		// Batch planning fans profiles out over these workers (and the request thread); the greedy
+		// planner also splits scoring of very large domains over them
+		ThreadPool planPool(std::max(1u, std::thread::hardware_concurrency()));
+
+		// ROADMAP_PLANNER=greedy (default) or knapsack: the best-scoring plan within the hours budget,
+		// searched for up to ROADMAP_PLANNER_BUDGET_MS per plan (default 20) before settling for greedy's
+		std::unique_ptr<IRecommenderStrategy> recommender;
+		KnapsackRecommender* knapsack = nullptr;
+		GreedyRecommender* greedy = nullptr;
+		std::string planner = std::getenv("ROADMAP_PLANNER") ? std::getenv("ROADMAP_PLANNER") : "greedy";
+		if (planner == "knapsack") {
+			KnapsackOptions knapsackOptions;
+			if (const char* budgetMs = std::getenv("ROADMAP_PLANNER_BUDGET_MS")) {
+				knapsackOptions.timeBudget = std::chrono::milliseconds(std::max(1L, std::strtol(budgetMs, nullptr, 10)));
+			}
+			auto strategy = std::make_unique<KnapsackRecommender>(knapsackOptions);
+			knapsack = strategy.get();
+			recommender = std::move(strategy);
+		} else {
+			// ROADMAP_SCORING_THREADS caps the threads one request's scoring may use (default 4, 1 = inline only)
+			ParallelScoringOptions scoringOptions{&planPool};
+			if (const char* threads = std::getenv("ROADMAP_SCORING_THREADS")) {
+				scoringOptions.maxThreads = static_cast<std::size_t>(std::max(1L, std::strtol(threads, nullptr, 10)));
+			}
+			scoringOptions.maxThreads = std::min<std::size_t>(scoringOptions.maxThreads, planPool.size() + 1);
+			auto strategy = std::make_unique<GreedyRecommender>(scoringOptions);
+			greedy = strategy.get();
+			recommender = std::move(strategy);
+		}
+		logging::info("planner").kv("strategy", knapsack ? "knapsack" : "greedy");
 
-	// Cache courses in memory for better performance
-	std::cout << "Loading courses into cache..." << std::endl;
-	auto cachedCourses = catalog.getAll();
-	std::cout << "Cached " << cachedCourses.size() << " courses" << std::endl;
+		// Related domains (recommended for each other, with a score bonus); ROADMAP_DOMAIN_RELATIONS
+		// names a JSON file replacing the built-in pairs. Read before the first catalog version is built.
+		if (const char* relationsPath = std::getenv("ROADMAP_DOMAIN_RELATIONS")) {
+			DomainRelations::configure(DomainRelations::load(relationsPath));
+		}
+		logging::info("domain_relations").kv("pairs", DomainRelations::current().size());
+
+	// Enriched plan bodies for GET /api/plans/<int>; ROADMAP_PLAN_CACHE_LISTEN=1 keeps several
+	// backend instances coherent through Postgres LISTEN/NOTIFY
+	PlanCache planCache(64 * 1024 * 1024);
+	std::unique_ptr<NotificationListener> planChangeListener;
+	if (const char* listen = std::getenv("ROADMAP_PLAN_CACHE_LISTEN"); dbPool && listen && std::string(listen) == "1") {
+		// Invalidations sent while disconnected are lost: start over on every (re)connect
+		planChangeListener = std::make_unique<NotificationListener>(connStr, "plan_changed", [&planCache](const std::string& payload) {
+			planCache.invalidate(std::stoi(payload));
+		}, [&planCache] {
+			planCache.clear();
+		});
+		logging::info("plan_cache.listen").kv("channel", "plan_changed");
+	}
+
+	// Courses indexed in memory (by id, domain, level and tag), published through an RCU-style
+	// holder: handlers take catalogHolder.current() once per request, and reloads build the next
+	// version in the background. A mapped snapshot is used in place.
+	std::uint64_t catalogDbVersion = 0;   // courses table version the live index reflects (holder thread only)
+	CatalogHolder catalogHolder([&]() {
+		if (catalogSnapshot) {
+			return CatalogIndex(CatalogSnapshot::map(catalogSnapshot));
+		}
+		if (postgresCatalog) {
+			return CatalogIndex(postgresCatalog->getAll(catalogDbVersion));
+		}
+		return CatalogIndex(MemoryCatalog("data/courses.json").getAll());
+	});
+	// Plans of canonical profiles (see RecommendationCache::key), with their rendered bodies.
+	// ROADMAP_RECOMMENDATION_CACHE_MB sets the budget (default 64, 0 = off).
+	std::size_t recommendationCacheMb = std::getenv("ROADMAP_RECOMMENDATION_CACHE_MB")
+		? std::strtoul(std::getenv("ROADMAP_RECOMMENDATION_CACHE_MB"), nullptr, 10) : 64;
+	std::unique_ptr<RecommendationCache> recommendationCache;
+	if (recommendationCacheMb > 0) {
+		recommendationCache = std::make_unique<RecommendationCache>(recommendationCacheMb * 1024 * 1024);
+	}
+
+	// Enriched plans embed course details, so they are rebuilt against the new version. Cached
+	// recommendations are keyed by version and could not hit anyway; clearing frees their memory.
+	catalogHolder.onReload([&](const LoadedCatalog&) {
+		planCache.clear();
+		if (recommendationCache) {
+			recommendationCache->clear();
+		}
+	});
+
+	// Plan and enriched body for `profile`: from the recommendation cache when enabled (identical
+	// concurrent profiles are planned once), otherwise computed. `candidates` is the profile's
+	// batch group, if any.
+	auto recommend = [&](const UserProfile& profile, const LoadedCatalog& live, const CandidateSet* candidates,
+	                     bool& cached) -> RecommendationCache::Entry {
+		auto compute = [&] {
+			RecommendationCache::Value value;
+			{
+				metrics::ScopedTimer timer(metrics::phase(metrics::Phase::MakePlan));
+				value.plan = candidates ? recommender->makePlan(profile, live.index, *candidates)
+				                        : recommender->makePlan(profile, live.index);
+			}
+			value.body = renderEnrichedPlan(value.plan, live);
+			return value;
+		};
+		cached = false;
+		if (!recommendationCache) {
+			return std::make_shared<const RecommendationCache::Value>(compute());
+		}
+		return recommendationCache->getOrCompute(RecommendationCache::key(live.version, profile), compute, &cached);
+	};
+
+	// Catalog deltas committed to Postgres (by any instance) are applied to the live index as
+	// a patch: only rows changed since catalogDbVersion are read. Requests arriving while one
+	// catch-up is queued are served by it.
+	std::atomic<bool> catalogCatchUpQueued{false};
+	auto queueCatalogCatchUp = [&](const std::string& reason) {
+		if (!postgresCatalog || catalogCatchUpQueued.exchange(true)) {
+			return;
+		}
+		catalogHolder.requestPatch(reason, [&](const CatalogIndex& base) -> std::optional<CatalogIndex> {
+			catalogCatchUpQueued = false;
+			CatalogChangeSet changes = postgresCatalog->changesSince(catalogDbVersion);
+			if (changes.delta.empty()) {
+				catalogDbVersion = std::max(catalogDbVersion, changes.version);
+				return std::nullopt;
+			}
+			CatalogIndex next = base.apply(changes.delta);
+			logging::info("catalog.caught_up").kv("from", catalogDbVersion).kv("to", changes.version)
+				.kv("upserts", changes.delta.upserts.size()).kv("removals", changes.delta.removals.size());
+			catalogDbVersion = changes.version;
+			return next;
+		});
+	};
+
+	// Reload triggers besides the admin endpoint: the catalog file changing on disk, or
+	// NOTIFY courses_changed (trigger on `courses`). ROADMAP_CATALOG_WATCH_MS=0 turns both off.
+	long watchMs = std::getenv("ROADMAP_CATALOG_WATCH_MS") ? std::strtol(std::getenv("ROADMAP_CATALOG_WATCH_MS"), nullptr, 10) : 2000;
+	std::unique_ptr<NotificationListener> catalogListener;
+	if (watchMs > 0 && catalogSnapshot) {
+		catalogHolder.watchFile(catalogSnapshot, std::chrono::milliseconds(watchMs));
+	} else if (watchMs > 0 && !catalog) {
+		catalogHolder.watchFile("data/courses.json", std::chrono::milliseconds(watchMs));
+	} else if (watchMs > 0 && postgresCatalog) {
+		catalogListener = std::make_unique<NotificationListener>(connStr, "courses_changed", [&](const std::string&) {
+			queueCatalogCatchUp("courses_changed");
+		}, [&] {
+			queueCatalogCatchUp("listen_connected");
+		});
+		logging::info("catalog.listen").kv("channel", "courses_changed");
+	}
+
+	// POST /api/admin/catalog/reload is enabled by ROADMAP_ADMIN_TOKEN (sent as "Authorization: Bearer <token>")
+	const std::string adminToken = std::getenv("ROADMAP_ADMIN_TOKEN") ? std::getenv("ROADMAP_ADMIN_TOKEN") : "";
 
 	// Define HTTP method constants to avoid macro conflicts
 	constexpr auto HTTP_GET = crow::HTTPMethod::Get;
@@ -83,100 +348,310 @@ int main() {
 		.headers("Content-Type", "Authorization")
 		.allow_credentials();
 
-	std::cout << "CORS enabled for: http://localhost:3000" << std::endl;
+	logging::info("cors").kv("origin", "http://localhost:3000");
+
+	// Per-route latency and status counters (RequestMetrics middleware), served at /api/metrics
+	auto& requestMetrics = app.get_middleware<RequestMetrics>();
+	requestMetrics.track(HTTP_GET, "/api/courses");
+	requestMetrics.track(HTTP_GET, "/api/tags");
+	requestMetrics.track(HTTP_POST, "/api/recommendations");
+	requestMetrics.track(HTTP_POST, "/api/recommendations/batch");
+	requestMetrics.track(HTTP_GET, "/api/plans/<int>");
+	requestMetrics.track(HTTP_POST, "/api/plans/<int>");
+	requestMetrics.track(HTTP_DELETE, "/api/plans/<int>");
+	requestMetrics.track(HTTP_POST, "/api/auth/register");
+	requestMetrics.track(HTTP_POST, "/api/auth/login");
+	requestMetrics.track(HTTP_GET, "/api/auth/me");
+	requestMetrics.track(HTTP_GET, "/api/health");
+	requestMetrics.track(HTTP_GET, "/api/metrics");
+	requestMetrics.track(HTTP_POST, "/api/admin/catalog/reload");
+	requestMetrics.track(HTTP_POST, "/api/admin/catalog/delta");
+
+	metrics::Registry& registry = metrics::registry();
+	registry.gauge("roadmap_catalog_courses", "Courses in the in-memory catalog index", "",
+		[&] { return static_cast<double>(catalogHolder.current()->index.size()); });
+	registry.gauge("roadmap_catalog_version", "Catalog version being served (1 = loaded at startup)", "",
+		[&] { return static_cast<double>(catalogHolder.stats().version); });
+	registry.counterFunction("roadmap_catalog_reloads_total", "Catalog reloads and delta patches", "result=\"ok\"",
+		[&] { return static_cast<double>(catalogHolder.stats().reloads); });
+	registry.counterFunction("roadmap_catalog_reloads_total", "Catalog reloads and delta patches", "result=\"patched\"",
+		[&] { return static_cast<double>(catalogHolder.stats().patches); });
+	registry.counterFunction("roadmap_catalog_reloads_total", "Catalog reloads and delta patches", "result=\"failed\"",
+		[&] { return static_cast<double>(catalogHolder.stats().failures); });
+	if (greedy) {
+		registry.counterFunction("roadmap_scoring_runs_total", "Greedy candidate scorings by where they ran", "mode=\"inline\"",
+			[greedy] { return static_cast<double>(greedy->stats().inlineScorings); });
+		registry.counterFunction("roadmap_scoring_runs_total", "Greedy candidate scorings by where they ran", "mode=\"parallel\"",
+			[greedy] { return static_cast<double>(greedy->stats().parallelScorings); });
+		registry.gauge("roadmap_scoring_ns_per_candidate", "Measured scoring cost per candidate (moving average)", "",
+			[greedy] { return greedy->stats().nsPerCandidate; });
+	}
+	if (knapsack) {
+		registry.counterFunction("roadmap_planner_searches_total", "Knapsack plan searches", "result=\"optimal\"",
+			[knapsack] { return static_cast<double>(knapsack->stats().optimal); });
+		registry.counterFunction("roadmap_planner_searches_total", "Knapsack plan searches", "result=\"cut_off\"",
+			[knapsack] { return static_cast<double>(knapsack->stats().cutOff); });
+		registry.counterFunction("roadmap_planner_improved_total", "Knapsack plans scoring above the greedy plan", "",
+			[knapsack] { return static_cast<double>(knapsack->stats().improved); });
+	}
+	registry.gauge("roadmap_plan_cache_entries", "Plans held by the plan cache", "",
+		[&] { return static_cast<double>(planCache.stats().entries); });
+	registry.gauge("roadmap_plan_cache_bytes", "Bytes held by the plan cache", "",
+		[&] { return static_cast<double>(planCache.stats().bytes); });
+	registry.counterFunction("roadmap_plan_cache_lookups_total", "Plan cache lookups", "result=\"hit\"",
+		[&] { return static_cast<double>(planCache.stats().hits); });
+	registry.counterFunction("roadmap_plan_cache_lookups_total", "Plan cache lookups", "result=\"miss\"",
+		[&] { return static_cast<double>(planCache.stats().misses); });
+	registry.counterFunction("roadmap_plan_cache_evictions_total", "Plan cache LRU evictions", "",
+		[&] { return static_cast<double>(planCache.stats().evictions); });
+	registry.counterFunction("roadmap_plan_cache_stale_fills_total", "Plan cache fills dropped because the plan changed meanwhile", "",
+		[&] { return static_cast<double>(planCache.stats().staleFills); });
+	if (recommendationCache) {
+		registry.gauge("roadmap_recommendation_cache_entries", "Plans held by the recommendation cache", "",
+			[&] { return static_cast<double>(recommendationCache->stats().entries); });
+		registry.gauge("roadmap_recommendation_cache_bytes", "Bytes held by the recommendation cache", "",
+			[&] { return static_cast<double>(recommendationCache->stats().bytes); });
+		registry.counterFunction("roadmap_recommendation_cache_lookups_total", "Recommendation cache lookups", "result=\"hit\"",
+			[&] { return static_cast<double>(recommendationCache->stats().hits); });
+		registry.counterFunction("roadmap_recommendation_cache_lookups_total", "Recommendation cache lookups", "result=\"coalesced\"",
+			[&] { return static_cast<double>(recommendationCache->stats().coalesced); });
+		registry.counterFunction("roadmap_recommendation_cache_lookups_total", "Recommendation cache lookups", "result=\"miss\"",
+			[&] { return static_cast<double>(recommendationCache->stats().misses); });
+		registry.counterFunction("roadmap_recommendation_cache_rejected_total", "Computed plans refused by TinyLFU admission", "",
+			[&] { return static_cast<double>(recommendationCache->stats().rejected); });
+		registry.counterFunction("roadmap_recommendation_cache_evictions_total", "Recommendation cache LRU evictions", "",
+			[&] { return static_cast<double>(recommendationCache->stats().evictions); });
+		registry.counterFunction("roadmap_recommendation_cache_compute_seconds_total", "Time spent planning and rendering cache misses", "",
+			[&] { return recommendationCache->stats().computeNs / 1e9; });
+		registry.counterFunction("roadmap_recommendation_cache_saved_seconds_total", "Planning and rendering time saved by hits and coalesced requests", "",
+			[&] { return recommendationCache->stats().savedNs / 1e9; });
+	}
+	if (dbPool) {
+		registry.gauge("roadmap_db_pool_connections", "Database pool connections", "state=\"open\"",
+			[&] { return static_cast<double>(dbPool->stats().open); });
+		registry.gauge("roadmap_db_pool_connections", "Database pool connections", "state=\"in_use\"",
+			[&] { return static_cast<double>(dbPool->stats().inUse); });
+		registry.gauge("roadmap_db_pool_connections", "Database pool connections", "state=\"capacity\"",
+			[&] { return static_cast<double>(dbPool->stats().capacity); });
+		registry.gauge("roadmap_db_pool_waiting", "Threads blocked waiting for a connection", "",
+			[&] { return static_cast<double>(dbPool->stats().waiting); });
+		registry.counterFunction("roadmap_db_pool_timeouts_total", "Connection acquisitions that timed out", "",
+			[&] { return static_cast<double>(dbPool->stats().timeouts); });
+		registry.counterFunction("roadmap_db_pool_wait_seconds_total", "Time spent waiting for a connection", "",
+			[&] { return dbPool->stats().totalWaitMs / 1000.0; });
+	}
+	if (embeddedStorage) {
+		registry.gauge("roadmap_embedded_log_segment_bytes", "Bytes used in the current log segment", "",
+			[&] { return static_cast<double>(embeddedStorage->stats().segmentBytes); });
+		registry.counterFunction("roadmap_embedded_log_records_total", "Records appended to the storage log", "",
+			[&] { return static_cast<double>(embeddedStorage->stats().appended); });
+		registry.counterFunction("roadmap_embedded_snapshots_total", "Storage snapshots written", "",
+			[&] { return static_cast<double>(embeddedStorage->stats().snapshots); });
+		registry.gauge("roadmap_embedded_last_snapshot_seconds", "Duration of the last storage snapshot", "",
+			[&] { return embeddedStorage->stats().lastSnapshotMs / 1000.0; });
+	}
+	registry.gauge("roadmap_write_behind_queue_depth", "Plans pending or being flushed", "",
+		[&] { return static_cast<double>(planStore.stats().queueDepth); });
+	registry.counterFunction("roadmap_write_behind_plans_total", "Plans by write-behind outcome", "outcome=\"written\"",
+		[&] { return static_cast<double>(planStore.stats().written); });
+	registry.counterFunction("roadmap_write_behind_plans_total", "Plans by write-behind outcome", "outcome=\"coalesced\"",
+		[&] { return static_cast<double>(planStore.stats().coalesced); });
+	registry.counterFunction("roadmap_write_behind_plans_total", "Plans by write-behind outcome", "outcome=\"dropped\"",
+		[&] { return static_cast<double>(planStore.stats().dropped); });
+	registry.counterFunction("roadmap_write_behind_plans_total", "Plans by write-behind outcome", "outcome=\"sync_fallback\"",
+		[&] { return static_cast<double>(planStore.stats().syncFallbacks); });
+	registry.counterFunction("roadmap_write_behind_bulk_writes_total", "Plan batches written through in one storage call", "",
+		[&] { return static_cast<double>(planStore.stats().bulkWrites); });
+	registry.counterFunction("roadmap_write_behind_flushes_total", "Flusher passes over the pending plans", "",
+		[&] { return static_cast<double>(planStore.stats().flushes); });
+	registry.counterFunction("roadmap_write_behind_failed_batches_total", "Flush batches retried plan by plan", "",
+		[&] { return static_cast<double>(planStore.stats().failedBatches); });
+	registry.counterFunction("roadmap_write_behind_flush_seconds_total", "Time spent writing flushed plans", "",
+		[&] { return planStore.stats().totalFlushMs / 1000.0; });
+	registry.gauge("roadmap_write_behind_last_flush_seconds", "Duration of the last flush", "",
+		[&] { return planStore.stats().lastFlushMs / 1000.0; });
+	registry.gauge("roadmap_write_behind_max_flush_seconds", "Longest flush since startup", "",
+		[&] { return planStore.stats().maxFlushMs / 1000.0; });
+	registry.counterFunction("roadmap_log_records_dropped_total", "Log records dropped because a ring was full", "",
+		[] { return static_cast<double>(logging::stats().dropped); });
 
 	// GET all courses
 	CROW_ROUTE(app, "/api/courses").methods(HTTP_GET)
-		([&]() {
-			std::cout << "\n[REQUEST] GET /api/courses" << std::endl;
-			json response = coursesToJson(cachedCourses);
-			std::string responseStr = response.dump();
-			std::cout << "[RESPONSE] 200 OK - " << cachedCourses.size() << " courses, "
-			          << responseStr.length() << " bytes" << std::endl;
-			std::cout << "[SAMPLE] " << responseStr.substr(0, 200) << "..." << std::endl;
-
-			crow::response res(200, responseStr);
-			res.set_header("Content-Type", "application/json");
-			res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
-			res.set_header("Access-Control-Allow-Credentials", "true");
+		([&](const crow::request& req) {
+			crow::response res = servePrerendered(req, catalogHolder.current()->coursesBody.get());
+			logging::info("request").kv("route", "GET /api/courses").kv("status", res.code)
+				.kv("bytes", res.body.length());
 			return res;
 		});
 
 	// GET all unique tags from courses
 	CROW_ROUTE(app, "/api/tags").methods(HTTP_GET)
-		([&]() {
-			std::cout << "\n[REQUEST] GET /api/tags" << std::endl;
-			std::set<std::string> uniqueTags;
-			for (const auto& course : cachedCourses) {
-				const auto& tags = course.getTags();
-				uniqueTags.insert(tags.begin(), tags.end());
-			}
-			json tagsArray = json::array();
-			for (const auto& tag : uniqueTags) {
-				tagsArray.push_back(tag);
-			}
-			std::string responseStr = tagsArray.dump();
-			std::cout << "[RESPONSE] 200 OK - " << uniqueTags.size() << " unique tags" << std::endl;
-			std::cout << "[SAMPLE] " << responseStr.substr(0, 200) << "..." << std::endl;
-
-			crow::response res(200, responseStr);
-			res.set_header("Content-Type", "application/json");
-			res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
-			res.set_header("Access-Control-Allow-Credentials", "true");
+		([&](const crow::request& req) {
+			crow::response res = servePrerendered(req, catalogHolder.current()->tagsBody.get());
+			logging::info("request").kv("route", "GET /api/tags").kv("status", res.code)
+				.kv("bytes", res.body.length());
 			return res;
 		});
 
 	// POST recommendation request
 	CROW_ROUTE(app, "/api/recommendations").methods(HTTP_POST)
 		([&](const crow::request& req) {
-			std::cout << "\n[REQUEST] POST /api/recommendations" << std::endl;
-			std::cout << "[BODY] " << req.body.substr(0, 500) << std::endl;
+			if (logging::sampleBody()) {
+				logging::info("request.body").kv("route", "POST /api/recommendations")
+					.kv("body", std::string_view(req.body).substr(0, 500));
+			}
+			try {
+				UserProfile profile = decodeBody([&] { return decodeRecommendationRequest(req.body); });
+				auto live = catalogHolder.current();
+				bool cached = false;
+				RecommendationCache::Entry recommendation = recommend(profile, *live, nullptr, cached);
+				const Plan& plan = recommendation->plan;
+				PlanCache::Write cacheWrite(planCache, profile.getUserId());
+				planStore.savePlan(profile.getUserId(), plan);
+
+				// Plan enriched with full course details; the same body serves later GETs from the cache
+				const std::string& responseStr = recommendation->body;
+				if (live == catalogHolder.current()) {
+					cacheWrite.commit(responseStr);
+				}
+				logging::info("request").kv("route", "POST /api/recommendations").kv("status", 200)
+					.kv("user", profile.getUserId()).kv("domain", profile.getTargetDomain())
+					.kv("level", profile.getCurrentLevel()).kv("steps", plan.getSteps().size())
+					.kv("hours", plan.getTotalHours()).kv("bytes", responseStr.length()).kv("cached", cached);
+				crow::response res(200, responseStr);
+				res.set_header("Content-Type", "application/json");
+				res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
+				res.set_header("Access-Control-Allow-Credentials", "true");
+				return res;
+			} catch (const std::exception& e) {
+				logging::warn("request").kv("route", "POST /api/recommendations").kv("status", 400)
+					.kv("error", e.what());
+				json error = {{"error", e.what()}};
+				crow::response res(400, error.dump());
+				res.set_header("Content-Type", "application/json");
+				res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
+				return res;
+			}
+		});
+
+	// POST a cohort of profiles: one plan each, as NDJSON lines in request order
+	CROW_ROUTE(app, "/api/recommendations/batch").methods(HTTP_POST)
+		([&](const crow::request& req) {
+			auto start = std::chrono::steady_clock::now();
 			try {
-				auto data = json::parse(req.body);
-				UserProfile profile = jsonToProfile(data["profile"]);
-				std::cout << "[PROFILE] User " << profile.getUserId()
-				          << ", Domain: " << profile.getTargetDomain()
-				          << ", Level: " << profile.getCurrentLevel() << std::endl;
-				auto plan = recommender.makePlan(profile, cachedCourses);
-				std::cout << "[PLAN] Generated " << plan.getSteps().size()
-				          << " steps, " << plan.getTotalHours() << " hours" << std::endl;
-				storage.savePlan(profile.getUserId(), plan);
-
-				// Enrich plan with full course details
-				json enrichedPlan;
-				enrichedPlan["totalHours"] = plan.getTotalHours();
-				json stepsArray = json::array();
-
-				for (const auto& step : plan.getSteps()) {
-					json stepJson;
-					stepJson["step"] = step.step;
-					stepJson["courseId"] = step.courseId;
-					stepJson["hours"] = step.hours;
-					stepJson["note"] = step.note;
-
-					// Find and add full course details
-					for (const auto& course : cachedCourses) {
-						if (course.getId() == step.courseId) {
-							stepJson["courseTitle"] = course.getTitle();
-							stepJson["courseDomain"] = course.getDomain();
-							stepJson["courseLevel"] = course.getLevel();
-							stepJson["courseTags"] = course.getTags();
-							break;
+				auto data = parseBody(req.body);
+				const json& entries = data.at("profiles");
+				if (!entries.is_array() || entries.size() > MaxBatchProfiles) {
+					throw std::runtime_error("profiles must be an array of at most " + std::to_string(MaxBatchProfiles) + " profiles");
+				}
+				const std::size_t count = entries.size();
+
+				// Profiles that do not parse get an error line; the rest are grouped by target
+				// domain and level, whose candidate courses and base scores are computed once
+				std::vector<std::optional<UserProfile>> profiles(count);
+				std::vector<std::string> lines(count);
+				std::vector<std::size_t> groupOf(count, 0);
+				std::map<std::pair<std::string, std::string>, std::size_t> groupIds;
+				std::vector<CandidateSet> groups;
+				for (std::size_t i = 0; i < count; ++i) {
+					try {
+						profiles[i] = jsonToProfile(entries[i]);
+					} catch (const std::exception& e) {
+						lines[i] = json{{"index", i}, {"error", e.what()}}.dump();
+						continue;
+					}
+					auto key = std::make_pair(profiles[i]->getTargetDomain(), profiles[i]->getCurrentLevel());
+					auto [it, added] = groupIds.emplace(key, groups.size());
+					if (added) {
+						groups.emplace_back();
+						groups.back().targetDomain = key.first;
+						groups.back().level = key.second;
+					}
+					groupOf[i] = it->second;
+				}
+
+				auto live = catalogHolder.current();
+				planPool.forEach(groups.size(), [&](std::size_t g) {
+					groups[g].assign(live->index, groups[g].targetDomain, groups[g].level);
+				});
+				std::vector<PlanWrite> writes(count);
+				planPool.forEach(count, [&](std::size_t i) {
+					if (!profiles[i]) {
+						return;
+					}
+					bool cached = false;
+					RecommendationCache::Entry recommendation = recommend(*profiles[i], *live, &groups[groupOf[i]], cached);
+					writes[i].plan = recommendation->plan;
+					writes[i].userId = profiles[i]->getUserId();
+					lines[i] = recommendation->body;
+				});
+
+				// One storage write for the whole cohort
+				std::size_t planned = 0;
+				for (std::size_t i = 0; i < count; ++i) {
+					if (profiles[i]) {
+						writes[planned++] = std::move(writes[i]);
+					}
+				}
+				writes.resize(planned);
+				std::vector<PlanCache::Write> cacheWrites;
+				cacheWrites.reserve(planned);
+				for (const auto& write : writes) {
+					cacheWrites.emplace_back(planCache, write.userId);
+				}
+				// One bad plan (e.g. unknown user) must not sink the cohort: retry one by one and
+				// report the plans that still fail on their own lines
+				std::vector<std::optional<std::string>> saveErrors(planned);
+				std::size_t saveFailures = 0;
+				try {
+					planStore.savePlans(writes);
+				} catch (const std::exception& e) {
+					logging::warn("batch.save_failed").kv("plans", planned).kv("error", e.what());
+					for (std::size_t w = 0; w < planned; ++w) {
+						try {
+							planStore.savePlan(writes[w].userId, writes[w].plan);
+						} catch (const std::exception& single) {
+							logging::error("batch.plan_dropped").kv("user", writes[w].userId).kv("error", single.what());
+							saveErrors[w] = single.what();
+							++saveFailures;
 						}
 					}
-					stepsArray.push_back(stepJson);
 				}
-				enrichedPlan["steps"] = stepsArray;
 
-				std::string responseStr = enrichedPlan.dump();
-				std::cout << "[RESPONSE] 200 OK - " << responseStr.length() << " bytes (enriched)" << std::endl;
-				crow::response res(200, responseStr);
-				res.set_header("Content-Type", "application/json");
+				bool cacheable = live == catalogHolder.current();
+				std::string body;
+				std::size_t written = 0;
+				for (std::size_t i = 0; i < count; ++i) {
+					if (profiles[i]) {
+						std::size_t w = written++;
+						if (saveErrors[w]) {
+							body += json{{"index", i}, {"error", *saveErrors[w]}}.dump();
+							body += '\n';
+							continue;
+						}
+						int userId = profiles[i]->getUserId();
+						if (cacheable) {
+							cacheWrites[w].commit(lines[i]);
+						}
+						body += "{\"index\":" + std::to_string(i) + ",\"userId\":" + std::to_string(userId) + ",\"plan\":";
+						body += lines[i];
+						body += "}\n";
+					} else {
+						body += lines[i];
+						body += '\n';
+					}
+				}
+				logging::info("request").kv("route", "POST /api/recommendations/batch").kv("status", 200)
+					.kv("profiles", count).kv("groups", groups.size()).kv("failed", count - planned + saveFailures).kv("bytes", body.size())
+					.kv("ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				crow::response res(200, body);
+				res.set_header("Content-Type", "application/x-ndjson");
 				res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
 				res.set_header("Access-Control-Allow-Credentials", "true");
 				return res;
 			} catch (const std::exception& e) {
-				std::cerr << "[ERROR] " << e.what() << std::endl;
+				logging::warn("request").kv("route", "POST /api/recommendations/batch").kv("status", 400)
+					.kv("error", e.what());
 				json error = {{"error", e.what()}};
 				crow::response res(400, error.dump());
 				res.set_header("Content-Type", "application/json");
@@ -188,48 +663,33 @@ int main() {
 	// GET plan by userId
 	CROW_ROUTE(app, "/api/plans/<int>").methods(HTTP_GET)
 		([&](int userId) {
-			std::cout << "\n[REQUEST] GET /api/plans/" << userId << std::endl;
-			auto plan = storage.loadPlan(userId);
-			if (plan.has_value()) {
-				std::cout << "[PLAN] Found plan with " << plan.value().getSteps().size()
-				          << " steps, " << plan.value().getTotalHours() << " hours" << std::endl;
-
-				// Enrich plan with full course details (same as POST /recommendations)
-				json enrichedPlan;
-				enrichedPlan["totalHours"] = plan.value().getTotalHours();
-				json stepsArray = json::array();
-
-				for (const auto& step : plan.value().getSteps()) {
-					json stepJson;
-					stepJson["step"] = step.step;
-					stepJson["courseId"] = step.courseId;
-					stepJson["hours"] = step.hours;
-					stepJson["note"] = step.note;
-
-					// Find and add full course details
-					for (const auto& course : cachedCourses) {
-						if (course.getId() == step.courseId) {
-							stepJson["courseTitle"] = course.getTitle();
-							stepJson["courseDomain"] = course.getDomain();
-							stepJson["courseLevel"] = course.getLevel();
-							stepJson["courseTags"] = course.getTags();
-							break;
-						}
+			// Read-through: the fill is dropped if the plan was written or invalidated meanwhile
+			PlanCache::Body body = planCache.get(userId);
+			bool cacheHit = body != nullptr;
+			if (!cacheHit) {
+				PlanCache::Token token = planCache.token(userId);
+				auto plan = planStore.loadPlan(userId);
+				if (plan.has_value()) {
+					// Enrich plan with full course details (same as POST /recommendations)
+					auto live = catalogHolder.current();
+					body = std::make_shared<const std::string>(renderEnrichedPlan(plan.value(), *live));
+					if (live == catalogHolder.current()) {
+						planCache.putIfUnchanged(userId, token, *body);
 					}
-					stepsArray.push_back(stepJson);
 				}
-				enrichedPlan["steps"] = stepsArray;
+			}
 
-				std::string responseStr = enrichedPlan.dump();
-				std::cout << "[RESPONSE] 200 OK - " << responseStr.length() << " bytes (enriched)" << std::endl;
+			if (body) {
+				logging::info("request").kv("route", "GET /api/plans").kv("status", 200).kv("user", userId)
+					.kv("bytes", body->length()).kv("cached", cacheHit);
 
-				crow::response res(200, responseStr);
+				crow::response res(200, *body);
 				res.set_header("Content-Type", "application/json");
 				res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
 				res.set_header("Access-Control-Allow-Credentials", "true");
 				return res;
 			} else {
-				std::cout << "[RESPONSE] 404 Not Found - No plan for user " << userId << std::endl;
+				logging::info("request").kv("route", "GET /api/plans").kv("status", 404).kv("user", userId);
 				json error = {{"error", "Plan not found"}};
 				crow::response res(404, error.dump());
 				res.set_header("Content-Type", "application/json");
@@ -242,23 +702,9 @@ int main() {
 	CROW_ROUTE(app, "/api/plans/<int>").methods(HTTP_POST)
 		([&](const crow::request& req, int userId) {
 			try {
-				auto data = json::parse(req.body);
-				Plan plan;
-				std::vector<PlanStep> steps;
-
-				for (const auto& stepJson : data["steps"]) {
-					PlanStep step;
-					step.step = stepJson["step"];
-					step.courseId = stepJson["courseId"];
-					step.hours = stepJson["hours"];
-					step.note = stepJson["note"];
-					steps.push_back(step);
-				}
-
-				plan.setSteps(steps);
-				plan.setTotalHours(data["totalHours"]);
-
-				storage.savePlan(userId, plan);
+				Plan plan = decodeBody([&] { return decodePlan(req.body); });
+				PlanCache::Write cacheWrite(planCache, userId);
+				planStore.savePlan(userId, plan);
 				json response = {{"status", "ok"}};
 				return crow::response(200, response.dump());
 			} catch (const std::exception& e) {
@@ -270,6 +716,7 @@ int main() {
 	// DELETE plan
 	CROW_ROUTE(app, "/api/plans/<int>").methods(HTTP_DELETE)
 		([&](int userId) {
+			planCache.invalidate(userId);
 			std::string filename = "data/plans/plan_" + std::to_string(userId) + ".json";
 			if (std::remove(filename.c_str()) == 0) {
 				json response = {{"status", "deleted"}};
@@ -283,16 +730,11 @@ int main() {
 	// Auth endpoints
 	CROW_ROUTE(app, "/api/auth/register").methods(HTTP_POST)
 		([&](const crow::request& req) {
-			std::cout << "\n[REQUEST] POST /api/auth/register" << std::endl;
 			try {
-				auto data = json::parse(req.body);
-				std::string username = data["username"];
-				std::string email = data["email"];
-				std::string password = data["password"];
-				std::cout << "[AUTH] Registering user: " << username << " (" << email << ")" << std::endl;
+				auto [username, email, password] = decodeBody([&] { return decodeCredentials(req.body, true); });
 
 				// Simple auth - store in database
-				storage.saveUser(username, email, password);
+				storage->saveUser(username, email, password);
 
 				json response = {
 					{"success", true},
@@ -300,14 +742,16 @@ int main() {
 					{"token", username} // Simple token for demo
 				};
 				std::string responseStr = response.dump();
-				std::cout << "[RESPONSE] 200 OK - User registered" << std::endl;
+				logging::info("request").kv("route", "POST /api/auth/register").kv("status", 200)
+					.kv("username", username);
 				crow::response res(200, responseStr);
 				res.set_header("Content-Type", "application/json");
 				res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
 				res.set_header("Access-Control-Allow-Credentials", "true");
 				return res;
 			} catch (const std::exception& e) {
-				std::cerr << "[ERROR] Registration failed: " << e.what() << std::endl;
+				logging::warn("request").kv("route", "POST /api/auth/register").kv("status", 400)
+					.kv("error", e.what());
 				json error = {{"error", e.what()}};
 				crow::response res(400, error.dump());
 				res.set_header("Content-Type", "application/json");
@@ -318,15 +762,13 @@ int main() {
 
 	CROW_ROUTE(app, "/api/auth/login").methods(HTTP_POST)
 		([&](const crow::request& req) {
-			std::cout << "\n[REQUEST] POST /api/auth/login" << std::endl;
 			try {
-				auto data = json::parse(req.body);
-				std::string username = data["username"];
-				std::string password = data["password"];
-				std::cout << "[AUTH] Login attempt for user: " << username << std::endl;
+				auto credentials = decodeBody([&] { return decodeCredentials(req.body, false); });
+				const std::string& username = credentials.username;
+				const std::string& password = credentials.password;
 
 				// Simple auth - validate from database
-				bool valid = storage.validateUser(username, password);
+				bool valid = storage->validateUser(username, password);
 
 				if (valid) {
 					json response = {
@@ -335,14 +777,16 @@ int main() {
 						{"token", username}
 					};
 					std::string responseStr = response.dump();
-					std::cout << "[RESPONSE] 200 OK - Login successful" << std::endl;
+					logging::info("request").kv("route", "POST /api/auth/login").kv("status", 200)
+						.kv("username", username);
 					crow::response res(200, responseStr);
 					res.set_header("Content-Type", "application/json");
 					res.set_header("Access-Control-Allow-Origin", "http://localhost:3000");
 					res.set_header("Access-Control-Allow-Credentials", "true");
 					return res;
 				} else {
-					std::cout << "[RESPONSE] 401 Unauthorized - Invalid credentials" << std::endl;
+					logging::info("request").kv("route", "POST /api/auth/login").kv("status", 401)
+						.kv("username", username);
 					json error = {{"error", "Invalid credentials"}};
 					crow::response res(401, error.dump());
 					res.set_header("Content-Type", "application/json");
@@ -350,7 +794,8 @@ int main() {
 					return res;
 				}
 			} catch (const std::exception& e) {
-				std::cerr << "[ERROR] Login failed: " << e.what() << std::endl;
+				logging::warn("request").kv("route", "POST /api/auth/login").kv("status", 400)
+					.kv("error", e.what());
 				json error = {{"error", e.what()}};
 				crow::response res(400, error.dump());
 				res.set_header("Content-Type", "application/json");
@@ -369,7 +814,7 @@ int main() {
 
 			// Simple validation
 			std::string username = token.substr(token.find(" ") + 1);
-			auto user = storage.getUser(username);
+			auto user = storage->getUser(username);
 
 			if (user.has_value()) {
 				return crow::response(200, user.value().dump());
@@ -379,24 +824,93 @@ int main() {
 			}
 		});
 
+	// Prometheus scrape endpoint
+	CROW_ROUTE(app, "/api/metrics").methods(HTTP_GET)
+		([]() {
+			crow::response res(200, metrics::registry().render());
+			res.set_header("Content-Type", "text/plain; version=0.0.4");
+			return res;
+		});
+
+	// Admin: full catalog reload
+	CROW_ROUTE(app, "/api/admin/catalog/reload").methods(HTTP_POST)
+		([&](const crow::request& req) {
+			if (adminToken.empty() || req.get_header_value("Authorization") != "Bearer " + adminToken) {
+				logging::warn("request").kv("route", "POST /api/admin/catalog/reload").kv("status", 403);
+				json error = {{"error", "Forbidden"}};
+				return crow::response(403, error.dump());
+			}
+			catalogHolder.requestReload("admin");
+			std::uint64_t version = catalogHolder.stats().version;
+			logging::info("request").kv("route", "POST /api/admin/catalog/reload").kv("status", 202)
+				.kv("serving_version", version);
+			json response = {{"status", "reloading"}, {"version", version}};
+			return crow::response(202, response.dump());
+		});
+
+	// Admin: catalog delta {"upsert": [course, ...], "remove": [id, ...]}. With the PostgreSQL
+	// catalog it is committed there (a new catalog version, picked up by every instance);
+	// otherwise it patches this instance's catalog in memory until the next full reload.
+	CROW_ROUTE(app, "/api/admin/catalog/delta").methods(HTTP_POST)
+		([&](const crow::request& req) {
+			if (adminToken.empty() || req.get_header_value("Authorization") != "Bearer " + adminToken) {
+				logging::warn("request").kv("route", "POST /api/admin/catalog/delta").kv("status", 403);
+				json error = {{"error", "Forbidden"}};
+				return crow::response(403, error.dump());
+			}
+			CatalogDelta delta;
+			try {
+				auto data = parseBody(req.body);
+				for (const auto& course : data.value("upsert", json::array())) {
+					delta.upserts.push_back(jsonToCourse(course));
+				}
+				delta.removals = data.value("remove", std::vector<int>{});
+			} catch (const std::exception& e) {
+				logging::warn("request").kv("route", "POST /api/admin/catalog/delta").kv("status", 400).kv("error", e.what());
+				json error = {{"error", e.what()}};
+				return crow::response(400, error.dump());
+			}
+
+			json response = {{"status", "accepted"}, {"upserts", delta.upserts.size()}, {"removals", delta.removals.size()}};
+			if (postgresCatalog) {
+				try {
+					response["catalogVersion"] = postgresCatalog->applyDelta(delta);
+				} catch (const std::exception& e) {
+					logging::error("request").kv("route", "POST /api/admin/catalog/delta").kv("status", 500).kv("error", e.what());
+					json error = {{"error", "Failed to apply catalog delta"}};
+					return crow::response(500, error.dump());
+				}
+				queueCatalogCatchUp("delta");
+			} else {
+				catalogHolder.requestPatch("delta", [delta = std::move(delta)](const CatalogIndex& base) {
+					return std::optional<CatalogIndex>(base.apply(delta));
+				});
+			}
+			logging::info("request").kv("route", "POST /api/admin/catalog/delta").kv("status", 202)
+				.kv("upserts", response["upserts"].get<std::size_t>()).kv("removals", response["removals"].get<std::size_t>());
+			return crow::response(202, response.dump());
+		});
+
 	// Health check
 	CROW_ROUTE(app, "/api/health").methods(HTTP_GET)
 		([]() {
-			std::cout << "\n[REQUEST] GET /api/health" << std::endl;
 			json response = {{"status", "ok"}, {"version", "1.0"}};
-			std::cout << "[RESPONSE] 200 OK - Health check passed" << std::endl;
+			logging::debug("request").kv("route", "GET /api/health").kv("status", 200);
 			return crow::response(200, response.dump());
 		});
 
-		std::cout << "Server starting on port 8080..." << std::endl;
+		logging::info("listen").kv("port", 8080);
 		app.port(8080).multithreaded().run();
+		logging::stop();
 
 	} catch (const std::exception& e) {
+		logging::stop();
 		std::cerr << "FATAL ERROR: " << e.what() << std::endl;
 		std::cerr << "Press Enter to exit..." << std::endl;
 		std::cin.get();
 		return 1;
 	} catch (...) {
+		logging::stop();
 		std::cerr << "FATAL ERROR: Unknown exception" << std::endl;
 		std::cerr << "Press Enter to exit..." << std::endl;
 		std::cin.get();
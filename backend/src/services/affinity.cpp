@@ -0,0 +1,94 @@
+#include "../../include/services/affinity.hpp"
+#include "../../third_party/json.hpp"
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+std::vector<DomainRelation>& relationTable() {
+    static std::vector<DomainRelation> relations = [] {
+        std::vector<DomainRelation> defaults;
+        for (const auto& relation : DefaultDomainRelations) {
+            defaults.push_back({std::string(relation.first), std::string(relation.second), relation.bonus});
+        }
+        return defaults;
+    }();
+    return relations;
+}
+
+}
+
+const std::vector<DomainRelation>& DomainRelations::current() {
+    return relationTable();
+}
+
+void DomainRelations::configure(std::vector<DomainRelation> relations) {
+    relationTable() = std::move(relations);
+}
+
+std::vector<DomainRelation> DomainRelations::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open domain relations file: " + path);
+    }
+    nlohmann::json entries = nlohmann::json::parse(file);
+    if (!entries.is_array()) {
+        throw std::runtime_error("Domain relations file must hold an array: " + path);
+    }
+    std::vector<DomainRelation> relations;
+    for (const auto& entry : entries) {
+        const auto& domains = entry.at("domains");
+        if (!domains.is_array() || domains.size() != 2) {
+            throw std::runtime_error("Domain relation needs exactly two domains: " + entry.dump());
+        }
+        relations.push_back({domains[0].get<std::string>(), domains[1].get<std::string>(), entry.value("bonus", 0.15)});
+    }
+    return relations;
+}
+
+double DomainRelations::bonus(std::string_view targetDomain, std::string_view courseDomain) {
+    for (const auto& relation : current()) {
+        if ((relation.first == targetDomain && relation.second == courseDomain) ||
+            (relation.second == targetDomain && relation.first == courseDomain)) {
+            return relation.bonus;
+        }
+    }
+    return 0.0;
+}
+
+CatalogAffinity::CatalogAffinity(const CatalogIndex& catalog)
+    : domainCount(catalog.domainCount()) {
+    levels.reserve(catalog.levelCount());
+    for (std::size_t code = 0; code < catalog.levelCount(); ++code) {
+        levels.push_back(parseLevel(catalog.levelName(static_cast<LevelCode>(code))));
+    }
+
+    domainBonus.assign(domainCount * domainCount, 0.0);
+    for (std::size_t d = 0; d < domainCount; ++d) {
+        domainBonus[d * domainCount + d] = SameDomainBonus;
+    }
+    // Relation names resolved to codes once; pairs naming a domain this catalog lacks are skipped
+    std::vector<std::vector<DomainCode>> related(domainCount);
+    for (const auto& relation : DomainRelations::current()) {
+        auto first = catalog.domainCode(relation.first);
+        auto second = catalog.domainCode(relation.second);
+        if (!first || !second || *first == *second) {
+            continue;
+        }
+        // First matching pair wins, like DomainRelations::bonus
+        if (domainBonus[*first * domainCount + *second] != 0.0) {
+            continue;
+        }
+        domainBonus[*first * domainCount + *second] = relation.bonus;
+        domainBonus[*second * domainCount + *first] = relation.bonus;
+        related[*first].push_back(*second);
+        related[*second].push_back(*first);
+    }
+
+    relatedOffsets.reserve(domainCount + 1);
+    relatedOffsets.push_back(0);
+    for (const auto& codes : related) {
+        relatedCodes.insert(relatedCodes.end(), codes.begin(), codes.end());
+        relatedOffsets.push_back(static_cast<std::uint32_t>(relatedCodes.size()));
+    }
+}
@@ -1,43 +1,21 @@
 #include "../../include/services/scoring.hpp"
+#include "../../include/services/affinity.hpp"
 #include <algorithm>
 #include <cmath>
 
-double ScoringService::matchScore(const Course& course, const UserProfile& profile) {
-    double score = 0.0;
-
-    // 1. Domain match (20% weight - reduced because we filter by domain first)
-    if (course.getDomain() == profile.getTargetDomain()) {
-        score += 0.2;
-    }
-    // Bonus for AI/Data Science cross-compatibility
-    else if ((profile.getTargetDomain() == "AI" && course.getDomain() == "Data Science") ||
-             (profile.getTargetDomain() == "Data Science" && course.getDomain() == "AI")) {
-        score += 0.15;
-    }
-
-    // 2. Level appropriateness (30% weight)
-    double levelScore = 0.0;
-    std::string courseLevel = course.getLevel();
-    std::string userLevel = profile.getCurrentLevel();
+double ScoringService::domainLevelScore(std::string_view courseDomain, std::string_view courseLevel,
+                                        std::string_view targetDomain, std::string_view userLevel) {
+    // Reference (string) form of the tables domainLevelTable reads: 1. domain match or related
+    // domain bonus, 2. level appropriateness (30% weight)
+    double score = courseDomain == targetDomain ? SameDomainBonus : DomainRelations::bonus(targetDomain, courseDomain);
+    double levelScore = courseLevel == userLevel ? 1.0 : fit(parseLevel(userLevel), parseLevel(courseLevel));
+    return score + 0.3 * levelScore;
+}
 
-    if (courseLevel == userLevel) {
-        levelScore = 1.0; // Perfect match
-    } else if (userLevel == "Beginner" && courseLevel == "Intermediate") {
-        levelScore = 0.8; // Good progression
-    } else if (userLevel == "Intermediate" && courseLevel == "Advanced") {
-        levelScore = 0.8; // Good progression
-    } else if (userLevel == "Intermediate" && courseLevel == "Beginner") {
-        levelScore = 0.4; // Too easy but might fill gaps
-    } else if (userLevel == "Advanced" && courseLevel == "Intermediate") {
-        levelScore = 0.5; // Prerequisites/refresher
-    } else if (userLevel == "Advanced" && courseLevel == "Beginner") {
-        levelScore = 0.2; // Rarely needed
-    } else {
-        levelScore = 0.1; // Poor match
-    }
-    score += 0.3 * levelScore;
+double ScoringService::matchScore(const Course& course, const UserProfile& profile) {
+    double score = domainLevelScore(course.getDomain(), course.getLevel(),
+                                    profile.getTargetDomain(), profile.getCurrentLevel());
 
-    // 3. Interest/tags match (50% weight - INCREASED for better relevance)
     int matchingTags = 0;
     auto interests = profile.getInterests();
     auto tags = course.getTags();
@@ -52,15 +30,93 @@ double ScoringService::matchScore(const Course& course, const UserProfile& profi
         }
     }
 
-    if (!interests.empty()) {
-        double tagMatchRatio = static_cast<double>(matchingTags) / interests.size();
-        score += 0.5 * tagMatchRatio;
+    return finishScore(score, matchingTags, interests.size(), course.getScore());
+}
+
+double ScoringService::matchScore(const CatalogIndex& catalog, CatalogIndex::Slot slot,
+                                  const UserProfile& profile, const InterestMask& interests) {
+    CourseView course = catalog.view(slot);
+    double score = domainLevelScore(course.getDomain(), course.getLevel(),
+                                    profile.getTargetDomain(), profile.getCurrentLevel());
+    int matchingTags = interests.countMatches(course.getTagIds());
+    return finishScore(score, matchingTags, interests.interestCount(), course.getScore());
+}
+
+void ScoringService::scorePartition(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                                    const UserProfile& profile, const InterestMask& interests,
+                                    std::vector<double>& scores) {
+    // Domain and level only take a handful of values, so their contribution is
+    // tabulated once per call and looked up by (domain code, level code)
+    thread_local std::vector<double> domainLevelTable;
+    const std::size_t levels = catalog.levelCount();
+    ScoringService::domainLevelTable(catalog, profile.getTargetDomain(), profile.getCurrentLevel(), domainLevelTable);
+
+    auto domainCodes = catalog.domainCodes();
+    auto levelCodes = catalog.levelCodes();
+    auto courseScores = catalog.scores();
+
+    scores.resize(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        CatalogIndex::Slot slot = slots[i];
+        double score = domainLevelTable[domainCodes[slot] * levels + levelCodes[slot]];
+        int matchingTags = interests.countMatches(catalog.view(slot).getTagIds());
+        scores[i] = finishScore(score, matchingTags, interests.interestCount(), courseScores[slot]);
+    }
+}
+
+void ScoringService::baseScores(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots,
+                                const std::string& targetDomain, const std::string& level,
+                                std::vector<double>& base) {
+    std::vector<double> domainLevelTable;
+    const std::size_t levels = catalog.levelCount();
+    ScoringService::domainLevelTable(catalog, targetDomain, level, domainLevelTable);
+
+    auto domainCodes = catalog.domainCodes();
+    auto levelCodes = catalog.levelCodes();
+    base.resize(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        base[i] = domainLevelTable[domainCodes[slots[i]] * levels + levelCodes[slots[i]]];
+    }
+}
+
+void ScoringService::domainLevelTable(const CatalogIndex& catalog, const std::string& targetDomain,
+                                      const std::string& level, std::vector<double>& table) {
+    const CatalogAffinity& affinity = catalog.affinity();
+    const std::size_t domains = catalog.domainCount();
+    const std::size_t levels = catalog.levelCount();
+
+    // The target's row of the compiled domain matrix. A target the catalog has no course for
+    // can still be related to its domains; that row is resolved by name.
+    thread_local std::vector<double> unknownTargetRow;
+    std::span<const double> domainRow;
+    if (auto target = catalog.domainCode(targetDomain)) {
+        domainRow = affinity.domainRow(*target);
+    } else {
+        unknownTargetRow.resize(domains);
+        for (std::size_t d = 0; d < domains; ++d) {
+            unknownTargetRow[d] = DomainRelations::bonus(targetDomain, catalog.domainName(static_cast<CatalogIndex::DomainCode>(d)));
+        }
+        domainRow = unknownTargetRow;
     }
 
-    // Bonus: Use course's inherent score if available
-    if (course.getScore() > 0) {
-        score *= course.getScore();
+    const Level userLevel = parseLevel(level);
+    const auto userLevelCode = catalog.levelCode(level);
+    table.resize(domains * levels);
+    for (std::size_t d = 0; d < domains; ++d) {
+        for (std::size_t l = 0; l < levels; ++l) {
+            double levelScore = userLevelCode == l ? 1.0 : fit(userLevel, affinity.level(static_cast<CatalogIndex::LevelCode>(l)));
+            table[d * levels + l] = domainRow[d] + 0.3 * levelScore;
+        }
     }
+}
 
-    return score;
+void ScoringService::scoreFromBase(const CatalogIndex& catalog, CatalogIndex::SlotSpan slots, std::span<const double> base,
+                                   const InterestMask& interests, std::vector<double>& scores) {
+    auto courseScores = catalog.scores();
+    scores.resize(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        CatalogIndex::Slot slot = slots[i];
+        int matchingTags = interests.countMatches(catalog.view(slot).getTagIds());
+        scores[i] = finishScore(base[i], matchingTags, interests.interestCount(), courseScores[slot]);
+    }
 }
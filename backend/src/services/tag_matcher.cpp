@@ -0,0 +1,38 @@
+#include "../../include/services/tag_matcher.hpp"
+#include <algorithm>
+#include <bit>
+
+InterestMask::InterestMask(const CatalogIndex& catalog, const std::vector<std::string>& interestList) {
+    assign(catalog, interestList);
+}
+
+void InterestMask::assign(const CatalogIndex& catalog, const std::vector<std::string>& interestList) {
+    interests = interestList.size();
+    words = (interests + 63) / 64;
+    const std::size_t tagCount = catalog.tags().size();
+    bits.assign(tagCount * words, 0);
+
+    for (std::size_t i = 0; i < interests; ++i) {
+        std::string_view interest = interestList[i];
+        for (std::uint32_t t = 0; t < tagCount; ++t) {
+            std::string_view tag = catalog.tagName(t);
+            if (tag.find(interest) != std::string_view::npos ||
+                interest.find(tag) != std::string_view::npos) {
+                bits[t * words + i / 64] |= std::uint64_t{1} << (i % 64);
+            }
+        }
+    }
+}
+
+int InterestMask::countMatches(std::span<const std::uint32_t> courseTags) const {
+    // OR the interest masks of the course's tags, one 64-interest block at a time
+    int matches = 0;
+    for (std::size_t w = 0; w < words; ++w) {
+        std::uint64_t hits = 0;
+        for (std::uint32_t tag : courseTags) {
+            hits |= bits[tag * words + w];
+        }
+        matches += std::popcount(hits);
+    }
+    return matches;
+}
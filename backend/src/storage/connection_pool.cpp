@@ -0,0 +1,220 @@
+#include "../../include/storage/connection_pool.hpp"
+#include "../../include/utils/logger.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+	if (this != &other) {
+		if (pool && entry) {
+			pool->release(std::move(entry));
+		}
+		pool = other.pool;
+		entry = std::move(other.entry);
+	}
+	return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+	if (pool && entry) {
+		pool->release(std::move(entry));
+	}
+}
+
+ConnectionPool::ConnectionPool(std::string connectionString, std::size_t poolCapacity,
+                               std::chrono::milliseconds timeout, std::chrono::milliseconds checkInterval)
+	: connStr(std::move(connectionString)),
+	  capacity(std::max<std::size_t>(1, poolCapacity)),
+	  acquireTimeout(timeout),
+	  healthCheckInterval(checkInterval) {
+	counters.capacity = capacity;
+
+	// Open the first connection eagerly so a bad connection string fails at startup
+	try {
+		idle.push_back(connect());
+		counters.open = 1;
+	} catch (const std::exception& e) {
+		throw std::runtime_error("PostgreSQL connection error: " + std::string(e.what()));
+	}
+
+	if (healthCheckInterval.count() > 0) {
+		healthThread = std::thread(&ConnectionPool::healthLoop, this);
+	}
+}
+
+ConnectionPool::~ConnectionPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	stopSignal.notify_all();
+	if (healthThread.joinable()) {
+		healthThread.join();
+	}
+	for (auto& entry : idle) {
+		if (entry->conn && entry->conn->is_open()) {
+			entry->conn->close();
+		}
+	}
+}
+
+std::unique_ptr<ConnectionPool::Entry> ConnectionPool::connect() {
+	auto entry = std::make_unique<Entry>();
+	entry->conn = std::make_unique<pqxx::connection>(connStr);
+	if (!entry->conn->is_open()) {
+		throw std::runtime_error("Failed to connect to PostgreSQL");
+	}
+	return entry;
+}
+
+void ConnectionPool::prepare(Entry& entry) {
+	std::vector<Preparer> pending;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.assign(preparers.begin() + entry.preparedCount, preparers.end());
+	}
+	for (const auto& preparer : pending) {
+		preparer(*entry.conn);
+		++entry.preparedCount;
+	}
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+	auto start = Clock::now();
+	std::unique_ptr<Entry> entry;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		++counters.waiting;
+		bool ready = available.wait_until(lock, start + acquireTimeout, [this] {
+			return !idle.empty() || counters.open < capacity;
+		});
+		--counters.waiting;
+		if (!ready) {
+			++counters.timeouts;
+			throw std::runtime_error("Timed out waiting for a database connection");
+		}
+
+		if (!idle.empty()) {
+			entry = std::move(idle.back());
+			idle.pop_back();
+		} else {
+			++counters.open; // reserve the slot; the connection is opened outside the lock
+		}
+		++counters.inUse;
+		++counters.acquisitions;
+		double waitMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		counters.totalWaitMs += waitMs;
+		counters.maxWaitMs = std::max(counters.maxWaitMs, waitMs);
+	}
+
+	try {
+		if (!entry || !entry->conn->is_open()) {
+			if (entry) {
+				std::lock_guard<std::mutex> lock(mutex);
+				++counters.reconnects;
+			}
+			entry = connect();
+		}
+		prepare(*entry);
+	} catch (...) {
+		discard();
+		throw;
+	}
+
+	return Lease(this, std::move(entry));
+}
+
+void ConnectionPool::release(std::unique_ptr<Entry> entry) {
+	bool healthy = entry->conn && entry->conn->is_open();
+	if (!healthy) {
+		// Broken mid-request; give the slot back so the next acquire opens a fresh one
+		entry.reset();
+		std::lock_guard<std::mutex> lock(mutex);
+		++counters.reconnects;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		--counters.inUse;
+		if (healthy) {
+			idle.push_back(std::move(entry));
+		} else {
+			--counters.open;
+		}
+	}
+	available.notify_one();
+}
+
+void ConnectionPool::discard() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		--counters.inUse;
+		--counters.open;
+	}
+	available.notify_one();
+}
+
+void ConnectionPool::addPreparer(Preparer preparer) {
+	std::lock_guard<std::mutex> lock(mutex);
+	preparers.push_back(std::move(preparer));
+	// Idle connections pick the new statements up on their next acquire()
+}
+
+void ConnectionPool::healthCheck() {
+	// One connection at a time, returned before the next is taken, so a ping that hangs on an
+	// unreachable server holds at most one connection. The least recently used one goes first and
+	// comes back at the end, so each connection idle at the start is pinged once. The pass stops
+	// as soon as a request is waiting for a connection.
+	std::size_t count = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		count = idle.size();
+	}
+
+	for (std::size_t i = 0; i < count; ++i) {
+		std::unique_ptr<Entry> entry;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (idle.empty() || counters.waiting > 0 || stopping) {
+				break;
+			}
+			entry = std::move(idle.front());
+			idle.erase(idle.begin());
+		}
+
+		bool healthy = true;
+		try {
+			pqxx::nontransaction txn(*entry->conn);
+			txn.exec("SELECT 1");
+		} catch (const std::exception& e) {
+			logging::warn("db.health_check_failed").kv("error", e.what());
+			healthy = false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (healthy) {
+				idle.push_back(std::move(entry));
+			} else {
+				--counters.open;
+				++counters.failedHealthChecks;
+			}
+		}
+		available.notify_one();
+	}
+}
+
+void ConnectionPool::healthLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopSignal.wait_for(lock, healthCheckInterval, [this] { return stopping; })) {
+		lock.unlock();
+		healthCheck();
+		lock.lock();
+	}
+}
+
+PoolStats ConnectionPool::stats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return counters;
+}
@@ -0,0 +1,278 @@
+#include "../../include/storage/mapped_log.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t HeaderBytes = 9;   // length, crc, type
+
+std::size_t padded(std::size_t bytes) {
+	return (bytes + 7) & ~static_cast<std::size_t>(7);
+}
+
+const std::array<std::uint32_t, 256>& crcTable() {
+	static const std::array<std::uint32_t, 256> table = [] {
+		std::array<std::uint32_t, 256> t{};
+		for (std::uint32_t i = 0; i < 256; ++i) {
+			std::uint32_t c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+	return table;
+}
+
+bool parseSegmentName(const std::string& name, std::uint64_t& segment) {
+	if (name.size() != 24 || name.compare(0, 4, "wal-") != 0 || name.compare(20, 4, ".log") != 0) {
+		return false;
+	}
+	segment = std::stoull(name.substr(4, 16));
+	return true;
+}
+
+}
+
+// One mapped segment file
+struct MappedLog::Mapping {
+	char* data = nullptr;
+	std::size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE view = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	Mapping(const std::string& path, std::size_t bytes) : size(bytes) {
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+		                   FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Cannot open log segment " + path);
+		}
+		LARGE_INTEGER length;
+		length.QuadPart = static_cast<LONGLONG>(bytes);
+		view = CreateFileMappingA(file, nullptr, PAGE_READWRITE, length.HighPart, length.LowPart, nullptr);
+		data = view ? static_cast<char*>(MapViewOfFile(view, FILE_MAP_ALL_ACCESS, 0, 0, bytes)) : nullptr;
+		if (!data) {
+			release();
+			throw std::runtime_error("Cannot map log segment " + path);
+		}
+#else
+		fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+			release();
+			throw std::runtime_error("Cannot open log segment " + path);
+		}
+		void* mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapped == MAP_FAILED) {
+			release();
+			throw std::runtime_error("Cannot map log segment " + path);
+		}
+		data = static_cast<char*>(mapped);
+#endif
+	}
+
+	~Mapping() { release(); }
+
+	void sync() {
+#ifdef _WIN32
+		FlushViewOfFile(data, 0);
+		FlushFileBuffers(file);
+#else
+		::msync(data, size, MS_SYNC);
+#endif
+	}
+
+	void release() {
+#ifdef _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (view) CloseHandle(view);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		view = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data) ::munmap(data, size);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		data = nullptr;
+	}
+};
+
+MappedLog::MappedLog(std::string dir, std::size_t bytes)
+	: directory(std::move(dir)), segmentBytes(std::max<std::size_t>(bytes, 4096)) {
+	fs::create_directories(directory);
+}
+
+MappedLog::~MappedLog() {
+	std::lock_guard<std::mutex> lock(mutex);
+	closeSegment();
+}
+
+std::string MappedLog::segmentPath(std::uint64_t number) const {
+	char name[32];
+	std::snprintf(name, sizeof(name), "wal-%016llu.log", static_cast<unsigned long long>(number));
+	return (fs::path(directory) / name).string();
+}
+
+void MappedLog::openSegment(std::uint64_t number) {
+	mapping = new Mapping(segmentPath(number), segmentBytes);
+	segment = number;
+	tail = 0;
+}
+
+void MappedLog::closeSegment() {
+	if (mapping) {
+		mapping->sync();
+		delete mapping;
+		mapping = nullptr;
+	}
+}
+
+void MappedLog::recover(std::uint64_t firstSegment, const Visitor& visit) {
+	std::vector<std::uint64_t> segments;
+	for (const auto& entry : fs::directory_iterator(directory)) {
+		std::uint64_t number;
+		if (entry.is_regular_file() && parseSegmentName(entry.path().filename().string(), number) && number >= firstSegment) {
+			segments.push_back(number);
+		}
+	}
+	std::sort(segments.begin(), segments.end());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	closeSegment();
+	if (segments.empty()) {
+		openSegment(firstSegment);
+		return;
+	}
+	for (std::uint64_t number : segments) {
+		closeSegment();
+		openSegment(number);
+		tail = decode(mapping->data, mapping->size, visit);
+	}
+	// Appends continue in the last segment; clear whatever torn record ended it
+	std::memset(mapping->data + tail, 0, mapping->size - tail);
+}
+
+void MappedLog::append(std::uint8_t type, std::string_view payload) {
+	std::size_t recordBytes = padded(HeaderBytes + payload.size());
+	if (recordBytes > segmentBytes) {
+		throw std::runtime_error("Log record of " + std::to_string(payload.size()) + " bytes exceeds the segment size");
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!mapping) {
+		throw std::runtime_error("Log is not open");
+	}
+	if (tail + recordBytes > segmentBytes) {
+		closeSegment();
+		openSegment(segment + 1);
+	}
+
+	char* record = mapping->data + tail;
+	std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+	std::uint32_t crc = crc32(reinterpret_cast<const char*>(&type), 1);
+	crc = crc32(payload.data(), payload.size(), crc);
+	std::memcpy(record + 4, &crc, 4);
+	record[8] = static_cast<char>(type);
+	std::memcpy(record + HeaderBytes, payload.data(), payload.size());
+	// Length last: a record is only visible to recovery once it is complete
+	std::memcpy(record, &length, 4);
+	tail += recordBytes;
+}
+
+std::uint64_t MappedLog::rotate() {
+	std::lock_guard<std::mutex> lock(mutex);
+	closeSegment();
+	openSegment(segment + 1);
+	return segment;
+}
+
+void MappedLog::sync() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (mapping) {
+		mapping->sync();
+	}
+}
+
+void MappedLog::removeSegmentsBefore(std::uint64_t first) {
+	for (const auto& entry : fs::directory_iterator(directory)) {
+		std::uint64_t number;
+		if (entry.is_regular_file() && parseSegmentName(entry.path().filename().string(), number) && number < first) {
+			std::error_code ignored;
+			fs::remove(entry.path(), ignored);
+		}
+	}
+}
+
+std::uint64_t MappedLog::currentSegment() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return segment;
+}
+
+std::size_t MappedLog::bytesInSegment() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return tail;
+}
+
+void MappedLog::encode(std::string& out, std::uint8_t type, std::string_view payload) {
+	std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+	std::uint32_t crc = crc32(reinterpret_cast<const char*>(&type), 1);
+	crc = crc32(payload.data(), payload.size(), crc);
+	out.append(reinterpret_cast<const char*>(&length), 4);
+	out.append(reinterpret_cast<const char*>(&crc), 4);
+	out.push_back(static_cast<char>(type));
+	out.append(payload);
+	out.append(padded(HeaderBytes + payload.size()) - HeaderBytes - payload.size(), '\0');
+}
+
+std::size_t MappedLog::decode(const char* data, std::size_t size, const Visitor& visit) {
+	std::size_t offset = 0;
+	while (offset + HeaderBytes <= size) {
+		std::uint32_t length;
+		std::uint32_t crc;
+		std::memcpy(&length, data + offset, 4);
+		std::memcpy(&crc, data + offset + 4, 4);
+		if (length == 0 && crc == 0) {
+			break;
+		}
+		if (offset + HeaderBytes + length > size) {
+			break;
+		}
+		const char* type = data + offset + 8;
+		if (crc32(data + offset + HeaderBytes, length, crc32(type, 1)) != crc) {
+			break;
+		}
+		visit(static_cast<std::uint8_t>(*type), std::string_view(data + offset + HeaderBytes, length));
+		offset += padded(HeaderBytes + length);
+	}
+	return offset;
+}
+
+std::uint32_t MappedLog::crc32(const char* data, std::size_t size, std::uint32_t crc) {
+	const auto& table = crcTable();
+	crc = ~crc;
+	for (std::size_t i = 0; i < size; ++i) {
+		crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
@@ -0,0 +1,148 @@
+#include "../../include/storage/memory_storage.hpp"
+#include <mutex>
+#include <stdexcept>
+
+std::string MemoryStorage::hashPassword(const std::string& password) {
+	// Same scheme as PostgresStorage, so users can be moved between backends
+	std::hash<std::string> hasher;
+	return std::to_string(hasher(password));
+}
+
+MemoryStorage::UserShard& MemoryStorage::userShard(const std::string& username) {
+	return userShards[std::hash<std::string>{}(username) % Shards];
+}
+
+MemoryStorage::EmailShard& MemoryStorage::emailShard(const std::string& email) {
+	return emailShards[std::hash<std::string>{}(email) % Shards];
+}
+
+void MemoryStorage::savePlan(int userId, const Plan& plan) {
+	savePlan(userId, plan, {});
+}
+
+void MemoryStorage::savePlan(int userId, const Plan& plan, const std::function<void()>& write) {
+	PlanShard& shard = planShard(userId);
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+	if (write) {
+		write();
+	}
+	shard.plans[userId] = plan;
+}
+
+void MemoryStorage::savePlans(const std::vector<PlanWrite>& batch) {
+	for (const auto& write : batch) {
+		savePlan(write.userId, write.plan);
+	}
+}
+
+std::optional<Plan> MemoryStorage::loadPlan(int userId) {
+	PlanShard& shard = planShard(userId);
+	std::shared_lock<std::shared_mutex> lock(shard.mutex);
+	auto it = shard.plans.find(userId);
+	if (it == shard.plans.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+void MemoryStorage::saveUser(const std::string& username, const std::string& email, const std::string& password) {
+	saveUser(username, email, password, {});
+}
+
+void MemoryStorage::saveUser(const std::string& username, const std::string& email, const std::string& password,
+                             const std::function<void(const User&)>& write) {
+	std::string hash = hashPassword(password);
+	// Always users before emails, so two registrations cannot deadlock
+	UserShard& users = userShard(username);
+	EmailShard& emails = emailShard(email);
+	std::unique_lock<std::shared_mutex> userLock(users.mutex);
+	std::unique_lock<std::shared_mutex> emailLock(emails.mutex);
+	if (users.users.count(username) || emails.emails.count(email)) {
+		throw std::runtime_error("Username or email already exists");
+	}
+
+	User user{nextUserId.fetch_add(1), username, email, std::move(hash)};
+	if (write) {
+		write(user);
+	}
+	emails.emails.emplace(email, user.id);
+	users.users.emplace(username, std::move(user));
+}
+
+bool MemoryStorage::validateUser(const std::string& username, const std::string& password) {
+	std::string hash = hashPassword(password);
+	UserShard& shard = userShard(username);
+	std::shared_lock<std::shared_mutex> lock(shard.mutex);
+	auto it = shard.users.find(username);
+	return it != shard.users.end() && it->second.passwordHash == hash;
+}
+
+std::optional<json> MemoryStorage::getUser(const std::string& username) {
+	UserShard& shard = userShard(username);
+	std::shared_lock<std::shared_mutex> lock(shard.mutex);
+	auto it = shard.users.find(username);
+	if (it == shard.users.end()) {
+		return std::nullopt;
+	}
+	return json{
+		{"id", it->second.id},
+		{"username", username},
+		{"email", it->second.email}
+	};
+}
+
+void MemoryStorage::restorePlan(int userId, Plan plan) {
+	PlanShard& shard = planShard(userId);
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+	shard.plans[userId] = std::move(plan);
+}
+
+void MemoryStorage::restoreUser(User user) {
+	int next = nextUserId.load();
+	while (next <= user.id && !nextUserId.compare_exchange_weak(next, user.id + 1)) {
+	}
+	{
+		EmailShard& shard = emailShard(user.email);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		shard.emails[user.email] = user.id;
+	}
+	UserShard& shard = userShard(user.username);
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+	shard.users[user.username] = std::move(user);
+}
+
+void MemoryStorage::forEachPlan(const std::function<void(int, const Plan&)>& visit) const {
+	for (const auto& shard : planShards) {
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		for (const auto& [userId, plan] : shard.plans) {
+			visit(userId, plan);
+		}
+	}
+}
+
+void MemoryStorage::forEachUser(const std::function<void(const User&)>& visit) const {
+	for (const auto& shard : userShards) {
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		for (const auto& [username, user] : shard.users) {
+			visit(user);
+		}
+	}
+}
+
+std::size_t MemoryStorage::planCount() const {
+	std::size_t count = 0;
+	for (const auto& shard : planShards) {
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		count += shard.plans.size();
+	}
+	return count;
+}
+
+std::size_t MemoryStorage::userCount() const {
+	std::size_t count = 0;
+	for (const auto& shard : userShards) {
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		count += shard.users.size();
+	}
+	return count;
+}
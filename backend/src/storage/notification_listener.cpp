@@ -0,0 +1,59 @@
+#include "../../include/storage/notification_listener.hpp"
+#include "../../include/utils/logger.hpp"
+#include <chrono>
+
+namespace {
+
+class Receiver : public pqxx::notification_receiver {
+	const NotificationListener::Callback& callback;
+
+public:
+	Receiver(pqxx::connection& conn, const std::string& channel, const NotificationListener::Callback& onNotify)
+		: pqxx::notification_receiver(conn, channel), callback(onNotify) {}
+
+	void operator()(const std::string& payload, int) override {
+		try {
+			callback(payload);
+		} catch (const std::exception& e) {
+			logging::warn("notify.ignored").kv("channel", channel()).kv("payload", payload).kv("error", e.what());
+		}
+	}
+};
+
+}
+
+NotificationListener::NotificationListener(std::string connectionString, std::string channel, Callback onNotify,
+	ConnectCallback onConnect)
+	: connStr(std::move(connectionString)), channelName(std::move(channel)), callback(std::move(onNotify)),
+	  connectCallback(std::move(onConnect)) {
+	worker = std::thread(&NotificationListener::run, this);
+}
+
+NotificationListener::~NotificationListener() {
+	stopping = true;
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+void NotificationListener::run() {
+	while (!stopping) {
+		try {
+			pqxx::connection conn(connStr);
+			Receiver receiver(conn, channelName, callback);
+			// Listening from here on; catch up on anything sent while disconnected
+			if (connectCallback) {
+				connectCallback();
+			}
+			while (!stopping) {
+				// Wake up at least once a second to notice shutdown
+				conn.await_notification(1, 0);
+			}
+		} catch (const std::exception& e) {
+			logging::warn("notify.listener_error").kv("channel", channelName).kv("error", e.what()).kv("action", "retry");
+			for (int i = 0; i < 50 && !stopping; ++i) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+		}
+	}
+}
@@ -1,39 +1,91 @@
 #include "../../include/storage/postgres_storage.hpp"
+#include "../../include/utils/pg_array.hpp"
+#include "../../include/utils/logger.hpp"
+#include "../../include/metrics/metrics.hpp"
 #include "../../third_party/json.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <functional>
-#include <iostream>
+#include <thread>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
+namespace {
+
+// roadmap_storage_duration_seconds{op="..."}; callers keep the reference in a function-local static
+metrics::Histogram& storageLatency(const char* op) {
+	return metrics::registry().histogram("roadmap_storage_duration_seconds", "PostgresStorage call latency",
+	                                     std::string("op=\"") + op + "\"");
+}
+
+}
+
 PostgresStorage::PostgresStorage(const std::string& connectionString)
-	: connStr(connectionString) {
+	: PostgresStorage(std::make_shared<ConnectionPool>(connectionString, std::max(4u, std::thread::hardware_concurrency()))) {
+}
+
+PostgresStorage::PostgresStorage(std::shared_ptr<ConnectionPool> connectionPool)
+	: pool(std::move(connectionPool)) {
 	try {
-		conn = std::make_unique<pqxx::connection>(connStr);
-		if (!conn->is_open()) {
-			throw std::runtime_error("Failed to connect to PostgreSQL");
+		{
+			auto conn = pool->acquire();
+			logging::info("db.connected").kv("dbname", conn->dbname());
 		}
-		std::cout << "Connected to PostgreSQL: " << conn->dbname() << std::endl;
 		createTables();
+		pool->addPreparer(&PostgresStorage::prepareStatements);
 	} catch (const std::exception& e) {
 		throw std::runtime_error("PostgreSQL connection error: " + std::string(e.what()));
 	}
 }
 
-PostgresStorage::~PostgresStorage() {
-	if (conn && conn->is_open()) {
-		conn->close();
-	}
-}
-
-void PostgresStorage::reconnect() {
-	if (!conn || !conn->is_open()) {
-		conn = std::make_unique<pqxx::connection>(connStr);
-	}
+PostgresStorage::~PostgresStorage() = default;
+
+void PostgresStorage::prepareStatements(pqxx::connection& conn) {
+	// A plan is saved in one transaction of two statements. The upsert locks the plans row, so
+	// concurrent saves of the same user (other threads or backend instances) queue behind it; the
+	// step replacement runs afterwards with a fresh snapshot (READ COMMITTED), so its DELETE also
+	// removes steps committed by the save it waited for. Both in one statement would share the
+	// snapshot taken before the wait, and both step sets would survive.
+	conn.prepare("plan_upsert", R"(
+		INSERT INTO plans (user_id, total_hours) VALUES ($1, $2)
+		ON CONFLICT (user_id) DO UPDATE
+			SET total_hours = EXCLUDED.total_hours, created_at = CURRENT_TIMESTAMP
+	)");
+	conn.prepare("plan_replace_steps", R"(
+		WITH cleared AS (
+			DELETE FROM plan_steps WHERE user_id = $1
+		)
+		INSERT INTO plan_steps (user_id, step, course_id, hours, note)
+		SELECT $1, s.step, s.course_id, s.hours, s.note
+		FROM unnest($2::integer[], $3::integer[], $4::integer[], $5::text[]) AS s(step, course_id, hours, note)
+	)");
+	// Same for many users: plan columns in $1/$2; the replacement takes the users in $1 and the step
+	// columns (with owning user) in $2..$6.
+	// Callers pass users in ascending order so concurrent batches lock plans rows in the same order.
+	conn.prepare("plan_upsert_batch", R"(
+		INSERT INTO plans (user_id, total_hours)
+		SELECT * FROM unnest($1::integer[], $2::integer[])
+		ON CONFLICT (user_id) DO UPDATE
+			SET total_hours = EXCLUDED.total_hours, created_at = CURRENT_TIMESTAMP
+	)");
+	conn.prepare("plan_replace_steps_batch", R"(
+		WITH cleared AS (
+			DELETE FROM plan_steps WHERE user_id = ANY($1::integer[])
+		)
+		INSERT INTO plan_steps (user_id, step, course_id, hours, note)
+		SELECT * FROM unnest($2::integer[], $3::integer[], $4::integer[], $5::integer[], $6::text[])
+	)");
+	conn.prepare("plan_select", "SELECT total_hours FROM plans WHERE user_id = $1");
+	conn.prepare("plan_select_steps",
+		"SELECT step, course_id, hours, note FROM plan_steps WHERE user_id = $1 ORDER BY step");
+	conn.prepare("user_password_hash", "SELECT password_hash FROM users WHERE username = $1");
+	conn.prepare("user_select", "SELECT id, username, email FROM users WHERE username = $1");
 }
 
 void PostgresStorage::createTables() {
 	try {
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
 		// Users table
@@ -74,8 +126,28 @@ void PostgresStorage::createTables() {
 		txn.exec("CREATE INDEX IF NOT EXISTS idx_plan_steps_user_id ON plan_steps(user_id)");
 		txn.exec("CREATE INDEX IF NOT EXISTS idx_plans_user_id ON plans(user_id)");
 
+		// Announce plan changes so other backend instances can drop cached plans
+		txn.exec(R"(
+			CREATE OR REPLACE FUNCTION notify_plan_changed() RETURNS trigger AS $$
+			BEGIN
+				IF TG_OP = 'DELETE' THEN
+					PERFORM pg_notify('plan_changed', OLD.user_id::text);
+				ELSE
+					PERFORM pg_notify('plan_changed', NEW.user_id::text);
+				END IF;
+				RETURN NULL;
+			END;
+			$$ LANGUAGE plpgsql
+		)");
+		txn.exec("DROP TRIGGER IF EXISTS plans_notify_changed ON plans");
+		txn.exec(R"(
+			CREATE TRIGGER plans_notify_changed
+			AFTER INSERT OR UPDATE OR DELETE ON plans
+			FOR EACH ROW EXECUTE FUNCTION notify_plan_changed()
+		)");
+
 		txn.commit();
-		std::cout << "Database tables created/verified" << std::endl;
+		logging::info("db.schema").kv("table", "users,plans,plan_steps");
 	} catch (const std::exception& e) {
 		throw std::runtime_error("Failed to create tables: " + std::string(e.what()));
 	}
@@ -88,8 +160,10 @@ std::string PostgresStorage::hashPassword(const std::string& password) {
 }
 
 void PostgresStorage::saveUser(const std::string& username, const std::string& email, const std::string& password) {
+	static metrics::Histogram& latency = storageLatency("save_user");
+	metrics::ScopedTimer timer(latency);
 	try {
-		reconnect();
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
 		std::string hash = hashPassword(password);
@@ -107,14 +181,13 @@ void PostgresStorage::saveUser(const std::string& username, const std::string& e
 }
 
 bool PostgresStorage::validateUser(const std::string& username, const std::string& password) {
+	static metrics::Histogram& latency = storageLatency("validate_user");
+	metrics::ScopedTimer timer(latency);
 	try {
-		reconnect();
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
-		auto result = txn.exec(
-			"SELECT password_hash FROM users WHERE username = $1",
-			pqxx::params(username)
-		);
+		auto result = txn.exec(pqxx::prepped{"user_password_hash"}, pqxx::params(username));
 
 		if (result.empty()) {
 			return false;
@@ -123,20 +196,19 @@ bool PostgresStorage::validateUser(const std::string& username, const std::strin
 		std::string storedHash = result[0][0].as<std::string>();
 		return storedHash == hashPassword(password);
 	} catch (const std::exception& e) {
-		std::cerr << "Validation error: " << e.what() << std::endl;
+		logging::error("storage.validate_user").kv("error", e.what());
 		return false;
 	}
 }
 
 std::optional<json> PostgresStorage::getUser(const std::string& username) {
+	static metrics::Histogram& latency = storageLatency("get_user");
+	metrics::ScopedTimer timer(latency);
 	try {
-		reconnect();
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
-		auto result = txn.exec(
-			"SELECT id, username, email FROM users WHERE username = $1",
-			pqxx::params(username)
-		);
+		auto result = txn.exec(pqxx::prepped{"user_select"}, pqxx::params(username));
 
 		if (result.empty()) {
 			return std::nullopt;
@@ -150,50 +222,95 @@ std::optional<json> PostgresStorage::getUser(const std::string& username) {
 
 		return user;
 	} catch (const std::exception& e) {
-		std::cerr << "Get user error: " << e.what() << std::endl;
+		logging::error("storage.get_user").kv("error", e.what());
 		return std::nullopt;
 	}
 }
 
 void PostgresStorage::savePlan(int userId, const Plan& plan) {
+	static metrics::Histogram& latency = storageLatency("save_plan");
+	metrics::ScopedTimer timer(latency);
 	try {
-		reconnect();
-		pqxx::work txn(*conn);
+		std::vector<int> steps, courseIds, hours;
+		std::vector<std::string> notes;
+		for (const auto& step : plan.getSteps()) {
+			steps.push_back(step.step);
+			courseIds.push_back(step.courseId);
+			hours.push_back(step.hours);
+			notes.push_back(step.note);
+		}
 
-		// Delete existing plan
-		txn.exec("DELETE FROM plan_steps WHERE user_id = $1", pqxx::params(userId));
-		txn.exec("DELETE FROM plans WHERE user_id = $1", pqxx::params(userId));
+		auto conn = pool->acquire();
+		pqxx::work txn(*conn);
+		txn.exec(pqxx::prepped{"plan_upsert"}, pqxx::params(userId, plan.getTotalHours()));
+		txn.exec(pqxx::prepped{"plan_replace_steps"}, pqxx::params(userId,
+			toPgArray(steps), toPgArray(courseIds), toPgArray(hours), toPgArray(notes)));
+		txn.commit();
+	} catch (const std::exception& e) {
+		throw std::runtime_error("Failed to save plan: " + std::string(e.what()));
+	}
+}
 
-		// Insert new plan
-		txn.exec(
-			"INSERT INTO plans (user_id, total_hours) VALUES ($1, $2)",
-			pqxx::params(userId, plan.getTotalHours())
-		);
+void PostgresStorage::savePlans(const std::vector<PlanWrite>& batch) {
+	if (batch.empty()) {
+		return;
+	}
+	static metrics::Histogram& latency = storageLatency("save_plans");
+	metrics::ScopedTimer timer(latency);
 
-		// Insert steps
-		for (const auto& step : plan.getSteps()) {
-			txn.exec(
-				"INSERT INTO plan_steps (user_id, step, course_id, hours, note) VALUES ($1, $2, $3, $4, $5)",
-				pqxx::params(userId, step.step, step.courseId, step.hours, step.note)
-			);
+	try {
+		// ON CONFLICT cannot touch the same row twice in one statement: keep the last plan per user.
+		// Users go in ascending order, the lock order of plan_upsert_batch.
+		std::unordered_map<int, std::size_t> latest;
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			latest[batch[i].userId] = i;
+		}
+		std::vector<std::size_t> order;
+		order.reserve(latest.size());
+		for (const auto& [userId, i] : latest) {
+			order.push_back(i);
+		}
+		std::sort(order.begin(), order.end(), [&batch](std::size_t a, std::size_t b) {
+			return batch[a].userId < batch[b].userId;
+		});
+
+		std::vector<int> planUsers, planHours;
+		std::vector<int> stepUsers, steps, courseIds, hours;
+		std::vector<std::string> notes;
+		for (std::size_t i : order) {
+			const auto& write = batch[i];
+			planUsers.push_back(write.userId);
+			planHours.push_back(write.plan.getTotalHours());
+			for (const auto& step : write.plan.getSteps()) {
+				stepUsers.push_back(write.userId);
+				steps.push_back(step.step);
+				courseIds.push_back(step.courseId);
+				hours.push_back(step.hours);
+				notes.push_back(step.note);
+			}
 		}
 
+		auto conn = pool->acquire();
+		pqxx::work txn(*conn);
+		std::string users = toPgArray(planUsers);
+		txn.exec(pqxx::prepped{"plan_upsert_batch"}, pqxx::params(users, toPgArray(planHours)));
+		txn.exec(pqxx::prepped{"plan_replace_steps_batch"}, pqxx::params(users,
+			toPgArray(stepUsers), toPgArray(steps), toPgArray(courseIds), toPgArray(hours), toPgArray(notes)));
 		txn.commit();
 	} catch (const std::exception& e) {
-		throw std::runtime_error("Failed to save plan: " + std::string(e.what()));
+		throw std::runtime_error("Failed to save plans: " + std::string(e.what()));
 	}
 }
 
 std::optional<Plan> PostgresStorage::loadPlan(int userId) {
+	static metrics::Histogram& latency = storageLatency("load_plan");
+	metrics::ScopedTimer timer(latency);
 	try {
-		reconnect();
+		auto conn = pool->acquire();
 		pqxx::work txn(*conn);
 
 		// Get plan
-		auto planResult = txn.exec(
-			"SELECT total_hours FROM plans WHERE user_id = $1",
-			pqxx::params(userId)
-		);
+		auto planResult = txn.exec(pqxx::prepped{"plan_select"}, pqxx::params(userId));
 
 		if (planResult.empty()) {
 			return std::nullopt;
@@ -203,10 +320,7 @@ std::optional<Plan> PostgresStorage::loadPlan(int userId) {
 		plan.setTotalHours(planResult[0][0].as<int>());
 
 		// Get steps
-		auto stepsResult = txn.exec(
-			"SELECT step, course_id, hours, note FROM plan_steps WHERE user_id = $1 ORDER BY step",
-			pqxx::params(userId)
-		);
+		auto stepsResult = txn.exec(pqxx::prepped{"plan_select_steps"}, pqxx::params(userId));
 
 		std::vector<PlanStep> steps;
 		for (const auto& row : stepsResult) {
@@ -221,7 +335,7 @@ std::optional<Plan> PostgresStorage::loadPlan(int userId) {
 		plan.setSteps(steps);
 		return plan;
 	} catch (const std::exception& e) {
-		std::cerr << "Load plan error: " << e.what() << std::endl;
+		logging::error("storage.load_plan").kv("user", userId).kv("error", e.what());
 		return std::nullopt;
 	}
 }
@@ -0,0 +1,259 @@
+#include "../../include/storage/write_behind_storage.hpp"
+#include "../../include/utils/logger.hpp"
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+DurabilityMode parseDurabilityMode(const std::string& value) {
+	if (value == "sync") {
+		return DurabilityMode::Sync;
+	}
+	if (value == "async") {
+		return DurabilityMode::Async;
+	}
+	return DurabilityMode::AsyncFlushOnShutdown;
+}
+
+WriteBehindStorage::WriteBehindStorage(IStorage& storage, WriteBehindOptions writeOptions)
+	: backend(storage), options(writeOptions) {
+	options.capacity = std::max<std::size_t>(1, options.capacity);
+	options.maxBatch = std::max<std::size_t>(1, options.maxBatch);
+	if (options.mode != DurabilityMode::Sync) {
+		flusher = std::thread(&WriteBehindStorage::run, this);
+	}
+}
+
+WriteBehindStorage::~WriteBehindStorage() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	if (flusher.joinable()) {
+		flusher.join();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!pending.empty()) {
+		logging::warn("write_behind.dropped").kv("plans", pending.size()).kv("reason", "shutdown");
+	}
+}
+
+void WriteBehindStorage::savePlan(int userId, const Plan& plan) {
+	if (options.mode == DurabilityMode::Sync) {
+		backend.savePlan(userId, plan);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		// An older plan of this user still queued or being flushed must land first: a direct
+		// write could race the flusher's savePlans, so such plans always coalesce into pending
+		auto queued = [&] { return pending.count(userId) > 0 || inFlight.count(userId) > 0; };
+		auto hasRoom = [&] { return stopping || pending.size() < options.capacity || queued(); };
+		bool roomy = spaceAvailable.wait_for(lock, options.enqueueTimeout, hasRoom);
+		if (stopping) {
+			// The flusher may not drain pending any more: wait out this user's flush, drop the
+			// older queued plan and write this one through
+			drained.wait(lock, [&] { return inFlight.count(userId) == 0; });
+			counters.coalesced += pending.erase(userId);
+			++counters.syncFallbacks;
+			lock.unlock();
+			backend.savePlan(userId, plan);
+			return;
+		}
+		if (!roomy) {
+			// Backpressure: the flusher is behind, so this request pays for its own write
+			++counters.syncFallbacks;
+			lock.unlock();
+			backend.savePlan(userId, plan);
+			return;
+		}
+
+		bool wasEmpty = pending.empty();
+		if (wasEmpty) {
+			oldestPending = Clock::now();
+		}
+		bool inserted = pending.insert_or_assign(userId, plan).second;
+		++counters.enqueued;
+		if (!inserted) {
+			++counters.coalesced;
+		}
+		// Wake the flusher to start a time window, or because the batch is full
+		if (!wasEmpty && pending.size() < options.maxBatch) {
+			return;
+		}
+	}
+	workAvailable.notify_one();
+}
+
+void WriteBehindStorage::savePlans(const std::vector<PlanWrite>& batch) {
+	if (options.mode == DurabilityMode::Sync || batch.empty()) {
+		backend.savePlans(batch);
+		return;
+	}
+
+	// Queued plans of the same users are older than the batch, so they are dropped; the flusher
+	// is held off until the batch is written so nothing older can land on top of it
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		drained.wait(lock, [this] { return stopping || (inFlight.empty() && !bulkWriting); });
+		for (const auto& write : batch) {
+			counters.coalesced += pending.erase(write.userId);
+		}
+		bulkWriting = true;
+	}
+	spaceAvailable.notify_all();
+
+	auto finish = [&](bool ok) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bulkWriting = false;
+			if (ok) {
+				++counters.bulkWrites;
+				counters.written += batch.size();
+			}
+		}
+		workAvailable.notify_one();
+		drained.notify_all();
+	};
+	try {
+		backend.savePlans(batch);
+	} catch (...) {
+		finish(false);
+		throw;
+	}
+	finish(true);
+}
+
+std::optional<Plan> WriteBehindStorage::loadPlan(int userId) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (auto it = pending.find(userId); it != pending.end()) {
+			return it->second;
+		}
+		if (auto it = inFlight.find(userId); it != inFlight.end()) {
+			return it->second;
+		}
+	}
+	return backend.loadPlan(userId);
+}
+
+void WriteBehindStorage::saveUser(const std::string& username, const std::string& email, const std::string& password) {
+	backend.saveUser(username, email, password);
+}
+
+bool WriteBehindStorage::validateUser(const std::string& username, const std::string& password) {
+	return backend.validateUser(username, password);
+}
+
+std::optional<json> WriteBehindStorage::getUser(const std::string& username) {
+	return backend.getUser(username);
+}
+
+void WriteBehindStorage::flush() {
+	if (options.mode == DurabilityMode::Sync) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(mutex);
+	flushRequested = true;
+	workAvailable.notify_one();
+	drained.wait(lock, [this] { return pending.empty() && inFlight.empty(); });
+}
+
+WriteBehindStats WriteBehindStorage::stats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	WriteBehindStats snapshot = counters;
+	snapshot.queueDepth = pending.size() + inFlight.size();
+	return snapshot;
+}
+
+void WriteBehindStorage::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		if (pending.empty()) {
+			drained.notify_all();
+			if (stopping) {
+				break;
+			}
+			workAvailable.wait(lock, [this] { return stopping || !pending.empty(); });
+			continue;
+		}
+
+		// Batch by time window and by size
+		if (!stopping) {
+			workAvailable.wait_until(lock, oldestPending + options.flushInterval, [this] {
+				return stopping || flushRequested || pending.size() >= options.maxBatch;
+			});
+		}
+		if (stopping && options.mode == DurabilityMode::Async) {
+			break;
+		}
+		if (bulkWriting) {
+			workAvailable.wait(lock, [this] { return !bulkWriting; });
+			continue;
+		}
+
+		inFlight.swap(pending);
+		flushRequested = false;
+		spaceAvailable.notify_all();
+
+		lock.unlock();
+		write(inFlight);
+		lock.lock();
+
+		inFlight.clear();
+		drained.notify_all();
+	}
+}
+
+void WriteBehindStorage::write(const std::unordered_map<int, Plan>& batch) {
+	// Runs without the lock; only the flusher thread touches inFlight while it is non-empty
+	auto start = Clock::now();
+	std::uint64_t written = 0;
+	std::uint64_t dropped = 0;
+	std::uint64_t failedBatches = 0;
+
+	std::vector<PlanWrite> chunk;
+	chunk.reserve(std::min(batch.size(), options.maxBatch));
+	auto writeChunk = [&] {
+		try {
+			backend.savePlans(chunk);
+			written += chunk.size();
+		} catch (const std::exception& e) {
+			// One bad plan (e.g. unknown user) must not sink the rest: retry one by one
+			logging::warn("write_behind.batch_failed").kv("plans", chunk.size()).kv("error", e.what());
+			++failedBatches;
+			for (const auto& write : chunk) {
+				try {
+					backend.savePlan(write.userId, write.plan);
+					++written;
+				} catch (const std::exception& single) {
+					logging::error("write_behind.dropped").kv("user", write.userId).kv("error", single.what());
+					++dropped;
+				}
+			}
+		}
+		chunk.clear();
+	};
+
+	for (const auto& [userId, plan] : batch) {
+		chunk.push_back({userId, plan});
+		if (chunk.size() == options.maxBatch) {
+			writeChunk();
+		}
+	}
+	if (!chunk.empty()) {
+		writeChunk();
+	}
+
+	double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	std::lock_guard<std::mutex> lock(mutex);
+	++counters.flushes;
+	counters.written += written;
+	counters.dropped += dropped;
+	counters.failedBatches += failedBatches;
+	counters.lastFlushMs = elapsedMs;
+	counters.maxFlushMs = std::max(counters.maxFlushMs, elapsedMs);
+	counters.totalFlushMs += elapsedMs;
+}
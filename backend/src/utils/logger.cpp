@@ -0,0 +1,374 @@
+#include "../../include/utils/logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logging {
+
+namespace {
+
+struct Record {
+    std::int64_t timeNs;
+    std::uint32_t length;
+    Level level;
+    char text[Line::MaxLength];
+};
+
+// Single-producer (owning thread) / single-consumer (drain thread) ring of records
+struct Ring {
+    static constexpr std::uint64_t Capacity = 256;
+
+    std::unique_ptr<Record[]> records{new Record[Capacity]};
+    std::uint32_t threadId = 0;
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<bool> retired{false};
+};
+
+struct Logger {
+    std::atomic<Level> level{Level::Info};
+    std::atomic<std::uint32_t> bodySampleRate{100};
+    std::atomic<bool> running{false};
+    std::FILE* sink = stdout;
+    std::chrono::milliseconds drainInterval{10};
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::uint32_t nextThreadId = 1;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread drainer;
+
+    std::atomic<std::uint64_t> written{0};
+    std::uint64_t droppedReported = 0;
+    std::uint64_t droppedRetired = 0;
+
+    // Drain thread scratch, reused across passes
+    std::vector<std::pair<Ring*, const Record*>> batch;
+    std::string out;
+};
+
+Logger& logger() {
+    static Logger instance;
+    return instance;
+}
+
+// Marks the ring retired when its thread exits; the drain thread frees it once empty
+struct RingHandle {
+    std::shared_ptr<Ring> ring;
+    ~RingHandle() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+Ring& threadRing() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+        auto ring = std::make_shared<Ring>();
+        Logger& log = logger();
+        std::lock_guard<std::mutex> lock(log.registryMutex);
+        ring->threadId = log.nextThreadId++;
+        log.rings.push_back(ring);
+        handle.ring = std::move(ring);
+    }
+    return *handle.ring;
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Debug: return "DEBUG";
+        case Level::Info: return "INFO ";
+        case Level::Warn: return "WARN ";
+        case Level::Error: return "ERROR";
+    }
+    return "INFO ";
+}
+
+void formatRecord(std::string& out, std::int64_t timeNs, std::uint32_t threadId, Level level, std::string_view text) {
+    std::time_t seconds = static_cast<std::time_t>(timeNs / 1000000000);
+    int millis = static_cast<int>((timeNs / 1000000) % 1000);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char prefix[64];
+    int length = std::snprintf(prefix, sizeof(prefix), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ %s t%u ",
+                               utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                               utc.tm_hour, utc.tm_min, utc.tm_sec, millis, levelName(level), threadId);
+    out.append(prefix, static_cast<std::size_t>(std::max(length, 0)));
+    out.append(text);
+    out.push_back('\n');
+}
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Moves everything currently queued to the sink, oldest record first
+void drainOnce(Logger& log) {
+    log.batch.clear();
+    log.out.clear();
+    {
+        std::lock_guard<std::mutex> lock(log.registryMutex);
+        for (const auto& ring : log.rings) {
+            std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (std::uint64_t i = tail; i < head; ++i) {
+                log.batch.emplace_back(ring.get(), &ring->records[i % Ring::Capacity]);
+            }
+        }
+    }
+
+    std::stable_sort(log.batch.begin(), log.batch.end(), [](const auto& a, const auto& b) {
+        return a.second->timeNs < b.second->timeNs;
+    });
+    for (const auto& [ring, record] : log.batch) {
+        formatRecord(log.out, record->timeNs, ring->threadId, record->level,
+                     std::string_view(record->text, record->length));
+    }
+
+    std::lock_guard<std::mutex> lock(log.registryMutex);
+    // Release the consumed slots (rings only grow at the head while we were formatting)
+    for (const auto& [ring, record] : log.batch) {
+        ring->tail.store(ring->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    std::erase_if(log.rings, [&log](const std::shared_ptr<Ring>& ring) {
+        bool finished = ring->retired.load(std::memory_order_acquire) &&
+                        ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+        if (finished) {
+            log.droppedRetired += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return finished;
+    });
+    std::uint64_t dropped = log.droppedRetired;
+    for (const auto& ring : log.rings) {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+
+    if (dropped > log.droppedReported) {
+        char text[64];
+        int length = std::snprintf(text, sizeof(text), "logger.dropped count=%llu",
+                                   static_cast<unsigned long long>(dropped - log.droppedReported));
+        formatRecord(log.out, nowNs(), 0, Level::Warn, std::string_view(text, static_cast<std::size_t>(length)));
+        log.droppedReported = dropped;
+    }
+
+    if (!log.out.empty()) {
+        std::fwrite(log.out.data(), 1, log.out.size(), log.sink);
+        std::fflush(log.sink);
+        log.written.fetch_add(log.batch.size(), std::memory_order_relaxed);
+    }
+}
+
+void drainLoop() {
+    Logger& log = logger();
+    std::unique_lock<std::mutex> lock(log.wakeMutex);
+    while (!log.stopping) {
+        log.wake.wait_for(lock, log.drainInterval);
+        lock.unlock();
+        drainOnce(log);
+        lock.lock();
+    }
+}
+
+bool needsQuotes(std::string_view value) {
+    if (value.empty()) {
+        return true;
+    }
+    for (char c : value) {
+        if (c == ' ' || c == '"' || c == '=' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+Level parseLevel(std::string_view name) {
+    if (name == "debug") return Level::Debug;
+    if (name == "warn") return Level::Warn;
+    if (name == "error") return Level::Error;
+    return Level::Info;
+}
+
+void start(const LoggerOptions& options) {
+    Logger& log = logger();
+    if (log.running.load()) {
+        return;
+    }
+    log.level.store(options.level);
+    log.bodySampleRate.store(options.bodySampleRate);
+    log.sink = options.sink;
+    log.drainInterval = options.drainInterval;
+    log.stopping = false;
+    log.drainer = std::thread(drainLoop);
+    log.running.store(true, std::memory_order_release);
+}
+
+void stop() {
+    Logger& log = logger();
+    if (!log.running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(log.wakeMutex);
+        log.stopping = true;
+    }
+    log.wake.notify_one();
+    log.drainer.join();
+    drainOnce(log);
+}
+
+bool enabled(Level level) {
+    return level >= logger().level.load(std::memory_order_relaxed);
+}
+
+bool sampleBody() {
+    std::uint32_t rate = logger().bodySampleRate.load(std::memory_order_relaxed);
+    if (rate == 0) {
+        return false;
+    }
+    thread_local std::uint32_t counter = 0;
+    return counter++ % rate == 0;
+}
+
+LoggerStats stats() {
+    Logger& log = logger();
+    LoggerStats result;
+    result.written = log.written.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(log.registryMutex);
+    result.dropped = log.droppedRetired;
+    for (const auto& ring : log.rings) {
+        result.dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    result.threads = log.rings.size();
+    return result;
+}
+
+Line::Line(Level level, std::string_view event)
+    : level(level), active(enabled(level)) {
+    if (active) {
+        append(event);
+    }
+}
+
+Line::~Line() {
+    if (!active) {
+        return;
+    }
+    Logger& log = logger();
+    std::int64_t timeNs = nowNs();
+
+    if (!log.running.load(std::memory_order_acquire)) {
+        std::string out;
+        formatRecord(out, timeNs, 0, level, std::string_view(text, length));
+        std::fwrite(out.data(), 1, out.size(), log.sink);
+        std::fflush(log.sink);
+        return;
+    }
+
+    Ring& ring = threadRing();
+    std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= Ring::Capacity) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = ring.records[head % Ring::Capacity];
+    record.timeNs = timeNs;
+    record.level = level;
+    record.length = static_cast<std::uint32_t>(length);
+    std::memcpy(record.text, text, length);
+    ring.head.store(head + 1, std::memory_order_release);
+
+    if (level == Level::Error) {
+        log.wake.notify_one();
+    }
+}
+
+void Line::append(std::string_view value) {
+    std::size_t count = std::min(value.size(), MaxLength - length);
+    std::memcpy(text + length, value.data(), count);
+    length += count;
+}
+
+void Line::appendKey(std::string_view key) {
+    append(" ");
+    append(key);
+    append("=");
+}
+
+Line& Line::kv(std::string_view key, std::string_view value) {
+    if (!active) {
+        return *this;
+    }
+    appendKey(key);
+    if (!needsQuotes(value)) {
+        append(value);
+        return *this;
+    }
+    append("\"");
+    for (char c : value) {
+        switch (c) {
+            case '"': append("\\\""); break;
+            case '\\': append("\\\\"); break;
+            case '\n': append("\\n"); break;
+            case '\r': append("\\r"); break;
+            case '\t': append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    append("?");
+                } else {
+                    append(std::string_view(&c, 1));
+                }
+        }
+    }
+    append("\"");
+    return *this;
+}
+
+Line& Line::kv(std::string_view key, double value) {
+    if (active) {
+        char buffer[32];
+        int count = std::snprintf(buffer, sizeof(buffer), "%g", value);
+        appendKey(key);
+        append(std::string_view(buffer, static_cast<std::size_t>(std::max(count, 0))));
+    }
+    return *this;
+}
+
+Line& Line::kvSigned(std::string_view key, long long value) {
+    if (active) {
+        char buffer[24];
+        int count = std::snprintf(buffer, sizeof(buffer), "%lld", value);
+        appendKey(key);
+        append(std::string_view(buffer, static_cast<std::size_t>(std::max(count, 0))));
+    }
+    return *this;
+}
+
+Line& Line::kvUnsigned(std::string_view key, unsigned long long value) {
+    if (active) {
+        char buffer[24];
+        int count = std::snprintf(buffer, sizeof(buffer), "%llu", value);
+        appendKey(key);
+        append(std::string_view(buffer, static_cast<std::size_t>(std::max(count, 0))));
+    }
+    return *this;
+}
+
+}
@@ -0,0 +1,154 @@
+#include "../../include/utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+struct ThreadPool::Job {
+    // Indices [begin, end) not yet started by anyone; the owner takes from the front,
+    // thieves from the back
+    struct alignas(64) Block {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    Job(const std::function<void(std::size_t)>& jobTask, std::size_t participants, std::size_t count)
+        : task(jobTask), blocks(participants), remaining(count) {
+        for (std::size_t p = 0; p < participants; ++p) {
+            blocks[p].begin = count * p / participants;
+            blocks[p].end = count * (p + 1) / participants;
+        }
+    }
+
+    // Next index for participant `self`: from its own block, else half of the largest other block
+    bool next(std::size_t self, std::size_t& index) {
+        Block& own = blocks[self];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                index = own.begin++;
+                return true;
+            }
+        }
+        while (true) {
+            std::size_t victim = blocks.size();
+            std::size_t largest = 0;
+            for (std::size_t p = 0; p < blocks.size(); ++p) {
+                if (p == self) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(blocks[p].mutex);
+                if (blocks[p].end - blocks[p].begin > largest) {
+                    largest = blocks[p].end - blocks[p].begin;
+                    victim = p;
+                }
+            }
+            if (victim == blocks.size()) {
+                return false;
+            }
+            std::scoped_lock lock(blocks[victim].mutex, own.mutex);
+            Block& from = blocks[victim];
+            std::size_t left = from.end - from.begin;
+            if (left == 0) {
+                continue;   // emptied since the scan
+            }
+            std::size_t take = (left + 1) / 2;
+            own.begin = from.end - take;
+            own.end = from.end;
+            from.end -= take;
+            index = own.begin++;
+            return true;
+        }
+    }
+
+    void work(std::size_t self) {
+        std::size_t index = 0;
+        while (next(self, index)) {
+            try {
+                task(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    const std::function<void(std::size_t)>& task;
+    std::vector<Block> blocks;   // one per worker, the last one for the calling thread
+    std::atomic<std::size_t> remaining;
+    std::mutex doneMutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::forEach(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    auto job = std::make_shared<Job>(task, workers.size() + 1, count);
+    if (!workers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(job);
+        }
+        wake.notify_all();
+    }
+
+    job->work(workers.size());
+    {
+        std::unique_lock<std::mutex> lock(job->doneMutex);
+        job->done.wait(lock, [&] { return job->remaining.load(std::memory_order_acquire) == 0; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(jobs.begin(), jobs.end(), job);
+        if (it != jobs.end()) {
+            jobs.erase(it);
+        }
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void ThreadPool::run(std::size_t worker) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (stopping) {
+            return;
+        }
+        std::shared_ptr<Job> job = jobs.front();
+        lock.unlock();
+        job->work(worker);
+        lock.lock();
+        // Nothing left to start in this job; whoever is still running its tasks finishes them
+        if (!jobs.empty() && jobs.front() == job) {
+            jobs.pop_front();
+        }
+    }
+}
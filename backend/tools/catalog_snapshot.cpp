@@ -0,0 +1,105 @@
+// Builds and inspects binary catalog snapshots (see include/catalog/catalog_snapshot.hpp).
+// The server maps one at startup when ROADMAP_CATALOG_SNAPSHOT points to it.
+//
+// Build (from backend/):
+//   cmake -S . -B build && cmake --build build --target roadmap_catalog_snapshot
+// Run:
+//   ./build/roadmap_catalog_snapshot --from-json data/courses.json --out data/catalog.snapshot
+//   ./build/roadmap_catalog_snapshot --from-postgres "host=... dbname=roadmap ..." --out data/catalog.snapshot
+//   ./build/roadmap_catalog_snapshot --info data/catalog.snapshot
+//
+// --from-postgres is available when the tool is built with libpqxx.
+
+#include "../include/catalog/catalog_index.hpp"
+#include "../include/catalog/memory_catalog.hpp"
+#ifdef ROADMAP_WITH_POSTGRES
+#include "../include/catalog/postgres_catalog.hpp"
+#include "../include/storage/connection_pool.hpp"
+#endif
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s --from-json PATH --out PATH\n"
+                         "       %s --from-postgres CONNINFO --out PATH\n"
+                         "       %s --info PATH\n", program, program, program);
+    return 2;
+}
+
+std::vector<Course> loadCourses(const std::string& json, const std::string& postgres) {
+    if (!json.empty()) {
+        return MemoryCatalog(json).getAll();
+    }
+#ifdef ROADMAP_WITH_POSTGRES
+    return PostgresCatalog(std::make_shared<ConnectionPool>(postgres, 1)).getAll();
+#else
+    (void)postgres;
+    throw std::runtime_error("this build has no PostgreSQL support (libpqxx not found)");
+#endif
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string fromJson;
+    std::string fromPostgres;
+    std::string out;
+    std::string info;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--from-json") == 0 && value) {
+            fromJson = value;
+            ++i;
+        } else if (std::strcmp(arg, "--from-postgres") == 0 && value) {
+            fromPostgres = value;
+            ++i;
+        } else if (std::strcmp(arg, "--out") == 0 && value) {
+            out = value;
+            ++i;
+        } else if (std::strcmp(arg, "--info") == 0 && value) {
+            info = value;
+            ++i;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    try {
+        if (!info.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            CatalogIndex catalog(CatalogSnapshot::map(info));
+            double mapMs = msSince(start);
+            std::printf("%s: version %u, %zu bytes\n", info.c_str(), CatalogSnapshot::Version, catalog.snapshot()->bytes());
+            std::printf("  courses %zu, tags %zu, domains %zu, levels %zu\n",
+                        catalog.size(), catalog.tags().size(), catalog.domainCount(), catalog.levelCount());
+            std::printf("  map + bind %.3f ms\n", mapMs);
+            return 0;
+        }
+        if (out.empty() || fromJson.empty() == fromPostgres.empty()) {
+            return usage(argv[0]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Course> courses = loadCourses(fromJson, fromPostgres);
+        double loadMs = msSince(start);
+        start = std::chrono::steady_clock::now();
+        auto snapshot = CatalogSnapshot::build(courses);
+        snapshot->save(out);
+        std::printf("wrote %zu courses (%zu bytes) to %s: load %.1f ms, build + save %.1f ms\n",
+                    courses.size(), snapshot->bytes(), out.c_str(), loadMs, msSince(start));
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}